@@ -0,0 +1,196 @@
+#include "Checksum.hpp"
+#include "CpuFeatures.hpp"
+#include "TaskflowManager.hpp"
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Reflected Castagnoli polynomial
+constexpr uint32_t kPolynomial = 0x82f63b78;
+// Lengths of the three interleaved streams of the hardware path: long runs for throughput, short
+// ones for the remainder
+constexpr size_t kLongRun = 8192;
+constexpr size_t kShortRun = 256;
+
+// GF(2) 32x32 matrices as 32 columns: mat[n] is the image of bit n
+uint32_t gf2_times(const uint32_t* mat, uint32_t vec) {
+    uint32_t sum = 0;
+    while (vec) {
+        if (vec & 1) sum ^= *mat;
+        vec >>= 1;
+        ++mat;
+    }
+    return sum;
+}
+
+void gf2_square(uint32_t* square, const uint32_t* mat) {
+    for (int n = 0; n < 32; ++n) {
+        square[n] = gf2_times(mat, mat[n]);
+    }
+}
+
+// Operator appending `len` zero bytes to a CRC register
+void zeros_operator(size_t len, uint32_t* result) {
+    uint32_t odd[32];
+    uint32_t even[32];
+    for (int n = 0; n < 32; ++n) result[n] = uint32_t(1) << n;
+    odd[0] = kPolynomial;
+    for (int n = 1; n < 32; ++n) odd[n] = uint32_t(1) << (n - 1);
+    gf2_square(even, odd); // two zero bits
+    gf2_square(odd, even); // four zero bits
+    uint32_t* op = odd;
+    uint32_t* other = even;
+    while (len) {
+        gf2_square(other, op); // one zero byte on the first pass, doubling afterwards
+        std::swap(op, other);
+        if (len & 1) {
+            uint32_t composed[32];
+            for (int n = 0; n < 32; ++n) composed[n] = gf2_times(op, result[n]);
+            std::memcpy(result, composed, sizeof(composed));
+        }
+        len >>= 1;
+    }
+}
+
+struct Crc32cTables {
+    uint32_t bytes[8][256];     // slicing-by-8
+    uint32_t longShift[4][256]; // append kLongRun zero bytes, one table per register byte
+    uint32_t shortShift[4][256];
+
+    Crc32cTables() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? (c >> 1) ^ kPolynomial : c >> 1;
+            bytes[0][i] = c;
+        }
+        for (int k = 1; k < 8; ++k) {
+            for (int i = 0; i < 256; ++i) {
+                bytes[k][i] = (bytes[k - 1][i] >> 8) ^ bytes[0][bytes[k - 1][i] & 0xff];
+            }
+        }
+        fillShift(kLongRun, longShift);
+        fillShift(kShortRun, shortShift);
+    }
+
+    static void fillShift(size_t len, uint32_t table[4][256]) {
+        uint32_t op[32];
+        zeros_operator(len, op);
+        for (int k = 0; k < 4; ++k) {
+            for (uint32_t i = 0; i < 256; ++i) {
+                table[k][i] = gf2_times(op, i << (8 * k));
+            }
+        }
+    }
+};
+
+const Crc32cTables& tables() {
+    static const Crc32cTables instance;
+    return instance;
+}
+
+inline uint32_t shift(const uint32_t table[4][256], uint32_t crc) {
+    return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff] ^ table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+}
+
+uint32_t crc32c_scalar(uint32_t crc, const unsigned char* p, size_t n) {
+    const auto& t = tables().bytes;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        word ^= crc;
+        crc = t[7][word & 0xff] ^ t[6][(word >> 8) & 0xff] ^ t[5][(word >> 16) & 0xff] ^ t[4][(word >> 24) & 0xff]
+            ^ t[3][(word >> 32) & 0xff] ^ t[2][(word >> 40) & 0xff] ^ t[1][(word >> 48) & 0xff] ^ t[0][word >> 56];
+    }
+#endif
+    for (; n > 0; ++p, --n) {
+        crc = t[0][(crc ^ *p) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef MCP_FILEOP_X86_SIMD
+// Three independent crc32 streams hide the instruction's latency; their registers are merged
+// with the zero-append tables
+template<size_t Run>
+__attribute__((target("sse4.2")))
+inline uint64_t crc32c_sse42_runs(uint64_t crc, const unsigned char*& p, size_t& n, const uint32_t table[4][256]) {
+    while (n >= 3 * Run) {
+        uint64_t c0 = crc;
+        uint64_t c1 = 0;
+        uint64_t c2 = 0;
+        for (size_t i = 0; i < Run; i += 8) {
+            uint64_t w0, w1, w2;
+            std::memcpy(&w0, p + i, 8);
+            std::memcpy(&w1, p + Run + i, 8);
+            std::memcpy(&w2, p + 2 * Run + i, 8);
+            c0 = _mm_crc32_u64(c0, w0);
+            c1 = _mm_crc32_u64(c1, w1);
+            c2 = _mm_crc32_u64(c2, w2);
+        }
+        crc = shift(table, shift(table, (uint32_t)c0) ^ (uint32_t)c1) ^ (uint32_t)c2;
+        p += 3 * Run;
+        n -= 3 * Run;
+    }
+    return crc;
+}
+
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(uint32_t crc, const unsigned char* p, size_t n) {
+    uint64_t c = crc;
+    c = crc32c_sse42_runs<kLongRun>(c, p, n, tables().longShift);
+    c = crc32c_sse42_runs<kShortRun>(c, p, n, tables().shortShift);
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        c = _mm_crc32_u64(c, word);
+    }
+    uint32_t c32 = (uint32_t)c;
+    for (; n > 0; ++p, --n) {
+        c32 = _mm_crc32_u8(c32, *p);
+    }
+    return c32;
+}
+#endif
+
+} // namespace
+
+uint32_t crc32c(const char* data, size_t size, uint32_t crc) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+#ifdef MCP_FILEOP_X86_SIMD
+    if (cpu::has_sse42()) {
+        return ~crc32c_sse42(~crc, p, size);
+    }
+#endif
+    return ~crc32c_scalar(~crc, p, size);
+}
+
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, size_t size_b) {
+    uint32_t op[32];
+    zeros_operator(size_b, op);
+    return gf2_times(op, crc_a) ^ crc_b;
+}
+
+uint32_t crc32c_parallel(const char* data, size_t size, TaskflowManager* taskflow) {
+    size_t chunks = 1;
+    if (taskflow && taskflow->numWorkers() > 1 && size >= 2 * kChecksumChunkSize) {
+        chunks = size / kChecksumChunkSize;
+    }
+    if (chunks == 1) {
+        return crc32c(data, size);
+    }
+    std::vector<uint32_t> crcs(chunks);
+    auto chunk_begin = [size, chunks](size_t i) { return size / chunks * i; };
+    taskflow->parallelFor(chunks, [&](size_t i) {
+        size_t begin = chunk_begin(i);
+        size_t end = i + 1 == chunks ? size : chunk_begin(i + 1);
+        crcs[i] = crc32c(data + begin, end - begin);
+    });
+    uint32_t crc = crcs[0];
+    for (size_t i = 1; i < chunks; ++i) {
+        size_t end = i + 1 == chunks ? size : chunk_begin(i + 1);
+        crc = crc32c_combine(crc, crcs[i], end - chunk_begin(i));
+    }
+    return crc;
+}
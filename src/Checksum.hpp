@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+class TaskflowManager;
+
+// CRC32C (Castagnoli, as in iSCSI/ext4/RFC 3720). `crc` is the checksum of preceding data, so a
+// stream can be hashed piecewise: crc32c(b, n2, crc32c(a, n1)) == crc32c(a + b, n1 + n2). Uses the
+// SSE4.2 crc32 instruction when available and slicing-by-8 tables otherwise.
+uint32_t crc32c(const char* data, size_t size, uint32_t crc = 0);
+
+// Checksum of A followed by B, given crc32c(A), crc32c(B) and the length of B
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, size_t size_b);
+
+// Files of at least two chunks are split into chunks hashed in parallel on `taskflow`; the chunk
+// checksums are combined in order, so the result is the same as a serial crc32c
+constexpr size_t kChecksumChunkSize = 8 * 1024 * 1024;
+uint32_t crc32c_parallel(const char* data, size_t size, TaskflowManager* taskflow);
@@ -0,0 +1,123 @@
+#include "Columns.hpp"
+#include "CpuFeatures.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+// Bit i of each mask describes byte i of a block of up to 64 bytes
+struct BlockMasks {
+    uint64_t delimiter = 0;
+    uint64_t quote = 0;
+    uint64_t terminator = 0;
+};
+
+BlockMasks classify_scalar(const char* p, size_t n, char delimiter, int quote) {
+    BlockMasks m;
+    for (size_t i = 0; i < n; ++i) {
+        char c = p[i];
+        uint64_t bit = uint64_t(1) << i;
+        if (c == delimiter) m.delimiter |= bit;
+        if (quote >= 0 && (unsigned char)c == quote) m.quote |= bit;
+        if (c == '\n' || c == '\r') m.terminator |= bit;
+    }
+    return m;
+}
+
+#ifdef MCP_FILEOP_X86_SIMD
+__attribute__((target("avx2")))
+inline uint64_t match_mask(__m256i lo, __m256i hi, __m256i c) {
+    uint32_t a = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, c));
+    uint32_t b = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, c));
+    return (uint64_t)a | (uint64_t)b << 32;
+}
+
+__attribute__((target("avx2")))
+BlockMasks classify_avx2(const char* p, char delimiter, int quote) {
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    BlockMasks m;
+    m.delimiter = match_mask(lo, hi, _mm256_set1_epi8(delimiter));
+    if (quote >= 0) m.quote = match_mask(lo, hi, _mm256_set1_epi8((char)quote));
+    m.terminator = match_mask(lo, hi, _mm256_set1_epi8('\n')) | match_mask(lo, hi, _mm256_set1_epi8('\r'));
+    return m;
+}
+#endif
+
+inline BlockMasks classify(const char* p, size_t n, char delimiter, int quote) {
+#ifdef MCP_FILEOP_X86_SIMD
+    if (n == 64 && cpu::has_avx2()) return classify_avx2(p, delimiter, quote);
+#endif
+    return classify_scalar(p, n, delimiter, quote);
+}
+
+// Bit i set when an odd number of the bits 0..i of x are set: inside quotes after byte i
+inline uint64_t prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+} // namespace
+
+size_t project_columns(const char* data, size_t begin, size_t end, const ColumnSpec& spec, std::string& out) {
+    if (spec.columns.empty()) return 0;
+    size_t wanted = *std::max_element(spec.columns.begin(), spec.columns.end()) + 1;
+    // Field f of the current row is [starts[f], ends[f]); fields past `found` are missing
+    std::vector<size_t> starts(wanted);
+    std::vector<size_t> ends(wanted);
+    size_t rows = 0;
+    size_t pos = begin;
+    while (pos < end) {
+        size_t found = 0;
+        starts[0] = pos;
+        size_t line_end = end;
+        uint64_t quoted_carry = 0;
+        // Separators are collected until the row has every wanted field; the rest of the row
+        // is only searched for its terminator
+        for (size_t block = pos; block < end;) {
+            size_t n = std::min<size_t>(64, end - block);
+            BlockMasks m = classify(data + block, n, spec.delimiter, spec.quote);
+            uint64_t valid = n == 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+            uint64_t terminators = m.terminator & valid;
+            uint64_t before_end = terminators ? (uint64_t(1) << __builtin_ctzll(terminators)) - 1 : valid;
+            if (found < wanted) {
+                uint64_t quoted = prefix_xor(m.quote) ^ quoted_carry;
+                uint64_t separators = m.delimiter & ~quoted & before_end;
+                while (separators && found < wanted) {
+                    size_t at = block + (size_t)__builtin_ctzll(separators);
+                    ends[found] = at;
+                    if (++found < wanted) starts[found] = at + 1;
+                    separators &= separators - 1;
+                }
+                quoted_carry = (uint64_t)0 - (quoted >> 63);
+            }
+            if (terminators) {
+                line_end = block + (size_t)__builtin_ctzll(terminators);
+                break;
+            }
+            block += n;
+        }
+        // The last field runs to the end of the row
+        if (found < wanted) ends[found++] = line_end;
+
+        for (size_t k = 0; k < spec.columns.size(); ++k) {
+            if (k > 0) out += spec.delimiter;
+            size_t c = spec.columns[k];
+            if (c < found) out.append(data + starts[c], ends[c] - starts[c]);
+        }
+        out += '\n';
+        ++rows;
+
+        pos = line_end;
+        if (pos < end) {
+            char c = data[pos++];
+            if (pos < end && (data[pos] == '\n' || data[pos] == '\r') && data[pos] != c) ++pos;
+        }
+    }
+    return rows;
+}
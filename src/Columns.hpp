@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Field selection for 'columns' reads of delimited text (CSV, TSV)
+struct ColumnSpec {
+    char delimiter = ',';
+    // Quote character, or -1 when fields are never quoted. A quote toggles quoting wherever it
+    // appears, so RFC 4180 doubled quotes inside a quoted field keep it quoted.
+    int quote = '"';
+    // Zero-based column numbers, in output order; repeats are allowed
+    std::vector<size_t> columns;
+};
+
+// Append the selected fields of every line in [begin, end) to `out`, copied verbatim (quotes
+// included) and joined by the delimiter, one output line per input line ending in '\n'. Rows are
+// the lines 'lines' reads count, so a quoted field spanning a line break is split like the line.
+// Fields a row does not have are empty. Returns the number of rows.
+size_t project_columns(const char* data, size_t begin, size_t end, const ColumnSpec& spec, std::string& out);
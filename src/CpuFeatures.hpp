@@ -0,0 +1,40 @@
+#pragma once
+
+// Runtime CPU feature detection used to pick SIMD kernels. SSE2 is always
+// available on x86-64; wider instruction sets are probed once at startup. __builtin_cpu_init is
+// called explicitly because kernels may be selected from static initializers.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MCP_FILEOP_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace cpu {
+
+inline bool has_sse42() {
+#ifdef MCP_FILEOP_X86_SIMD
+    static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("sse4.2"));
+    return supported;
+#else
+    return false;
+#endif
+}
+
+inline bool has_avx2() {
+#ifdef MCP_FILEOP_X86_SIMD
+    static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+    return supported;
+#else
+    return false;
+#endif
+}
+
+inline bool has_avx512bw() {
+#ifdef MCP_FILEOP_X86_SIMD
+    static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"));
+    return supported;
+#else
+    return false;
+#endif
+}
+
+} // namespace cpu
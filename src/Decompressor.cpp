@@ -0,0 +1,316 @@
+#include "Decompressor.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#ifdef MCP_FILEOP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef MCP_FILEOP_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+size_t Decompressor::size() const {
+    return offsets.back();
+}
+
+size_t Decompressor::blockCount() const {
+    return offsets.size() - 1;
+}
+
+size_t Decompressor::blockOffset(size_t block) const {
+    return offsets[block];
+}
+
+size_t Decompressor::blockAt(size_t offset) const {
+    auto it = std::upper_bound(offsets.begin(), offsets.end() - 1, (uint64_t)offset);
+    return (size_t)(it - offsets.begin()) - 1;
+}
+
+namespace {
+
+#ifdef MCP_FILEOP_HAVE_ZLIB
+// inflate's avail_in is 32-bit: input is handed over in slices of at most this size
+constexpr size_t kMaxInflateInput = 1u << 30;
+constexpr size_t kWindowSize = 32768;
+
+struct InflateStream {
+    z_stream strm{};
+
+    explicit InflateStream(int windowBits) {
+        if (inflateInit2(&strm, windowBits) != Z_OK) {
+            throw std::runtime_error("Failed to initialize inflate");
+        }
+    }
+    ~InflateStream() {
+        inflateEnd(&strm);
+    }
+};
+
+inline bool is_gzip(const char* data, size_t size) {
+    return size >= 2 && (unsigned char)data[0] == 0x1f && (unsigned char)data[1] == 0x8b;
+}
+
+class GzipDecompressor : public Decompressor {
+public:
+    GzipDecompressor(const char* data, size_t size) : data(data), compressedSize(size) {
+        build();
+    }
+
+    const char* format() const override {
+        return "gzip";
+    }
+
+    void decompressBlock(size_t block, char* out) const override {
+        size_t length = offsets[block + 1] - offsets[block];
+        if (length == 0) {
+            return;
+        }
+        const Checkpoint& cp = checkpoints[block];
+        InflateStream stream(-15);
+        z_stream& strm = stream.strm;
+        // The checkpoint's deflate block starts `bits` bits before byte `in`
+        if (cp.bits) {
+            int byte = (unsigned char)data[cp.in - 1];
+            inflatePrime(&strm, cp.bits, byte >> (8 - cp.bits));
+        }
+        if (!cp.window.empty()) {
+            inflateSetDictionary(&strm, cp.window.data(), (uInt)cp.window.size());
+        }
+        size_t in = cp.in;
+        bool raw = true;
+        strm.next_out = reinterpret_cast<Bytef*>(out);
+        strm.avail_out = (uInt)length;
+        while (strm.avail_out > 0) {
+            if (strm.avail_in == 0) {
+                if (in >= compressedSize) {
+                    throw std::runtime_error("Truncated gzip data");
+                }
+                feed(strm, in);
+            }
+            int ret = inflate(&strm, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END && strm.avail_out > 0) {
+                // The member ends inside the block: go on with the next one. A raw stream leaves
+                // the 8-byte member trailer unread.
+                in = in - strm.avail_in + (raw ? 8 : 0);
+                strm.avail_in = 0;
+                if (in >= compressedSize || inflateReset2(&strm, 47) != Z_OK) {
+                    throw std::runtime_error("Truncated gzip data");
+                }
+                raw = false;
+                continue;
+            }
+            if (ret != Z_OK && ret != Z_STREAM_END) {
+                throw std::runtime_error("Corrupt gzip data");
+            }
+        }
+    }
+
+    size_t indexBytes() const override {
+        size_t bytes = offsets.size() * sizeof(uint64_t) + checkpoints.size() * sizeof(Checkpoint);
+        for (const auto& cp : checkpoints) {
+            bytes += cp.window.size();
+        }
+        return bytes;
+    }
+
+private:
+    struct Checkpoint {
+        size_t in = 0; // compressed offset of the first whole byte of the deflate block
+        int bits = 0;  // bits of the previous byte that belong to the block
+        std::vector<unsigned char> window;
+    };
+
+    void feed(z_stream& strm, size_t& in) const {
+        size_t n = std::min(compressedSize - in, kMaxInflateInput);
+        strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data + in));
+        strm.avail_in = (uInt)n;
+        in += n;
+    }
+
+    // One pass over the whole file, stopping at every deflate block boundary to decide whether
+    // to record a checkpoint; output goes to a circular window that the checkpoint copies
+    void build() {
+        InflateStream stream(47); // gzip or zlib header
+        z_stream& strm = stream.strm;
+        std::vector<unsigned char> window(kWindowSize);
+        size_t in = 0;
+        uint64_t total_in = 0;
+        uint64_t total_out = 0;
+        uint64_t last = 0;
+        while (true) {
+            if (strm.avail_in == 0) {
+                if (in >= compressedSize) {
+                    throw std::runtime_error("Truncated gzip data");
+                }
+                feed(strm, in);
+            }
+            if (strm.avail_out == 0) {
+                strm.next_out = window.data();
+                strm.avail_out = (uInt)kWindowSize;
+            }
+            total_in += strm.avail_in;
+            total_out += strm.avail_out;
+            int ret = inflate(&strm, Z_BLOCK);
+            total_in -= strm.avail_in;
+            total_out -= strm.avail_out;
+            if (ret == Z_STREAM_END) {
+                // Concatenated members decompress as one stream; anything else after a member is ignored
+                if (!is_gzip(data + total_in, compressedSize - total_in)) {
+                    break;
+                }
+                inflateReset(&strm);
+                continue;
+            }
+            if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                throw std::runtime_error("Corrupt gzip data");
+            }
+            // At the end of a block that is not the member's last one
+            bool boundary = (strm.data_type & 128) && !(strm.data_type & 64);
+            if (boundary && (checkpoints.empty() || total_out - last >= kGzipSpan)) {
+                Checkpoint cp;
+                cp.in = (size_t)total_in;
+                cp.bits = strm.data_type & 7;
+                size_t kept = (size_t)std::min<uint64_t>(total_out, kWindowSize);
+                size_t filled = kWindowSize - strm.avail_out; // bytes written since the window last wrapped
+                cp.window.resize(kept);
+                if (kept > filled) {
+                    std::memcpy(cp.window.data(), window.data() + kWindowSize - (kept - filled), kept - filled);
+                }
+                std::memcpy(cp.window.data() + kept - std::min(kept, filled), window.data() + filled - std::min(kept, filled), std::min(kept, filled));
+                checkpoints.push_back(std::move(cp));
+                offsets.push_back(total_out);
+                last = total_out;
+            }
+        }
+        offsets.push_back(total_out);
+    }
+
+    const char* data;
+    size_t compressedSize;
+    std::vector<Checkpoint> checkpoints;
+};
+#endif
+
+#ifdef MCP_FILEOP_HAVE_ZSTD
+inline uint32_t frame_magic(const char* data, size_t size) {
+    if (size < 4) {
+        return 0;
+    }
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+inline bool is_skippable(const char* data, size_t size) {
+    return (frame_magic(data, size) & ZSTD_MAGIC_SKIPPABLE_MASK) == ZSTD_MAGIC_SKIPPABLE_START;
+}
+
+inline bool is_zstd(const char* data, size_t size) {
+    return frame_magic(data, size) == ZSTD_MAGICNUMBER || is_skippable(data, size);
+}
+
+struct DCtxDeleter {
+    void operator()(ZSTD_DCtx* ctx) const {
+        ZSTD_freeDCtx(ctx);
+    }
+};
+
+ZSTD_DCtx* thread_dctx() {
+    thread_local std::unique_ptr<ZSTD_DCtx, DCtxDeleter> ctx(ZSTD_createDCtx());
+    if (!ctx) {
+        throw std::runtime_error("Failed to create zstd context");
+    }
+    return ctx.get();
+}
+
+// Every frame is one block: files written as a single frame decompress as a whole, while
+// multi-frame files (pzstd output, the seekable format) get one block per frame
+class ZstdDecompressor : public Decompressor {
+public:
+    ZstdDecompressor(const char* data, size_t size) : data(data) {
+        uint64_t total = 0;
+        for (size_t pos = 0; pos < size;) {
+            size_t frame_size = ZSTD_findFrameCompressedSize(data + pos, size - pos);
+            if (ZSTD_isError(frame_size)) {
+                throw std::runtime_error(std::string("Corrupt zstd data: ") + ZSTD_getErrorName(frame_size));
+            }
+            if (!is_skippable(data + pos, frame_size)) {
+                unsigned long long content = ZSTD_getFrameContentSize(data + pos, frame_size);
+                if (content == ZSTD_CONTENTSIZE_ERROR) {
+                    throw std::runtime_error("Corrupt zstd data");
+                }
+                if (content == ZSTD_CONTENTSIZE_UNKNOWN) {
+                    content = measureFrame(data + pos, frame_size);
+                }
+                frames.push_back({pos, frame_size});
+                offsets.push_back(total);
+                total += content;
+            }
+            pos += frame_size;
+        }
+        offsets.push_back(total);
+    }
+
+    const char* format() const override {
+        return "zstd";
+    }
+
+    void decompressBlock(size_t block, char* out) const override {
+        size_t length = offsets[block + 1] - offsets[block];
+        const Frame& frame = frames[block];
+        size_t n = ZSTD_decompressDCtx(thread_dctx(), out, length, data + frame.in, frame.size);
+        if (ZSTD_isError(n) || n != length) {
+            throw std::runtime_error("Corrupt zstd data");
+        }
+    }
+
+    size_t indexBytes() const override {
+        return offsets.size() * sizeof(uint64_t) + frames.size() * sizeof(Frame);
+    }
+
+private:
+    struct Frame {
+        size_t in;
+        size_t size;
+    };
+
+    // Decompressed size of a frame whose header does not record it
+    static uint64_t measureFrame(const char* frame, size_t size) {
+        ZSTD_DCtx* ctx = thread_dctx();
+        ZSTD_DCtx_reset(ctx, ZSTD_reset_session_only);
+        std::vector<char> scratch(ZSTD_DStreamOutSize());
+        ZSTD_inBuffer input = {frame, size, 0};
+        uint64_t total = 0;
+        size_t ret = 1;
+        while (ret != 0) {
+            ZSTD_outBuffer output = {scratch.data(), scratch.size(), 0};
+            ret = ZSTD_decompressStream(ctx, &output, &input);
+            if (ZSTD_isError(ret) || (ret != 0 && output.pos == 0 && input.pos == input.size)) {
+                throw std::runtime_error("Corrupt zstd data");
+            }
+            total += output.pos;
+        }
+        return total;
+    }
+
+    const char* data;
+    std::vector<Frame> frames;
+};
+#endif
+
+} // namespace
+
+std::unique_ptr<Decompressor> Decompressor::open(const char* data, size_t size) {
+#ifdef MCP_FILEOP_HAVE_ZLIB
+    if (is_gzip(data, size)) {
+        return std::make_unique<GzipDecompressor>(data, size);
+    }
+#endif
+#ifdef MCP_FILEOP_HAVE_ZSTD
+    if (is_zstd(data, size)) {
+        return std::make_unique<ZstdDecompressor>(data, size);
+    }
+#endif
+    (void)data;
+    (void)size;
+    return nullptr;
+}
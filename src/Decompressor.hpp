@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Random access into a compressed file through independently decompressible blocks. gzip files
+// get a checkpoint every kGzipSpan output bytes holding the 32 KiB window inflate needs to resume
+// there (as in zlib's zran example); zstd files are split at frame boundaries.
+class Decompressor {
+public:
+    static constexpr size_t kGzipSpan = 1024 * 1024;
+
+    virtual ~Decompressor() = default;
+
+    // Index `data` (the mapped compressed file, which must outlive the decompressor) in one
+    // decompression pass. Returns nullptr when the data is not in a format this build supports;
+    // throws std::runtime_error on corrupt input.
+    static std::unique_ptr<Decompressor> open(const char* data, size_t size);
+
+    // "gzip" or "zstd"
+    virtual const char* format() const = 0;
+    // Decompressed size
+    size_t size() const;
+    size_t blockCount() const;
+    // Decompressed offset of `block`; blockOffset(blockCount()) == size()
+    size_t blockOffset(size_t block) const;
+    // Block containing decompressed byte `offset`
+    size_t blockAt(size_t offset) const;
+    // Write the decompressed bytes of `block` to `out` (blockOffset(block + 1) - blockOffset(block) bytes)
+    virtual void decompressBlock(size_t block, char* out) const = 0;
+    // Bytes held by the index itself
+    virtual size_t indexBytes() const = 0;
+
+protected:
+    std::vector<uint64_t> offsets; // block start offsets followed by the decompressed size
+};
@@ -0,0 +1,534 @@
+#include "Encoding.hpp"
+#include "CpuFeatures.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr std::array<char, 512> make_hex_table() {
+    std::array<char, 512> table{};
+    const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < 256; ++i) {
+        table[i * 2] = digits[i >> 4];
+        table[i * 2 + 1] = digits[i & 0x0f];
+    }
+    return table;
+}
+
+constexpr std::array<char, 512> kHexTable = make_hex_table();
+
+void encode_hex_scalar(const unsigned char* in, size_t size, char* out) {
+    for (size_t i = 0; i < size; ++i) {
+        const char* pair = &kHexTable[in[i] * 2];
+        out[i * 2] = pair[0];
+        out[i * 2 + 1] = pair[1];
+    }
+}
+
+#ifdef MCP_FILEOP_X86_SIMD
+// Nibbles (0..15) to ASCII: x + '0', plus 39 more for 'a'..'f'
+inline __m128i nibbles_to_ascii(__m128i x) {
+    __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+    return _mm_add_epi8(_mm_add_epi8(x, _mm_set1_epi8('0')), letters);
+}
+
+size_t encode_hex_sse2(const unsigned char* in, size_t size, char* out) {
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i hi = nibbles_to_ascii(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i lo = nibbles_to_ascii(_mm_and_si128(v, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t encode_hex_avx2(const unsigned char* in, size_t size, char* out) {
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    const __m256i nine = _mm256_set1_epi8(9);
+    const __m256i zero_char = _mm256_set1_epi8('0');
+    const __m256i letter_gap = _mm256_set1_epi8('a' - '0' - 10);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask);
+        __m256i lo = _mm256_and_si256(v, mask);
+        hi = _mm256_add_epi8(_mm256_add_epi8(hi, zero_char), _mm256_and_si256(_mm256_cmpgt_epi8(hi, nine), letter_gap));
+        lo = _mm256_add_epi8(_mm256_add_epi8(lo, zero_char), _mm256_and_si256(_mm256_cmpgt_epi8(lo, nine), letter_gap));
+        // unpack works per 128-bit lane: a = bytes [0..7 | 16..23], b = bytes [8..15 | 24..31]
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2 + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    return i;
+}
+#endif
+
+constexpr char kBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+constexpr std::array<int8_t, 256> make_base64_decode_table() {
+    std::array<int8_t, 256> table{};
+    for (auto& v : table) v = -1;
+    for (int i = 0; i < 64; ++i) table[(unsigned char)kBase64Alphabet[i]] = (int8_t)i;
+    return table;
+}
+
+constexpr std::array<int8_t, 256> kBase64DecodeTable = make_base64_decode_table();
+
+// Encodes complete 3-byte groups; returns the number of input bytes consumed
+size_t encode_base64_scalar(const unsigned char* in, size_t size, char* out) {
+    size_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16 | (uint32_t)in[i + 1] << 8 | in[i + 2];
+        *out++ = kBase64Alphabet[(v >> 18) & 63];
+        *out++ = kBase64Alphabet[(v >> 12) & 63];
+        *out++ = kBase64Alphabet[(v >> 6) & 63];
+        *out++ = kBase64Alphabet[v & 63];
+    }
+    return i;
+}
+
+// Decodes complete 4-char groups without padding; returns the number of chars consumed, stopping
+// early at the first group containing a character outside the alphabet
+size_t decode_base64_scalar(const unsigned char* in, size_t size, char* out) {
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        int a = kBase64DecodeTable[in[i]];
+        int b = kBase64DecodeTable[in[i + 1]];
+        int c = kBase64DecodeTable[in[i + 2]];
+        int d = kBase64DecodeTable[in[i + 3]];
+        if ((a | b | c | d) < 0) break;
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | (uint32_t)d;
+        *out++ = (char)(v >> 16);
+        *out++ = (char)(v >> 8);
+        *out++ = (char)v;
+    }
+    return i;
+}
+
+#ifdef MCP_FILEOP_X86_SIMD
+// 24 input bytes -> 32 chars per step (the two 16-byte loads read 4 bytes past the group)
+__attribute__((target("avx2")))
+size_t encode_base64_avx2(const unsigned char* in, size_t size, char* out) {
+    // Per 128-bit lane: spread 12 bytes into 16, one 3-byte group per 32-bit word as [b1 b0 b2 b1]
+    const __m256i spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    // Offset added to each 6-bit value, selected by its range (A-Z, a-z, 0-9, '+', '/')
+    const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                             'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    size_t i = 0;
+    for (; i + 28 <= size; i += 24) {
+        __m256i v = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12)), 1);
+        v = _mm256_shuffle_epi8(v, spread);
+        // Move the four 6-bit fields of each word into separate bytes
+        __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(t0, t1);
+        // Map 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12 and look up the offset
+        __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        range = _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+        __m256i chars = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i / 3 * 4), chars);
+    }
+    return i;
+}
+
+// 32 chars -> 24 bytes per step; stops at the first block containing a non-alphabet character
+// (including '=' padding) so the scalar code can handle or reject it
+__attribute__((target("avx2")))
+size_t decode_base64_avx2(const unsigned char* in, size_t size, char* out) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        // Signed compares: bytes >= 0x80 are negative and fall outside every range
+        __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), c));
+        __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), c));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+        __m256i plus = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('+'));
+        __m256i slash = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('/'));
+        __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(_mm256_or_si256(digit, plus), slash));
+        if ((uint32_t)_mm256_movemask_epi8(valid) != 0xffffffffu) break;
+        __m256i shift = _mm256_or_si256(
+            _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-65)), _mm256_and_si256(lower, _mm256_set1_epi8(-71))),
+            _mm256_or_si256(_mm256_and_si256(digit, _mm256_set1_epi8(4)),
+                            _mm256_or_si256(_mm256_and_si256(plus, _mm256_set1_epi8(19)), _mm256_and_si256(slash, _mm256_set1_epi8(16)))));
+        __m256i values = _mm256_add_epi8(c, shift);
+        // Pack four 6-bit values per word into 24 bits, then gather 12 bytes per lane
+        __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        words = _mm256_shuffle_epi8(words, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        words = _mm256_permutevar8x32_epi32(words, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        alignas(32) char block[32];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(block), words);
+        std::memcpy(out + i / 4 * 3, block, 24);
+    }
+    return i;
+}
+#endif
+
+// Length of the well-formed UTF-8 sequence (RFC 3629) starting at `in`, or 0 if it is invalid
+size_t utf8_sequence_length(const unsigned char* in, size_t size) {
+    unsigned char c = in[0];
+    size_t len;
+    unsigned char lo = 0x80, hi = 0xbf;
+    if (c >= 0xc2 && c <= 0xdf) {
+        len = 2;
+    } else if (c >= 0xe0 && c <= 0xef) {
+        len = 3;
+        if (c == 0xe0) lo = 0xa0;
+        if (c == 0xed) hi = 0x9f;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        len = 4;
+        if (c == 0xf0) lo = 0x90;
+        if (c == 0xf4) hi = 0x8f;
+    } else {
+        return 0;
+    }
+    if (size < len || in[1] < lo || in[1] > hi) return 0;
+    for (size_t i = 2; i < len; ++i) {
+        if (in[i] < 0x80 || in[i] > 0xbf) return 0;
+    }
+    return len;
+}
+
+#ifdef MCP_FILEOP_X86_SIMD
+// Length of the prefix that JSON strings can carry verbatim: whole 16-byte ASCII blocks without '"',
+// '\\' or control characters, then the clean ASCII part of the first block that is not.
+// `scalar_run` receives how many of the following bytes are better escaped one at a time.
+size_t json_clean_prefix_sse2(const unsigned char* in, size_t size, size_t& scalar_run) {
+    scalar_run = 0;
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control_max = _mm_set1_epi8(0x1f);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(v, control_max), control_max);
+        __m128i special = _mm_or_si128(control, _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+        uint32_t special_mask = (uint32_t)_mm_movemask_epi8(special);
+        uint32_t high_mask = (uint32_t)_mm_movemask_epi8(v);
+        if ((special_mask | high_mask) == 0) continue;
+        size_t stop = (size_t)__builtin_ctz(special_mask | high_mask);
+        // Non-ASCII text is validated byte by byte for the rest of the block
+        if (high_mask) scalar_run = 16 - stop;
+        return i + stop;
+    }
+    return i;
+}
+
+// UTF-8 validation of a 32-byte block that starts on a character boundary (Keiser & Lemire, "Validating
+// UTF-8 In Less Than One Instruction Per Byte"): each byte pair is classified through three nibble
+// lookups, and 3rd/4th bytes of long sequences are checked against the lead two and three bytes
+// back. Returns a non-zero vector on any error; a sequence cut off at the block end is not an error.
+__attribute__((target("avx2")))
+__m256i utf8_errors_avx2(__m256i input) {
+    constexpr uint8_t TOO_SHORT = 1 << 0;
+    constexpr uint8_t TOO_LONG = 1 << 1;
+    constexpr uint8_t OVERLONG_3 = 1 << 2;
+    constexpr uint8_t TOO_LARGE = 1 << 3;
+    constexpr uint8_t SURROGATE = 1 << 4;
+    constexpr uint8_t OVERLONG_2 = 1 << 5;
+    constexpr uint8_t TOO_LARGE_1000 = 1 << 6;
+    constexpr uint8_t OVERLONG_4 = 1 << 6;
+    constexpr uint8_t TWO_CONTS = 1 << 7;
+    constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+    const __m256i byte_1_high_table = _mm256_setr_epi8(
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2, TOO_SHORT, TOO_SHORT | OVERLONG_3 | SURROGATE,
+        (char)(TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4),
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2, TOO_SHORT, TOO_SHORT | OVERLONG_3 | SURROGATE,
+        (char)(TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4));
+    const __m256i byte_1_low_table = _mm256_setr_epi8(
+        (char)(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4), (char)(CARRY | OVERLONG_2), (char)CARRY, (char)CARRY,
+        (char)(CARRY | TOO_LARGE), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4), (char)(CARRY | OVERLONG_2), (char)CARRY, (char)CARRY,
+        (char)(CARRY | TOO_LARGE), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000), (char)(CARRY | TOO_LARGE | TOO_LARGE_1000));
+    const __m256i byte_2_high_table = _mm256_setr_epi8(
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    // The block starts on a character boundary, so the bytes before it act as ASCII (zero)
+    __m256i shifted_in = _mm256_permute2x128_si256(_mm256_setzero_si256(), input, 0x21);
+    __m256i prev1 = _mm256_alignr_epi8(input, shifted_in, 15);
+    __m256i prev2 = _mm256_alignr_epi8(input, shifted_in, 14);
+    __m256i prev3 = _mm256_alignr_epi8(input, shifted_in, 13);
+
+    __m256i byte_1_high = _mm256_shuffle_epi8(byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+    __m256i byte_1_low = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, nibble));
+    __m256i byte_2_high = _mm256_shuffle_epi8(byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+    __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+    // Bytes two after a 3/4-byte lead or three after a 4-byte lead must be continuations
+    __m256i is_third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xe0 - 0x80)));
+    __m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xf0 - 0x80)));
+    __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must_be_continuation, special_cases);
+}
+
+// AVX2 variant of json_clean_prefix_sse2 that also passes valid UTF-8 through: a 32-byte block with
+// non-ASCII bytes is clean when it validates, up to a multi-byte sequence cut off at its end. Only
+// blocks with invalid UTF-8 are handed to the byte-by-byte path.
+__attribute__((target("avx2")))
+size_t json_clean_prefix_avx2(const unsigned char* in, size_t size, size_t& scalar_run) {
+    scalar_run = 0;
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control_max = _mm256_set1_epi8(0x1f);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i control = _mm256_cmpeq_epi8(_mm256_max_epu8(v, control_max), control_max);
+        __m256i special = _mm256_or_si256(control, _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)));
+        uint32_t special_mask = (uint32_t)_mm256_movemask_epi8(special);
+        uint32_t high_mask = (uint32_t)_mm256_movemask_epi8(v);
+        if ((special_mask | high_mask) == 0) continue;
+        if (high_mask == 0) return i + (size_t)__builtin_ctz(special_mask);
+
+        __m256i errors = utf8_errors_avx2(v);
+        if (!_mm256_testz_si256(errors, errors)) {
+            size_t stop = (size_t)__builtin_ctz(special_mask | high_mask);
+            scalar_run = 32 - stop;
+            return i + stop;
+        }
+        // In a valid block an ASCII special always follows a complete character
+        if (special_mask) return i + (size_t)__builtin_ctz(special_mask);
+        const unsigned char* block = in + i;
+        if (block[31] >= 0xc0) return i + 31;
+        if (block[30] >= 0xe0) return i + 30;
+        if (block[29] >= 0xf0) return i + 29;
+    }
+    return i;
+}
+
+// Length of the valid UTF-8 prefix made of whole 32-byte blocks, each either ASCII or validating
+// (minus a sequence cut off at the block end); stops at the first block with an error
+__attribute__((target("avx2")))
+size_t utf8_valid_prefix_avx2(const unsigned char* in, size_t size) {
+    size_t i = 0;
+    while (i + 32 <= size) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        if (_mm256_movemask_epi8(v) == 0) {
+            i += 32;
+            continue;
+        }
+        __m256i errors = utf8_errors_avx2(v);
+        if (!_mm256_testz_si256(errors, errors)) break;
+        const unsigned char* block = in + i;
+        if (block[31] >= 0xc0) i += 31;
+        else if (block[30] >= 0xe0) i += 30;
+        else if (block[29] >= 0xf0) i += 29;
+        else i += 32;
+    }
+    return i;
+}
+#endif
+
+} // namespace
+
+void encode_hex_into(const char* data, size_t size, char* out) {
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+    size_t done = 0;
+#ifdef MCP_FILEOP_X86_SIMD
+    done = cpu::has_avx2() ? encode_hex_avx2(in, size, out) : encode_hex_sse2(in, size, out);
+#endif
+    encode_hex_scalar(in + done, size - done, out + done * 2);
+}
+
+std::string encode_hex(const char* data, size_t size) {
+    std::string out(size * 2, '\0');
+    encode_hex_into(data, size, out.data());
+    return out;
+}
+
+size_t base64_encoded_size(size_t size) {
+    return (size + 2) / 3 * 4;
+}
+
+void encode_base64_into(const char* data, size_t size, char* out) {
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+    size_t done = 0;
+#ifdef MCP_FILEOP_X86_SIMD
+    if (cpu::has_avx2()) done = encode_base64_avx2(in, size, out);
+#endif
+    done += encode_base64_scalar(in + done, size - done, out + done / 3 * 4);
+    out += done / 3 * 4;
+    size_t rest = size - done;
+    if (rest > 0) {
+        uint32_t v = (uint32_t)in[done] << 16 | (rest > 1 ? (uint32_t)in[done + 1] << 8 : 0);
+        out[0] = kBase64Alphabet[(v >> 18) & 63];
+        out[1] = kBase64Alphabet[(v >> 12) & 63];
+        out[2] = rest > 1 ? kBase64Alphabet[(v >> 6) & 63] : '=';
+        out[3] = '=';
+    }
+}
+
+std::string encode_base64(const char* data, size_t size) {
+    std::string out(base64_encoded_size(size), '\0');
+    encode_base64_into(data, size, out.data());
+    return out;
+}
+
+bool decode_base64(const char* data, size_t size, std::string& out) {
+    out.clear();
+    if (size % 4 != 0) return false;
+    size_t padding = 0;
+    if (size > 0 && data[size - 1] == '=') ++padding;
+    if (size > 1 && data[size - 2] == '=') ++padding;
+    out.resize(size / 4 * 3);
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+    // Full groups are all but the last one when it carries padding
+    size_t body = padding ? size - 4 : size;
+    size_t done = 0;
+#ifdef MCP_FILEOP_X86_SIMD
+    if (cpu::has_avx2()) done = decode_base64_avx2(in, body, out.data());
+#endif
+    done += decode_base64_scalar(in + done, body - done, out.data() + done / 4 * 3);
+    if (done != body) return false;
+    if (padding) {
+        int a = kBase64DecodeTable[in[body]];
+        int b = kBase64DecodeTable[in[body + 1]];
+        int c = padding == 1 ? kBase64DecodeTable[in[body + 2]] : 0;
+        if ((a | b | c) < 0) return false;
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6;
+        char* tail = out.data() + body / 4 * 3;
+        tail[0] = (char)(v >> 16);
+        if (padding == 1) tail[1] = (char)(v >> 8);
+    }
+    out.resize(size / 4 * 3 - padding);
+    return true;
+}
+
+size_t escape_json_into(const char* data, size_t size, char* out, size_t capacity, size_t& consumed) {
+    static const char digits[] = "0123456789abcdef";
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+    size_t i = 0;
+    size_t o = 0;
+    // Bytes before this position are escaped one at a time (see json_clean_prefix_*)
+    size_t scalar_end = 0;
+    while (i < size && capacity - o >= 6) {
+#ifdef MCP_FILEOP_X86_SIMD
+        if (i >= scalar_end) {
+            // Copy the run of bytes that need no escaping in one go
+            size_t scalar_run = 0;
+            size_t limit = std::min(size - i, capacity - o);
+            size_t clean = cpu::has_avx2() ? json_clean_prefix_avx2(in + i, limit, scalar_run)
+                                           : json_clean_prefix_sse2(in + i, limit, scalar_run);
+            std::memcpy(out + o, in + i, clean);
+            i += clean;
+            o += clean;
+            scalar_end = i + scalar_run;
+            if (i == size || capacity - o < 6) break;
+        }
+#endif
+        unsigned char c = in[i];
+        if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\') {
+            out[o++] = (char)c;
+            ++i;
+        } else if (c < 0x80) {
+            out[o++] = '\\';
+            switch (c) {
+                case '"': out[o++] = '"'; break;
+                case '\\': out[o++] = '\\'; break;
+                case '\b': out[o++] = 'b'; break;
+                case '\f': out[o++] = 'f'; break;
+                case '\n': out[o++] = 'n'; break;
+                case '\r': out[o++] = 'r'; break;
+                case '\t': out[o++] = 't'; break;
+                default:
+                    std::memcpy(out + o, "u00", 3);
+                    out[o + 3] = digits[c >> 4];
+                    out[o + 4] = digits[c & 0x0f];
+                    o += 5;
+            }
+            ++i;
+        } else if (size_t len = utf8_sequence_length(in + i, size - i)) {
+            std::memcpy(out + o, in + i, len);
+            o += len;
+            i += len;
+        } else {
+            std::memcpy(out + o, "\\ufffd", 6);
+            o += 6;
+            ++i;
+        }
+    }
+    consumed = i;
+    return o;
+}
+
+std::string escape_json(const char* data, size_t size) {
+    std::string out;
+    size_t pos = 0;
+    while (pos < size) {
+        size_t old_size = out.size();
+        // Plain ASCII is the common case: reserve for a 1:1 copy and grow if escapes expand it
+        out.resize(old_size + std::max<size_t>(size - pos, 64));
+        size_t consumed = 0;
+        size_t written = escape_json_into(data + pos, size - pos, out.data() + old_size, out.size() - old_size, consumed);
+        out.resize(old_size + written);
+        pos += consumed;
+    }
+    return out;
+}
+
+size_t utf8_valid_prefix(const char* data, size_t size) {
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+    size_t i = 0;
+    while (i < size) {
+#ifdef MCP_FILEOP_X86_SIMD
+        if (cpu::has_avx2()) {
+            i += utf8_valid_prefix_avx2(in + i, size - i);
+            if (i == size) break;
+        }
+#endif
+        // One block character by character (the block with an error, the tail, or everything
+        // without AVX2), then back to the vector path on a character boundary
+        size_t block_end = std::min(size, i + 32);
+        while (i < block_end) {
+            if (in[i] < 0x80) {
+                ++i;
+            } else if (size_t len = utf8_sequence_length(in + i, size - i)) {
+                i += len;
+            } else {
+                return i;
+            }
+        }
+    }
+    return size;
+}
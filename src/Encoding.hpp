@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Lowercase hex encoding ("0aff..."), two output chars per input byte. The SIMD path (SSE2, AVX2
+// picked at runtime) handles 16/32-byte blocks; a 256-entry table handles the tail.
+void encode_hex_into(const char* data, size_t size, char* out);
+std::string encode_hex(const char* data, size_t size);
+
+// Standard base64 (RFC 4648, '+' '/' alphabet, '=' padding). Encoding and decoding run 24 input /
+// 32 output bytes per step with AVX2 when available, falling back to table-driven scalar code.
+size_t base64_encoded_size(size_t size);
+void encode_base64_into(const char* data, size_t size, char* out);
+std::string encode_base64(const char* data, size_t size);
+// Returns false on characters outside the alphabet, misplaced padding or a truncated final quantum
+bool decode_base64(const char* data, size_t size, std::string& out);
+
+// JSON string-body escaping: '"', '\\' and control characters are escaped, valid UTF-8 is copied
+// through and every byte of an invalid sequence becomes \ufffd. Writes at most `capacity` bytes,
+// stopping before a character that would not fit (6 bytes always suffice for the next one), and
+// reports the input consumed so large inputs can be escaped in bounded chunks. Runs that need no
+// escaping are found and copied 16 (SSE2) or 32 (AVX2, including UTF-8 validation) bytes at a time.
+size_t escape_json_into(const char* data, size_t size, char* out, size_t capacity, size_t& consumed);
+std::string escape_json(const char* data, size_t size);
+
+// Offset of the first byte that is not part of a well-formed UTF-8 sequence, or `size` if the data
+// is valid UTF-8. ASCII and valid multi-byte text are checked 32 bytes at a time with AVX2.
+size_t utf8_valid_prefix(const char* data, size_t size);
@@ -1,10 +1,23 @@
 #include "FileOpController.hpp"
+#include "Checksum.hpp"
+#include "Columns.hpp"
+#include "Records.hpp"
+#include "Encoding.hpp"
+#include "Search.hpp"
+#include "Seek.hpp"
 #include <filesystem>
+#include <cstdio>
 #include <sstream>
 #include <iomanip>
 #include <vector>
+#include <map>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <sys/stat.h>
 
 FileOpController::FileOpController() {
+    registry_.setTaskflowManager(&taskflow_);
 }
 
 Json::Value FileOpController::createResponse(const Json::Value& id, const Json::Value& result) const {
@@ -29,7 +42,7 @@ Json::Value FileOpController::listTools() const {
 
     Json::Value fileOpTool;
     fileOpTool["name"] = "fileop";
-    fileOpTool["description"] = "File operations tool supporting preload, read, read_multiple, and close operations on memory-mapped files";
+    fileOpTool["description"] = "File operations tool supporting preload, read, read_multiple, search, seek, checksum, stats, and close operations on memory-mapped files";
     fileOpTool["inputSchema"]["type"] = "object";
 
     // operation parameter
@@ -38,23 +51,59 @@ Json::Value FileOpController::listTools() const {
     fileOpTool["inputSchema"]["properties"]["operation"]["enum"].append("preload");
     fileOpTool["inputSchema"]["properties"]["operation"]["enum"].append("read");
     fileOpTool["inputSchema"]["properties"]["operation"]["enum"].append("read_multiple");
+    fileOpTool["inputSchema"]["properties"]["operation"]["enum"].append("search");
+    fileOpTool["inputSchema"]["properties"]["operation"]["enum"].append("seek");
+    fileOpTool["inputSchema"]["properties"]["operation"]["enum"].append("checksum");
+    fileOpTool["inputSchema"]["properties"]["operation"]["enum"].append("stats");
     fileOpTool["inputSchema"]["properties"]["operation"]["enum"].append("close");
 
     // path parameter (for preload)
     fileOpTool["inputSchema"]["properties"]["path"]["type"] = "string";
     fileOpTool["inputSchema"]["properties"]["path"]["description"] = "File path to preload (required for 'preload' operation)";
 
+    // line_index parameter (for preload)
+    fileOpTool["inputSchema"]["properties"]["line_index"]["type"] = "boolean";
+    fileOpTool["inputSchema"]["properties"]["line_index"]["description"] = "Build the line index during 'preload' instead of on the first 'lines' read (optional, default: false)";
+
+    // trigram_index parameter (for preload)
+    fileOpTool["inputSchema"]["properties"]["trigram_index"]["type"] = "boolean";
+    fileOpTool["inputSchema"]["properties"]["trigram_index"]["description"] = "Build a trigram index in the background after 'preload' so literal 'search' only verifies candidate blocks (optional, default: false)";
+
     // handler parameter (for read, close)
     fileOpTool["inputSchema"]["properties"]["handler"]["type"] = "string";
-    fileOpTool["inputSchema"]["properties"]["handler"]["description"] = "Handler ID from preload (required for 'read', 'close' operations)";
+    fileOpTool["inputSchema"]["properties"]["handler"]["description"] = "Handler (canonical path) or compact handle returned by preload (required for 'read', 'seek', 'checksum', 'stats', 'close' operations; 'search' accepts it or 'handlers')";
+
+    // search parameters
+    fileOpTool["inputSchema"]["properties"]["pattern"]["type"] = "string";
+    fileOpTool["inputSchema"]["properties"]["pattern"]["description"] = "Literal byte string, or regular expression with 'regex', to find (required for 'search')";
+    fileOpTool["inputSchema"]["properties"]["handlers"]["type"] = "array";
+    fileOpTool["inputSchema"]["properties"]["handlers"]["items"]["type"] = "string";
+    fileOpTool["inputSchema"]["properties"]["handlers"]["description"] = "Handlers to search, in order (optional for 'search'; instead of 'handler')";
+    fileOpTool["inputSchema"]["properties"]["max_matches"]["type"] = "number";
+    fileOpTool["inputSchema"]["properties"]["max_matches"]["description"] = "Maximum number of matches returned by 'search' across all handlers (optional, default: 1000)";
+    fileOpTool["inputSchema"]["properties"]["regex"]["type"] = "boolean";
+    fileOpTool["inputSchema"]["properties"]["regex"]["description"] = "Treat 'pattern' as a regular expression; ^ and $ match at line boundaries (optional for 'search', default: false)";
+    fileOpTool["inputSchema"]["properties"]["context"]["type"] = "number";
+    fileOpTool["inputSchema"]["properties"]["context"]["description"] = "Lines of context returned before and after each match by 'search' (optional, default: 0)";
+
+    // seek parameters
+    fileOpTool["inputSchema"]["properties"]["key"]["type"] = "string";
+    fileOpTool["inputSchema"]["properties"]["key"]["description"] = "Key to find with 'seek' in a file sorted by it; the first line whose key sorts at or after it is returned (required for 'seek')";
+    fileOpTool["inputSchema"]["properties"]["compare"]["type"] = "string";
+    fileOpTool["inputSchema"]["properties"]["compare"]["enum"].append("text");
+    fileOpTool["inputSchema"]["properties"]["compare"]["enum"].append("number");
+    fileOpTool["inputSchema"]["properties"]["compare"]["enum"].append("timestamp");
+    fileOpTool["inputSchema"]["properties"]["compare"]["description"] = "How 'seek' compares line keys with 'key': 'text' compares the first bytes bytewise, 'number' and 'timestamp' (ISO 8601 dates and times, or epoch seconds/milliseconds) parse both and skip lines that do not parse (optional, default: 'text')";
+    fileOpTool["inputSchema"]["properties"]["field"]["type"] = "number";
+    fileOpTool["inputSchema"]["properties"]["field"]["description"] = "Zero-based field holding the 'seek' key, split by 'delimiter' (optional, default: the start of the line)";
 
     // offset parameter (for read)
     fileOpTool["inputSchema"]["properties"]["offset"]["type"] = "number";
-    fileOpTool["inputSchema"]["properties"]["offset"]["description"] = "Starting position to read from (required for 'read'). For 'lines' format: zero-based line number. For all other formats: byte offset.";
+    fileOpTool["inputSchema"]["properties"]["offset"]["description"] = "Starting position to read from (required for 'read'). For 'lines' format: zero-based line number, or a negative number to start that many lines before the end of the file (e.g. -200). For 'records' format: zero-based record number, or negative to count back from the last record. For all other formats: byte offset. For 'checksum': byte offset of the range (optional, default: 0).";
 
     // size parameter (for read)
     fileOpTool["inputSchema"]["properties"]["size"]["type"] = "number";
-    fileOpTool["inputSchema"]["properties"]["size"]["description"] = "Amount to read (required for 'read'). For 'lines' format: number of lines to read. For all other formats: number of bytes to read.";
+    fileOpTool["inputSchema"]["properties"]["size"]["description"] = "Amount to read (required for 'read'). For 'lines' format: number of lines to read. For 'records' format: maximum number of records to return. For all other formats: number of bytes to read. For 'checksum': bytes to hash (optional, default: to the end of the file).";
 
     // format parameter (for read, stream_read)
     fileOpTool["inputSchema"]["properties"]["format"]["type"] = "string";
@@ -62,9 +111,27 @@ Json::Value FileOpController::listTools() const {
     fileOpTool["inputSchema"]["properties"]["format"]["enum"].append("hex");
     fileOpTool["inputSchema"]["properties"]["format"]["enum"].append("text");
     fileOpTool["inputSchema"]["properties"]["format"]["enum"].append("lines");
-    fileOpTool["inputSchema"]["properties"]["format"]["description"] = "Output format (optional for 'read' and 'read_multiple', default: 'text'). When format is 'lines', offset/size parameters are interpreted as line numbers/counts instead of byte offsets/sizes.";
+    fileOpTool["inputSchema"]["properties"]["format"]["enum"].append("columns");
+    fileOpTool["inputSchema"]["properties"]["format"]["enum"].append("records");
+    fileOpTool["inputSchema"]["properties"]["format"]["description"] = "Output format (optional for 'read' and 'read_multiple', default: 'text'). When format is 'lines' or 'columns', offset/size parameters are interpreted as line numbers/counts instead of byte offsets/sizes. 'columns' returns only the fields listed in 'columns' of each line of delimited text. 'records' reads JSON Lines files by record number: every non-blank line is one record, and a '\\r' inside a line does not split it.";
     fileOpTool["inputSchema"]["properties"]["format"]["default"] = "text";
 
+    // columns format parameters (for read; read_multiple takes them per segment)
+    fileOpTool["inputSchema"]["properties"]["columns"]["type"] = "array";
+    fileOpTool["inputSchema"]["properties"]["columns"]["items"]["type"] = "number";
+    fileOpTool["inputSchema"]["properties"]["columns"]["description"] = "Zero-based column numbers to return, in output order (required for 'columns' format)";
+    fileOpTool["inputSchema"]["properties"]["delimiter"]["type"] = "string";
+    fileOpTool["inputSchema"]["properties"]["delimiter"]["description"] = "Field delimiter of 'columns' format and of 'seek' fields, one character (optional, default: ',' for 'columns', runs of spaces and tabs for 'seek')";
+    fileOpTool["inputSchema"]["properties"]["quote"]["type"] = "string";
+    fileOpTool["inputSchema"]["properties"]["quote"]["description"] = "Quote character of 'columns' format, or \"\" when fields are not quoted (optional, default: '\"')";
+
+    // records format parameters (for read; read_multiple takes them per segment)
+    fileOpTool["inputSchema"]["properties"]["fields"]["type"] = "array";
+    fileOpTool["inputSchema"]["properties"]["fields"]["items"]["type"] = "string";
+    fileOpTool["inputSchema"]["properties"]["fields"]["description"] = "Top-level fields to return of each record of 'records' format, in output order (optional, default: whole records)";
+    fileOpTool["inputSchema"]["properties"]["match"]["type"] = "object";
+    fileOpTool["inputSchema"]["properties"]["match"]["description"] = "Return only records whose top-level fields equal these values, e.g. {\"id\": 42} ('records' format, optional). Records are scanned from 'offset' until 'size' of them match.";
+
     // Deprecated: chunk_size was used for stream_read; not supported anymore.
     
     // segments parameter (for read_multiple) - array of { handler, format?, ranges: [{offset,size}] }
@@ -77,10 +144,17 @@ Json::Value FileOpController::listTools() const {
     fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["format"]["enum"].append("hex");
     fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["format"]["enum"].append("text");
     fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["format"]["enum"].append("lines");
+    fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["format"]["enum"].append("columns");
+    fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["format"]["enum"].append("records");
+    fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["columns"] = fileOpTool["inputSchema"]["properties"]["columns"];
+    fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["delimiter"] = fileOpTool["inputSchema"]["properties"]["delimiter"];
+    fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["quote"] = fileOpTool["inputSchema"]["properties"]["quote"];
+    fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["fields"] = fileOpTool["inputSchema"]["properties"]["fields"];
+    fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["match"] = fileOpTool["inputSchema"]["properties"]["match"];
     fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["ranges"]["type"] = "array";
     fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["ranges"]["items"]["type"] = "object";
     fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["ranges"]["items"]["properties"]["offset"]["type"] = "number";
-    fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["offset"]["description"] = "Starting position. For 'lines' format: zero-based line number. For other formats: byte offset.";
+    fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["offset"]["description"] = "Starting position. For 'lines' format: zero-based line number, or negative to count back from the end of the file. For other formats: byte offset.";
     fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["ranges"]["items"]["properties"]["size"]["type"] = "number";
     fileOpTool["inputSchema"]["properties"]["segments"]["items"]["properties"]["size"]["description"] = "Amount to read. For 'lines' format: number of lines. For other formats: number of bytes.";
 
@@ -93,17 +167,31 @@ Json::Value FileOpController::listTools() const {
     return result;
 }
 
+// One-line summary of a file profile, used by 'stats' and in resource descriptions
+static std::string describe_stats(const FileStats& stats) {
+    return std::to_string(stats.lines) + " lines, longest line " + std::to_string(stats.longest_line) + " bytes (line "
+        + std::to_string(stats.longest_line_number) + "), " + (stats.binary ? "binary" : "text") + ", "
+        + (stats.utf8_valid ? "valid UTF-8" : "invalid UTF-8 at byte " + std::to_string(stats.utf8_error_offset))
+        + ", newlines: " + stats.newlineStyle();
+}
+
 Json::Value FileOpController::listResources() {
     Json::Value resources(Json::arrayValue);
     auto handlers = registry_.listHandlers();
     for (const auto& handler : handlers) {
-        auto segment = registry_.getByHandler(handler);
-        if (segment) {
+        // Peeked, so listing neither maps evicted handlers again nor reorders eviction
+        size_t size = 0;
+        if (registry_.peekSize(handler, size)) {
             Json::Value resource;
             resource["uri"] = "file:///" + handler;
             resource["name"] = std::filesystem::path(handler).filename().string();
-            resource["description"] = "Memory-mapped file (" + std::to_string(segment->size()) + " bytes)";
+            resource["description"] = "Memory-mapped file (" + std::to_string(size) + " bytes)";
             resource["mimeType"] = "application/octet-stream";
+            // Profiles are only shown once 'stats' has computed them; listing never scans files
+            if (auto stats = registry_.cachedFileStats(handler)) {
+                resource["description"] = "Memory-mapped file (" + std::to_string(size) + " bytes, " + describe_stats(*stats) + ")";
+                if (!stats->binary) resource["mimeType"] = "text/plain";
+            }
             resources.append(resource);
         }
     }
@@ -112,37 +200,375 @@ Json::Value FileOpController::listResources() {
     return result;
 }
 
+// Error for a read of a segment whose file was truncated under it: what was read includes zeroed
+// pages and is discarded. The next lookup maps the file again.
+static std::string truncated_error(const std::string& handler) {
+    return std::string("File was truncated while being read: ") + handler;
+}
+
 Json::Value FileOpController::readResourceFromUri(const Json::Value& params) {
     Json::Value result;
     std::string uri = params["uri"].asString();
     std::string handler = uri.substr(8); // Skip file:/// prefix
-    auto segment = registry_.getByHandler(handler);
-    if (!segment) {
-        result["__error__"] = "Resource not found";
+    try {
+        // Maps an evicted handler again, which throws if its file is gone
+        auto segment = registry_.getByHandler(handler);
+        if (!segment) {
+            result["__error__"] = "Resource not found";
+            return result;
+        }
+        const char* data = static_cast<const char*>(segment->data());
+        size_t size = segment->size();
+        auto pinned = segment->pin(0, size);
+        result["contents"][0]["uri"] = uri;
+        result["contents"][0]["mimeType"] = "application/octet-stream";
+        result["contents"][0]["blob"] = encode_base64(data, size);
+        if (segment->truncated()) {
+            Json::Value failed;
+            failed["__error__"] = truncated_error(handler);
+            return failed;
+        }
         return result;
+    } catch (const std::exception& e) {
+        Json::Value failed;
+        failed["__error__"] = std::string("Error: ") + e.what();
+        return failed;
     }
-    const char* data = static_cast<const char*>(segment->data());
-    size_t size = segment->size();
-    result["contents"][0]["uri"] = uri;
-    result["contents"][0]["mimeType"] = "application/octet-stream";
-    result["contents"][0]["text"] = std::string(data, size);
-    return result;
 }
 
 // 'lines' helper now centralized in LineUtils.hpp
 #include "LineUtils.hpp"
 
-Json::Value FileOpController::callTool(const Json::Value& params, std::function<void(const Json::Value&)> progress) {
-    Json::Value result;
-    std::string toolName = params["name"].asString();
-    Json::Value arguments = params["arguments"];
-    // Compatibility: accept 'preload', 'read', 'close' as top-level tool names (stdio variant)
+// 'lines' ranges with a negative offset are end-relative: offset -N starts N lines before EOF
+static bool is_tail_offset(const Json::Value& offset) {
+    return offset.isInt64() && offset.asInt64() < 0;
+}
+
+// Number of lines an end-relative offset counts back from EOF (offset -N -> N)
+static size_t tail_line_count(const Json::Value& offset) {
+    return (size_t)(-(offset.asInt64() + 1)) + 1;
+}
+
+// Match limit of 'search' when max_matches is not given
+static constexpr uint64_t kDefaultMaxMatches = 1000;
+
+// Version of a file for cached checksums: its modification time in nanoseconds (0 if unknown)
+static uint64_t file_version(const std::string& path) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return 0;
+    }
+    return (uint64_t)st.st_mtim.tv_sec * 1000000000ull + (uint64_t)st.st_mtim.tv_nsec;
+}
+
+// read_multiple requests smaller than this are read on the calling thread
+static constexpr uint64_t kParallelReadMinBytes = 256 * 1024;
+
+// One range of a read_multiple request resolved to a byte span of its segment
+struct PlannedRead {
+    std::string handler;
+    std::shared_ptr<MemorySegment> segment;
+    std::string format;
+    size_t start_byte = 0;
+    size_t bytes_len = 0;
+    // Field selection of a 'columns' read
+    std::shared_ptr<const ColumnSpec> columns;
+    // Query and record index of a 'records' read, whose byte span covers the records it may read
+    std::shared_ptr<const RecordQuery> records;
+    std::shared_ptr<const RecordIndex> record_index;
+};
+
+// 'columns' and 'lines' ranges are both line ranges
+static bool is_line_format(const std::string& format) {
+    return format == "lines" || format == "columns";
+}
+
+// Field selection of a 'columns' segment: 'columns' is required, 'delimiter' defaults to ',' and
+// 'quote' to '"' ("" when fields are not quoted)
+static bool parse_column_spec(const Json::Value& s, ColumnSpec& spec, std::string& error) {
+    const Json::Value& columns = s["columns"];
+    if (!columns.isArray() || columns.empty()) {
+        error = "'columns' format needs a non-empty 'columns' array";
+        return false;
+    }
+    for (const auto& c : columns) {
+        if (!c.isUInt64()) {
+            error = "'columns' must hold zero-based column numbers";
+            return false;
+        }
+        spec.columns.push_back((size_t)c.asUInt64());
+    }
+    std::string delimiter = s.get("delimiter", ",").asString();
+    std::string quote = s.get("quote", "\"").asString();
+    if (delimiter.size() != 1 || quote.size() > 1 || delimiter == quote || delimiter == "\n" || delimiter == "\r") {
+        error = "'delimiter' must be one character other than a line terminator, and 'quote' one other character or \"\"";
+        return false;
+    }
+    spec.delimiter = delimiter[0];
+    spec.quote = quote.empty() ? -1 : (unsigned char)quote[0];
+    return true;
+}
+
+// Projection and filter of a 'records' segment: 'fields' is an array of top-level field names,
+// 'match' an object of top-level field values
+static bool parse_record_query(const Json::Value& s, RecordQuery& query, std::string& error) {
+    if (s.isMember("fields")) {
+        if (!s["fields"].isArray()) {
+            error = "'fields' must be an array of field names";
+            return false;
+        }
+        for (const auto& f : s["fields"]) {
+            if (!f.isString()) {
+                error = "'fields' must be an array of field names";
+                return false;
+            }
+            query.fields.push_back(f.asString());
+        }
+    }
+    if (s.isMember("match")) {
+        if (!s["match"].isObject()) {
+            error = "'match' must be an object of field values";
+            return false;
+        }
+        for (const auto& name : s["match"].getMemberNames()) {
+            query.match.emplace_back(name, s["match"][name]);
+        }
+    }
+    return true;
+}
+
+// Content item of a 'records' read: the records as JSON Lines and their record numbers
+static Json::Value read_records_item(const PlannedRead& read) {
+    std::string text;
+    std::vector<size_t> numbers;
+    MemorySegment& segment = *read.segment;
+    read_records(static_cast<const char*>(segment.data()), *read.record_index, *read.records, text, numbers,
+                 [&segment](size_t offset, size_t length) { return segment.pin(offset, length); });
+    Json::Value item;
+    item["type"] = "text";
+    item["format"] = "records";
+    item["text"] = std::move(text);
+    item["record_numbers"] = Json::Value(Json::arrayValue);
+    for (size_t n : numbers) {
+        item["record_numbers"].append((Json::Value::UInt64)n);
+    }
+    return item;
+}
+
+// Decompressed bytes first scanned to resolve a 'lines' range of a compressed segment; the window
+// doubles until the range is known to end inside it
+static constexpr size_t kLineScanWindow = 1024 * 1024;
+
+// compute_line_byte_range over a segment. Compressed segments are scanned in growing windows from
+// `from_byte`, so a read near a checkpoint only decompresses the blocks around it.
+static bool resolve_line_range(PlannedRead& read, size_t start_line, size_t max_lines, size_t from_line, size_t from_byte) {
+    MemorySegment& segment = *read.segment;
+    const char* data = static_cast<const char*>(segment.data());
+    size_t size = segment.size();
+    for (size_t window = kLineScanWindow;; window *= 2) {
+        size_t limit = (!segment.isCompressed() || size - from_byte <= window) ? size : from_byte + window;
+        auto pinned = segment.pin(from_byte, limit - from_byte);
+        bool found = compute_line_byte_range(data, limit, start_line, max_lines, read.start_byte, read.bytes_len, from_line, from_byte);
+        // A range reaching the end of the window may continue past it
+        if (limit == size || (found && read.start_byte + read.bytes_len < limit)) {
+            return found;
+        }
+    }
+}
+
+// compute_tail_line_byte_range over a segment, scanning compressed segments in growing windows
+// that end at EOF
+static void resolve_tail_line_range(PlannedRead& read, size_t lines_from_end, size_t max_lines) {
+    MemorySegment& segment = *read.segment;
+    const char* data = static_cast<const char*>(segment.data());
+    size_t size = segment.size();
+    for (size_t window = kLineScanWindow;; window *= 2) {
+        size_t base = (!segment.isCompressed() || size <= window) ? 0 : size - window;
+        auto pinned = segment.pin(base, size - base);
+        compute_tail_line_byte_range(data + base, size - base, lines_from_end, max_lines, read.start_byte, read.bytes_len);
+        // A range starting at the start of the window may start before it
+        if (base == 0 || read.start_byte > 0) {
+            read.start_byte += base;
+            return;
+        }
+    }
+}
+
+// Zero-based number of the line starting at `offset`, counted from the nearest line index
+// checkpoint. Compressed segments are counted in pinned windows, like 'lines' ranges.
+static size_t line_number_at(MemorySegment& segment, const LineIndex* index, size_t offset) {
+    const char* data = static_cast<const char*>(segment.data());
+    size_t size = segment.size();
+    size_t line = 0;
+    size_t from = 0;
+    if (index && index->byteSize() == size) {
+        index->nearestByte(offset, line, from);
+    }
+    for (size_t window = kLineScanWindow; from < offset;) {
+        size_t to = segment.isCompressed() ? std::min(offset, from + window) : offset;
+        // One byte past `to` tells whether a terminator ending there is a pair
+        auto pinned = segment.pin(from, std::min(size, to + 1) - from);
+        size_t line_start = from;
+        size_t lines = count_lines_before(data, size, from, to, line_start);
+        if (to == offset) {
+            return line + lines;
+        }
+        if (line_start == from) {
+            // One line fills the window
+            window *= 2;
+            continue;
+        }
+        line += lines;
+        from = line_start;
+    }
+    return line;
+}
+
+// Resolve every range of a read_multiple request, in request order. Start-relative 'lines' ranges
+// of a segment are resolved in ascending line order so each one continues the scan from the
+// previous range (or a closer line index checkpoint) instead of rescanning the prefix.
+static bool plan_reads(SegmentRegistry& registry, const Json::Value& segments, std::vector<PlannedRead>& plan, std::string& error) {
+    struct LineRange {
+        size_t plan_index;
+        size_t start_line;
+        size_t max_lines;
+        std::string handler;
+    };
+    struct LineCursor {
+        std::shared_ptr<const LineIndex> index;
+        std::vector<LineRange> ranges;
+    };
+    // One cursor per segment, in order of first appearance
+    std::vector<LineCursor> line_reads;
+    std::map<MemorySegment*, size_t> line_read_slots;
+
+    for (const auto& s : segments) {
+        std::string handler = s["handler"].asString();
+        std::string format = s.get("format", Json::Value("text")).asString();
+        auto segment = registry.getByHandler(handler);
+        if (!segment) {
+            error = std::string("Invalid handler: ") + handler;
+            return false;
+        }
+        std::shared_ptr<const ColumnSpec> columns;
+        if (format == "columns") {
+            auto spec = std::make_shared<ColumnSpec>();
+            if (!parse_column_spec(s, *spec, error)) {
+                error += ": " + handler;
+                return false;
+            }
+            columns = spec;
+        }
+        std::shared_ptr<const RecordQuery> records;
+        std::shared_ptr<const RecordIndex> record_index;
+        if (format == "records") {
+            auto query = std::make_shared<RecordQuery>();
+            if (!parse_record_query(s, *query, error)) {
+                error += ": " + handler;
+                return false;
+            }
+            records = query;
+            record_index = registry.recordIndex(handler);
+            if (!record_index) {
+                error = registry.resolveHandler(handler).empty() ? std::string("Invalid handler: ") + handler : truncated_error(handler);
+                return false;
+            }
+        }
+        for (const auto& r : s["ranges"]) {
+            PlannedRead read;
+            read.handler = handler;
+            read.segment = segment;
+            read.format = format;
+            read.columns = columns;
+            size_t size = r["size"].asUInt64();
+            if (format == "records") {
+                auto query = std::make_shared<RecordQuery>(*records);
+                size_t count = record_index->recordCount();
+                if (is_tail_offset(r["offset"])) {
+                    size_t back = tail_line_count(r["offset"]);
+                    query->first = back < count ? count - back : 0;
+                } else {
+                    query->first = r["offset"].asUInt64();
+                    if (query->first > count) {
+                        error = std::string("Read out of bounds for handler (records): ") + handler;
+                        return false;
+                    }
+                }
+                query->max_records = size;
+                read.records = query;
+                read.record_index = record_index;
+                record_query_span(*record_index, *query, read.start_byte, read.bytes_len);
+                read.bytes_len -= read.start_byte;
+            } else if (is_line_format(format)) {
+                if (is_tail_offset(r["offset"])) {
+                    // End-relative ranges scan backwards from EOF and never need the line index
+                    resolve_tail_line_range(read, tail_line_count(r["offset"]), size);
+                } else {
+                    auto slot = line_read_slots.emplace(segment.get(), line_reads.size());
+                    if (slot.second) {
+                        // Building an index would decompress a compressed segment as a whole
+                        line_reads.push_back({segment->isCompressed() ? registry.cachedLineIndex(handler) : registry.lineIndex(handler), {}});
+                    }
+                    auto& cursor = line_reads[slot.first->second];
+                    cursor.ranges.push_back({plan.size(), (size_t)r["offset"].asUInt64(), size, handler});
+                }
+            } else {
+                if (is_tail_offset(r["offset"])) {
+                    error = std::string("Negative offsets are only supported for 'lines', 'columns' and 'records' formats: ") + handler;
+                    return false;
+                }
+                size_t offset = r["offset"].asUInt64();
+                if (size > segment->size() || offset > segment->size() - size) {
+                    error = std::string("Read out of bounds for handler: ") + handler;
+                    return false;
+                }
+                read.start_byte = offset;
+                read.bytes_len = size;
+            }
+            plan.push_back(read);
+        }
+    }
+
+    for (auto& cursor : line_reads) {
+        std::stable_sort(cursor.ranges.begin(), cursor.ranges.end(), [](const LineRange& a, const LineRange& b) {
+            return a.start_line < b.start_line;
+        });
+        size_t cursor_line = 0;
+        size_t cursor_byte = 0;
+        for (const auto& lr : cursor.ranges) {
+            PlannedRead& read = plan[lr.plan_index];
+            size_t from_line = 0;
+            size_t from_byte = 0;
+            if (cursor.index && cursor.index->byteSize() == read.segment->size()) {
+                cursor.index->nearest(lr.start_line, from_line, from_byte);
+            }
+            if (cursor_line > from_line) {
+                from_line = cursor_line;
+                from_byte = cursor_byte;
+            }
+            if (!resolve_line_range(read, lr.start_line, lr.max_lines, from_line, from_byte)) {
+                error = std::string("Read out of bounds for handler (lines): ") + lr.handler;
+                return false;
+            }
+            cursor_line = lr.start_line;
+            cursor_byte = read.start_byte;
+        }
+    }
+    return true;
+}
+
+// Map the legacy tool names ('preload', 'read', 'close', 'read_multiple' called as tools, stdio
+// variant) onto the 'fileop' tool
+static void normalize_tool_call(const Json::Value& params, std::string& toolName, Json::Value& arguments) {
+    toolName = params["name"].asString();
+    arguments = params["arguments"];
     if (toolName != "fileop") {
         if (toolName == "preload") {
             Json::Value compat;
             compat["name"] = "fileop";
             compat["arguments"]["operation"] = "preload";
             compat["arguments"]["path"] = arguments.get("path", Json::Value());
+            compat["arguments"]["line_index"] = arguments.get("line_index", false);
             toolName = "fileop";
             arguments = compat["arguments"];
         } else if (toolName == "read") {
@@ -172,6 +598,37 @@ Json::Value FileOpController::callTool(const Json::Value& params, std::function<
             arguments = compat["arguments"];
         }
     }
+}
+
+// Normalize single-range read into read_multiple to keep a single implementation
+static void normalize_read(std::string& operation, Json::Value& arguments) {
+    if (operation != "read") return;
+    // extract read parameters and rebuild arguments to use read_multiple
+    std::string handler = arguments["handler"].asString();
+    // offset is copied as-is: it may be negative for end-relative 'lines' reads
+    Json::Value offset = arguments["offset"];
+    size_t size = arguments["size"].asUInt64();
+    std::string format = arguments.get("format", "text").asString();
+    Json::Value compat;
+    compat["arguments"]["segments"] = Json::Value(Json::arrayValue);
+    Json::Value seg;
+    seg["handler"] = handler;
+    seg["format"] = format;
+    seg["ranges"][0]["offset"] = offset;
+    seg["ranges"][0]["size"] = (Json::Value::UInt64)size;
+    for (const char* key : {"columns", "delimiter", "quote", "fields", "match"}) {
+        if (arguments.isMember(key)) seg[key] = arguments[key];
+    }
+    compat["arguments"]["segments"].append(seg);
+    arguments = compat["arguments"];
+    operation = "read_multiple";
+}
+
+Json::Value FileOpController::callTool(const Json::Value& params, std::function<void(const Json::Value&)> progress) {
+    Json::Value result;
+    std::string toolName;
+    Json::Value arguments;
+    normalize_tool_call(params, toolName, arguments);
     try {
         if (toolName != "fileop") {
             result["__error__"] = std::string("Unknown tool: ") + toolName;
@@ -179,32 +636,33 @@ Json::Value FileOpController::callTool(const Json::Value& params, std::function<
         }
 
         std::string operation = arguments["operation"].asString();
-        // Normalize single-range read into read_multiple to keep a single implementation
-        if (operation == "read") {
-            // extract read parameters and rebuild arguments to use read_multiple
-            std::string handler = arguments["handler"].asString();
-            size_t offset = arguments["offset"].asUInt64();
-            size_t size = arguments["size"].asUInt64();
-            std::string format = arguments.get("format", "text").asString();
-            Json::Value compat;
-            compat["arguments"]["segments"] = Json::Value(Json::arrayValue);
-            Json::Value seg;
-            seg["handler"] = handler;
-            seg["format"] = format;
-            seg["ranges"][0]["offset"] = (Json::Value::UInt64)offset;
-            seg["ranges"][0]["size"] = (Json::Value::UInt64)size;
-            compat["arguments"]["segments"].append(seg);
-            arguments = compat["arguments"];
-            operation = "read_multiple";
-        }
+        normalize_read(operation, arguments);
         if (operation == "preload") {
             std::string path = arguments["path"].asString();
-            auto segment = registry_.preload(path);
+            std::string handle;
+            auto segment = registry_.preload(path, &handle);
             if (segment) {
                 std::filesystem::path canonical_path = std::filesystem::canonical(path);
                 std::string handler = canonical_path.string();
                 result["content"][0]["type"] = "text";
-                result["content"][0]["text"] = "File preloaded successfully.\n\nHandler: " + handler + "\nSize: " + std::to_string(segment->size()) + " bytes" + "\nResource URI: file:///" + handler;
+                result["content"][0]["text"] = "File preloaded successfully.\n\nHandler: " + handler + "\nHandle: " + handle + "\nSize: " + std::to_string(segment->size()) + " bytes" + "\nResource URI: file:///" + handler;
+                if (segment->isCompressed()) {
+                    result["content"][0]["text"] = result["content"][0]["text"].asString() + "\nCompressed: " + segment->compression() + ", " + std::to_string(segment->fileSize()) + " bytes on disk, decompressed on demand";
+                }
+                if (arguments.get("line_index", false).asBool()) {
+                    auto index = registry_.lineIndex(handler);
+                    if (index) {
+                        std::ostringstream ss;
+                        ss << std::fixed << std::setprecision(2) << index->buildMillis();
+                        result["content"][0]["text"] = result["content"][0]["text"].asString() + "\nLines: " + std::to_string(index->lineCount()) + "\nLine index: built in " + ss.str() + " ms on " + std::to_string(index->buildThreads()) + " thread(s)";
+                    }
+                }
+                if (arguments.get("trigram_index", false).asBool()) {
+                    registry_.buildTrigramIndex(handler);
+                    result["content"][0]["text"] = result["content"][0]["text"].asString() + "\nTrigram index: building in the background";
+                }
+                result["handler"] = handler;
+                result["handle"] = handle;
                 result["resourceListChanged"] = true;
                 return result;
             } else {
@@ -219,101 +677,115 @@ Json::Value FileOpController::callTool(const Json::Value& params, std::function<
                 result["__error__"] = "segments must be an array";
                 return result;
             }
-            // Precompute total bytes for progress
+            // Resolve every range to a byte span once; the plan also gives the total for progress
+            std::vector<PlannedRead> plan;
+            std::string error;
+            if (!plan_reads(registry_, arguments["segments"], plan, error)) {
+                result["__error__"] = error;
+                return result;
+            }
             uint64_t total_bytes = 0;
-            for (const auto& s : arguments["segments"]) {
-                std::string handler = s["handler"].asString();
-                std::string format = s.get("format", Json::Value("text")).asString();
-                auto segment = registry_.getByHandler(handler);
-                if (!segment) {
-                    result["__error__"] = std::string("Invalid handler: ") + handler;
-                    return result;
-                }
-                const char* data = static_cast<const char*>(segment->data());
-                size_t seg_size = segment->size();
-                for (const auto& r : s["ranges"]) {
-                    if (format == "lines") {
-                        size_t start_byte = 0;
-                        size_t bytes_len = 0;
-                        size_t start_line = r["offset"].asUInt64();
-                        size_t max_lines = r["size"].asUInt64();
-                        if (!compute_line_byte_range(data, seg_size, start_line, max_lines, start_byte, bytes_len)) {
-                            result["__error__"] = std::string("Read out of bounds for handler (lines): ") + handler;
-                            return result;
-                        }
-                        total_bytes += (Json::UInt64)bytes_len;
-                    } else {
-                        total_bytes += (Json::UInt64)r["size"].asUInt64();
+            for (const auto& read : plan) {
+                total_bytes += read.bytes_len;
+            }
+            uint64_t bytes_so_far = 0;
+
+            // Execute in file order: per segment by ascending offset, so each mapping is touched in one
+            // forward pass. Overlapping spans of an encoded format are encoded once and sliced.
+            std::vector<size_t> order(plan.size());
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::stable_sort(order.begin(), order.end(), [&plan](size_t a, size_t b) {
+                const auto& x = plan[a];
+                const auto& y = plan[b];
+                if (x.segment != y.segment) return x.segment < y.segment;
+                if (x.start_byte != y.start_byte) return x.start_byte < y.start_byte;
+                return x.bytes_len > y.bytes_len;
+            });
+
+            // Group overlapping hex spans; every group is encoded independently
+            struct ReadGroup {
+                size_t first;
+                size_t last;
+                size_t span_begin;
+                size_t span_end;
+            };
+            std::vector<ReadGroup> groups;
+            for (size_t g = 0; g < order.size();) {
+                const PlannedRead& first = plan[order[g]];
+                size_t span_end = first.start_byte + first.bytes_len;
+                size_t h = g + 1;
+                if (first.format == "hex") {
+                    while (h < order.size()) {
+                        const PlannedRead& next = plan[order[h]];
+                        if (next.segment != first.segment || next.format != "hex" || next.start_byte >= span_end) break;
+                        span_end = std::max(span_end, next.start_byte + next.bytes_len);
+                        ++h;
                     }
                 }
+                groups.push_back({g, h, first.start_byte, span_end});
+                g = h;
             }
-            uint64_t bytes_so_far = 0;
 
-            // Build result contents conforming to MCP Tool Result Schema
-            Json::Value content_array(Json::arrayValue);
-            
-            for (const auto& s : arguments["segments"]) {
-                std::string handler = s["handler"].asString();
-                std::string format = s.get("format", Json::Value("text")).asString();
-                auto segment = registry_.getByHandler(handler);
-                if (!segment) {
-                    result["__error__"] = std::string("Invalid handler: ") + handler;
-                    return result;
+            std::vector<Json::Value> items(plan.size());
+            // Progress is reported under a lock so bytes_read stays monotonic across workers
+            std::mutex progress_mutex;
+            auto read_group = [&](const ReadGroup& group) {
+                const PlannedRead& first = plan[order[group.first]];
+                const char* base = static_cast<const char*>(first.segment->data());
+                // 'records' reads pin one index span at a time, since matching may scan to EOF
+                std::shared_ptr<const void> pinned;
+                if (first.format != "records") {
+                    pinned = first.segment->pin(group.span_begin, group.span_end - group.span_begin);
+                }
+                std::string encoded;
+                if (first.format == "hex") {
+                    encoded = encode_hex(base + group.span_begin, group.span_end - group.span_begin);
                 }
-                
-                for (const auto& r : s["ranges"]) {
-                    size_t offset = r["offset"].asUInt64();
-                    size_t size = r["size"].asUInt64();
+
+                for (size_t g = group.first; g < group.last; ++g) {
+                    const PlannedRead& read = plan[order[g]];
                     std::string content;
-                    size_t actual_bytes = 0;
-                    
-                    if (format == "lines") {
-                        size_t start_byte = 0;
-                        size_t bytes_len = 0;
-                        if (!compute_line_byte_range(static_cast<const char*>(segment->data()), segment->size(), offset, size, start_byte, bytes_len)) {
-                            result["__error__"] = std::string("Read out of bounds for handler: ") + handler;
-                            return result;
-                        }
-                        const char* data = static_cast<const char*>(segment->data()) + start_byte;
-                        if (bytes_len > 0) content = std::string(data, bytes_len);
-                        actual_bytes = bytes_len;
-                    } else {
-                        if (offset + size > segment->size()) {
-                            result["__error__"] = std::string("Read out of bounds for handler: ") + handler;
-                            return result;
-                        }
-                        const char* data = static_cast<const char*>(segment->data()) + offset;
-                        if (format == "hex") {
-                            std::stringstream ss;
-                            for (size_t i = 0; i < size; ++i) {
-                                ss << std::hex << std::setw(2) << std::setfill('0') << (unsigned int)(unsigned char)data[i];
-                            }
-                            content = ss.str();
-                            actual_bytes = size;
-                        } else {
-                            content = std::string(data, size);
-                            actual_bytes = size;
-                        }
+                    if (read.format == "hex") {
+                        content = encoded.substr((read.start_byte - group.span_begin) * 2, read.bytes_len * 2);
+                    } else if (read.format == "binary") {
+                        content = encode_base64(base + read.start_byte, read.bytes_len);
+                    } else if (read.format == "columns") {
+                        project_columns(base, read.start_byte, read.start_byte + read.bytes_len, *read.columns, content);
+                    } else if (read.bytes_len > 0) {
+                        content = std::string(base + read.start_byte, read.bytes_len);
                     }
-                    
+
                     // Create MCP-compliant content item
                     Json::Value content_item;
                     // For hex output, return it as text so it conforms with MCP tool schema
                     // (type: "text", text: "...").
-                    // Binary output handling remains as-is for now.
-                    if (format == "hex") {
+                    // Binary output is base64 in 'data', like MCP blob/image payloads, so the JSON
+                    // stays valid UTF-8.
+                    if (read.format == "hex") {
                         content_item["type"] = "text";
                         content_item["format"] = "hex";
-                    } else if (format == "binary") {
+                        content_item["text"] = std::move(content);
+                    } else if (read.format == "binary") {
                         content_item["type"] = "bytes";
                         content_item["format"] = "binary";
+                        content_item["encoding"] = "base64";
+                        content_item["data"] = std::move(content);
+                    } else if (read.format == "columns") {
+                        content_item["type"] = "text";
+                        content_item["format"] = "columns";
+                        content_item["text"] = std::move(content);
+                    } else if (read.format == "records") {
+                        content_item = read_records_item(read);
                     } else {
                         content_item["type"] = "text";
+                        content_item["text"] = std::move(content);
                     }
-                    content_item["text"] = content;
-                    content_array.append(content_item);
+                    // Advances whenever the file is remapped after a change on disk
+                    content_item["version"] = (Json::Value::Int64)read.segment->version();
+                    items[order[g]] = std::move(content_item);
 
-                    bytes_so_far += actual_bytes;
+                    std::lock_guard lock(progress_mutex);
+                    bytes_so_far += read.bytes_len;
                     if (progress) {
                         Json::Value p;
                         p["bytes_read"] = (Json::Value::UInt64)bytes_so_far;
@@ -322,11 +794,247 @@ Json::Value FileOpController::callTool(const Json::Value& params, std::function<
                         progress(p);
                     }
                 }
+            };
+
+            // Large requests fan out over the worker pool: `lanes` workers pull groups in file order
+            size_t lanes = readConcurrency_ == 0 ? taskflow_.numWorkers() : readConcurrency_;
+            lanes = std::min(lanes, groups.size());
+            if (lanes <= 1 || total_bytes < kParallelReadMinBytes) {
+                for (const auto& group : groups) {
+                    read_group(group);
+                }
+            } else {
+                std::atomic<size_t> next_group{0};
+                taskflow_.parallelFor(lanes, [&](size_t) {
+                    for (size_t gi = next_group++; gi < groups.size(); gi = next_group++) {
+                        read_group(groups[gi]);
+                    }
+                });
+            }
+
+            for (const auto& read : plan) {
+                if (read.segment->truncated()) {
+                    result["__error__"] = truncated_error(read.handler);
+                    return result;
+                }
+            }
+
+            // Build result contents conforming to MCP Tool Result Schema, in request order
+            Json::Value content_array(Json::arrayValue);
+            for (auto& item : items) {
+                content_array.append(std::move(item));
             }
             
             // Wrap in MCP Tool Result Schema format
             result["content"] = content_array;
             return result;
+        } else if (operation == "search") {
+            // Literal or regex search over one handler or a list of handlers; matches are reported in file order
+            std::string pattern = arguments["pattern"].asString();
+            if (pattern.empty()) {
+                result["__error__"] = "pattern must be a non-empty string";
+                return result;
+            }
+            std::vector<std::string> handlers;
+            if (arguments["handlers"].isArray()) {
+                for (const auto& h : arguments["handlers"]) {
+                    handlers.push_back(h.asString());
+                }
+            } else {
+                handlers.push_back(arguments["handler"].asString());
+            }
+            size_t max_matches = arguments.get("max_matches", (Json::Value::UInt64)kDefaultMaxMatches).asUInt64();
+            bool regex = arguments.get("regex", false).asBool();
+            size_t context = arguments.get("context", (Json::Value::UInt64)0).asUInt64();
+
+            Json::Value matches(Json::arrayValue);
+            std::string listing;
+            bool truncated = false;
+            for (const auto& handler : handlers) {
+                auto segment = registry_.getByHandler(handler);
+                if (!segment) {
+                    result["__error__"] = std::string("Invalid handler: ") + handler;
+                    return result;
+                }
+                const char* data = static_cast<const char*>(segment->data());
+                size_t size = segment->size();
+                auto pinned = segment->pin(0, size);
+                std::vector<SearchMatch> found;
+                if (regex) {
+                    std::string error;
+                    if (!find_regex(data, size, pattern, max_matches - matches.size(), &taskflow_, found, truncated, error)) {
+                        result["__error__"] = std::string("Invalid regex: ") + error;
+                        return result;
+                    }
+                } else {
+                    auto index = registry_.cachedLineIndex(handler);
+                    auto trigrams = registry_.trigramIndex(handler);
+                    find_literal_all(data, size, pattern, max_matches - matches.size(), index.get(), trigrams.get(), found, truncated);
+                }
+                for (const auto& m : found) {
+                    Json::Value match;
+                    match["handler"] = handler;
+                    match["offset"] = (Json::Value::UInt64)m.offset;
+                    match["length"] = (Json::Value::UInt64)m.length;
+                    match["line"] = (Json::Value::UInt64)m.line;
+                    match["column"] = (Json::Value::UInt64)(m.offset - m.line_start);
+                    if (context > 0) {
+                        // `context` lines before the match's first line through `context` lines after its last
+                        size_t before = 0;
+                        size_t context_start = find_tail_line_start(data, m.line_start, context, before);
+                        size_t last_line_start = m.line_start;
+                        count_lines_before(data, size, m.line_start, std::min(size, m.offset + (m.length > 0 ? m.length - 1 : 0)), last_line_start);
+                        size_t after = 0;
+                        size_t context_end = skip_lines(data, size, last_line_start, context + 1, after);
+                        match["context_line"] = (Json::Value::UInt64)(m.line - before);
+                        match["context"] = std::string(data + context_start, context_end - context_start);
+                    }
+                    matches.append(match);
+                    listing += "\n" + handler + ":" + std::to_string(m.line) + ":" + std::to_string(m.offset - m.line_start) + " (byte " + std::to_string(m.offset) + ")";
+                }
+                if (segment->truncated()) {
+                    Json::Value failed;
+                    failed["__error__"] = truncated_error(handler);
+                    return failed;
+                }
+                if (truncated) break;
+            }
+            result["content"][0]["type"] = "text";
+            result["content"][0]["text"] = std::to_string(matches.size()) + " match(es)" + (truncated ? " (stopped at max_matches)" : "") + ", shown as handler:line:column with zero-based line numbers" + listing;
+            result["matches"] = matches;
+            result["truncated"] = truncated;
+            return result;
+        } else if (operation == "seek") {
+            // First line at or after a key in a file sorted by it, found by bisecting the mapping
+            std::string handler = arguments["handler"].asString();
+            auto segment = registry_.getByHandler(handler);
+            if (!segment) {
+                result["__error__"] = std::string("Invalid handler: ") + handler;
+                return result;
+            }
+            SeekSpec spec;
+            spec.key = arguments["key"].asString();
+            std::string compare = arguments.get("compare", "text").asString();
+            if (compare == "number") {
+                spec.compare = SeekSpec::Compare::Number;
+            } else if (compare == "timestamp") {
+                spec.compare = SeekSpec::Compare::Timestamp;
+            } else if (compare != "text") {
+                result["__error__"] = "compare must be 'text', 'number' or 'timestamp'";
+                return result;
+            }
+            if (arguments.isMember("field")) {
+                if (!arguments["field"].isUInt()) {
+                    result["__error__"] = "field must be a zero-based field number";
+                    return result;
+                }
+                spec.field = (long)arguments["field"].asUInt();
+            }
+            std::string delimiter = arguments.get("delimiter", " ").asString();
+            if (delimiter.size() != 1 || delimiter == "\n" || delimiter == "\r") {
+                result["__error__"] = "delimiter must be one character other than a line terminator";
+                return result;
+            }
+            spec.delimiter = delimiter[0];
+
+            SeekResult found;
+            std::string error;
+            MemorySegment& mapped = *segment;
+            if (!seek_sorted(static_cast<const char*>(segment->data()), segment->size(), spec, found, error,
+                             [&mapped](size_t offset, size_t length) { return mapped.pin(offset, length); })) {
+                result["__error__"] = error;
+                return result;
+            }
+            size_t line = 0;
+            if (found.found) {
+                // Numbered from the line index 'lines' reads use; a compressed segment is never indexed here
+                auto index = segment->isCompressed() ? registry_.cachedLineIndex(handler) : registry_.lineIndex(handler);
+                line = line_number_at(*segment, index.get(), found.offset);
+            }
+            if (segment->truncated()) {
+                result["__error__"] = truncated_error(handler);
+                return result;
+            }
+            result["content"][0]["type"] = "text";
+            result["found"] = found.found;
+            result["offset"] = (Json::Value::UInt64)found.offset;
+            result["probes"] = (Json::Value::UInt64)found.probes;
+            if (found.found) {
+                result["line"] = (Json::Value::UInt64)line;
+                result["exact"] = found.exact;
+                result["content"][0]["text"] = "First line at or after the key: line " + std::to_string(line) + " (zero-based), byte " + std::to_string(found.offset)
+                    + (found.exact ? ", key matches" : ", key sorts after") + "; " + std::to_string(found.probes) + " line(s) compared";
+            } else {
+                result["content"][0]["text"] = "Every line sorts before the key; " + std::to_string(found.probes) + " line(s) compared";
+            }
+            return result;
+        } else if (operation == "checksum") {
+            // CRC32C of the whole segment or of [offset, offset + size), hashed straight from the mapping
+            std::string handler = arguments["handler"].asString();
+            auto segment = registry_.getByHandler(handler);
+            if (!segment) {
+                result["__error__"] = std::string("Invalid handler: ") + handler;
+                return result;
+            }
+            uint64_t offset = arguments.get("offset", (Json::Value::UInt64)0).asUInt64();
+            if (offset > segment->size()) {
+                result["__error__"] = std::string("Checksum out of bounds for handler: ") + handler;
+                return result;
+            }
+            uint64_t size = arguments.get("size", (Json::Value::UInt64)(segment->size() - offset)).asUInt64();
+            if (size > segment->size() - offset) {
+                result["__error__"] = std::string("Checksum out of bounds for handler: ") + handler;
+                return result;
+            }
+            uint64_t version = file_version(registry_.resolveHandler(handler));
+            uint32_t crc = 0;
+            bool cached = version != 0 && segment->cachedChecksum(version, offset, size, crc);
+            if (!cached) {
+                auto pinned = segment->pin(offset, size);
+                crc = crc32c_parallel(static_cast<const char*>(segment->data()) + offset, size, &taskflow_);
+                if (segment->truncated()) {
+                    result["__error__"] = truncated_error(handler);
+                    return result;
+                }
+                if (version != 0) segment->storeChecksum(version, offset, size, crc);
+            }
+            char hex[9];
+            std::snprintf(hex, sizeof(hex), "%08x", crc);
+            result["content"][0]["type"] = "text";
+            result["content"][0]["text"] = std::string("CRC32C: ") + hex + " (" + std::to_string(size) + " bytes at offset " + std::to_string(offset) + (cached ? ", cached" : "") + ")";
+            result["algorithm"] = "crc32c";
+            result["checksum"] = hex;
+            result["offset"] = (Json::Value::UInt64)offset;
+            result["size"] = (Json::Value::UInt64)size;
+            result["cached"] = cached;
+            return result;
+        } else if (operation == "stats") {
+            std::string handler = arguments["handler"].asString();
+            auto stats = registry_.fileStats(handler);
+            if (!stats) {
+                result["__error__"] = registry_.resolveHandler(handler).empty() ? std::string("Invalid handler: ") + handler : truncated_error(handler);
+                return result;
+            }
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(2) << stats->millis;
+            result["content"][0]["type"] = "text";
+            result["content"][0]["text"] = std::to_string(stats->bytes) + " bytes, " + describe_stats(*stats) + "\nProfiled in " + ss.str() + " ms on " + std::to_string(stats->threads) + " thread(s)";
+            Json::Value& out = result["stats"];
+            out["bytes"] = (Json::Value::UInt64)stats->bytes;
+            out["lines"] = (Json::Value::UInt64)stats->lines;
+            out["longest_line"] = (Json::Value::UInt64)stats->longest_line;
+            out["longest_line_number"] = (Json::Value::UInt64)stats->longest_line_number;
+            out["newline_style"] = stats->newlineStyle();
+            out["newlines"]["lf"] = (Json::Value::UInt64)stats->lf;
+            out["newlines"]["crlf"] = (Json::Value::UInt64)stats->crlf;
+            out["newlines"]["cr"] = (Json::Value::UInt64)stats->cr;
+            out["newlines"]["lfcr"] = (Json::Value::UInt64)stats->lfcr;
+            out["nul_bytes"] = (Json::Value::UInt64)stats->nul_bytes;
+            out["control_bytes"] = (Json::Value::UInt64)stats->control_bytes;
+            out["binary"] = stats->binary;
+            out["utf8_valid"] = stats->utf8_valid;
+            if (!stats->utf8_valid) out["utf8_error_offset"] = (Json::Value::UInt64)stats->utf8_error_offset;
+            return result;
         } else if (operation == "close") {
             std::string handler = arguments["handler"].asString();
             registry_.close(handler);
@@ -344,6 +1052,153 @@ Json::Value FileOpController::callTool(const Json::Value& params, std::function<
     }
 }
 
+std::shared_ptr<StreamingResponse> FileOpController::streamTool(const Json::Value& id, const Json::Value& params, std::function<void(const Json::Value&)> progress) {
+    auto response = std::make_shared<StreamingResponse>();
+    std::string toolName;
+    Json::Value arguments;
+    normalize_tool_call(params, toolName, arguments);
+    std::string operation = arguments["operation"].asString();
+    if (toolName != "fileop" || (operation != "read" && operation != "read_multiple")) {
+        return nullptr;
+    }
+    try {
+        normalize_read(operation, arguments);
+        if (!arguments.isMember("segments") || !arguments["segments"].isArray()) {
+            response->appendValue(createError(id, -32000, "segments must be an array"));
+            return response;
+        }
+        std::vector<PlannedRead> plan;
+        std::string error;
+        if (!plan_reads(registry_, arguments["segments"], plan, error)) {
+            response->appendValue(createError(id, -32000, error));
+            return response;
+        }
+
+        uint64_t total_bytes = 0;
+        for (const auto& read : plan) {
+            total_bytes += read.bytes_len;
+        }
+        size_t lanes = readConcurrency_ == 0 ? taskflow_.numWorkers() : readConcurrency_;
+        bool parallel = lanes > 1 && total_bytes >= kParallelReadMinBytes;
+
+        // Projected rows and records are much smaller than their ranges; they are built up front,
+        // fanned out over the worker pool like read_multiple, instead of streamed
+        std::vector<size_t> built;
+        for (size_t i = 0; i < plan.size(); ++i) {
+            if (plan[i].format == "columns" || plan[i].format == "records") built.push_back(i);
+        }
+        std::vector<std::string> projected(plan.size());
+        std::vector<Json::Value> items(plan.size());
+        auto build_item = [&](size_t i) {
+            const PlannedRead& read = plan[i];
+            if (read.format == "columns") {
+                auto pinned = read.segment->pin(read.start_byte, read.bytes_len);
+                project_columns(static_cast<const char*>(read.segment->data()), read.start_byte, read.start_byte + read.bytes_len, *read.columns, projected[i]);
+            } else {
+                items[i] = read_records_item(read);
+            }
+        };
+        if (parallel && built.size() > 1) {
+            std::atomic<size_t> next_item{0};
+            taskflow_.parallelFor(std::min(lanes, built.size()), [&](size_t) {
+                for (size_t bi = next_item++; bi < built.size(); bi = next_item++) {
+                    build_item(built[bi]);
+                }
+            });
+        } else {
+            for (size_t i : built) {
+                build_item(i);
+            }
+        }
+
+        // Same document as createResponse(id, callTool(...)) with the compact writer (keys sorted)
+        response->appendRaw("{\"id\":" + StreamingResponse::compact(id) + ",\"jsonrpc\":\"2.0\",\"result\":{\"content\":[");
+        for (size_t i = 0; i < plan.size(); ++i) {
+            const PlannedRead& read = plan[i];
+            // "version" sorts after every other key of an item
+            std::string version = ",\"version\":" + std::to_string(read.segment->version()) + "}";
+            if (i > 0) response->appendRaw(",");
+            if (read.format == "hex") {
+                response->appendRaw("{\"format\":\"hex\",\"text\":");
+                response->appendString(read.segment, read.start_byte, read.bytes_len, StreamingResponse::Encoding::Hex);
+                response->appendRaw(",\"type\":\"text\"" + version);
+            } else if (read.format == "binary") {
+                response->appendRaw("{\"data\":");
+                response->appendString(read.segment, read.start_byte, read.bytes_len, StreamingResponse::Encoding::Base64);
+                response->appendRaw(",\"encoding\":\"base64\",\"format\":\"binary\",\"type\":\"bytes\"" + version);
+            } else if (read.format == "columns") {
+                // Fields are copied verbatim, so they are escaped like streamed text (U+FFFD for invalid UTF-8)
+                response->appendRaw("{\"format\":\"columns\",\"text\":\"" + escape_json(projected[i].data(), projected[i].size()) + "\",\"type\":\"text\"" + version);
+            } else if (read.format == "records") {
+                const std::string& text = items[i]["text"].asString();
+                response->appendRaw("{\"format\":\"records\",\"record_numbers\":" + StreamingResponse::compact(items[i]["record_numbers"]) +
+                                    ",\"text\":\"" + escape_json(text.data(), text.size()) + "\",\"type\":\"text\"" + version);
+            } else {
+                response->appendRaw("{\"text\":");
+                response->appendString(read.segment, read.start_byte, read.bytes_len, StreamingResponse::Encoding::Text);
+                response->appendRaw(",\"type\":\"text\"" + version);
+            }
+        }
+        response->appendRaw("]}}");
+        // Columns and records were read above; streamed spans are checked as they are encoded
+        for (const auto& read : plan) {
+            if (read.segment->truncated()) {
+                auto failed = std::make_shared<StreamingResponse>();
+                failed->appendValue(createError(id, -32000, truncated_error(read.handler)));
+                return failed;
+            }
+        }
+        // Streamed spans are encoded ahead of the transport on the same pool
+        if (parallel) response->setParallel(taskflow_, lanes);
+
+        if (progress) {
+            response->setProgress([progress](uint64_t bytes_so_far, uint64_t total_bytes) {
+                Json::Value p;
+                p["bytes_read"] = (Json::Value::UInt64)bytes_so_far;
+                p["total_bytes"] = (Json::Value::UInt64)total_bytes;
+                p["progress"] = (double)bytes_so_far / (double)total_bytes;
+                progress(p);
+            });
+        }
+        return response;
+    } catch (const std::exception& e) {
+        auto failed = std::make_shared<StreamingResponse>();
+        failed->appendValue(createError(id, -32000, std::string("Error: ") + e.what()));
+        return failed;
+    }
+}
+
+std::shared_ptr<StreamingResponse> FileOpController::streamResource(const Json::Value& id, const Json::Value& params) {
+    auto response = std::make_shared<StreamingResponse>();
+    std::string uri = params["uri"].asString();
+    std::string handler = uri.substr(8); // Skip file:/// prefix
+    try {
+        // Maps an evicted handler again, which throws if its file is gone
+        auto segment = registry_.getByHandler(handler);
+        if (!segment) {
+            response->appendValue(createError(id, -32000, "Resource not found"));
+            return response;
+        }
+        size_t size = segment->size();
+        response->appendRaw("{\"id\":" + StreamingResponse::compact(id) + ",\"jsonrpc\":\"2.0\",\"result\":{\"contents\":[{\"blob\":");
+        response->appendString(std::move(segment), 0, size, StreamingResponse::Encoding::Base64);
+        response->appendRaw(",\"mimeType\":\"application/octet-stream\",\"uri\":" + StreamingResponse::compact(Json::Value(uri)) + "}]}}");
+        return response;
+    } catch (const std::exception& e) {
+        auto failed = std::make_shared<StreamingResponse>();
+        failed->appendValue(createError(id, -32000, std::string("Error: ") + e.what()));
+        return failed;
+    }
+}
+
 void FileOpController::setAllowedPaths(const std::vector<std::string>& paths) {
     registry_.setAllowedPaths(paths);
 }
+
+void FileOpController::setMemoryBudget(size_t maxBytes, size_t maxHandlers) {
+    registry_.setMemoryBudget(maxBytes, maxHandlers);
+}
+
+void FileOpController::setReadConcurrency(size_t concurrency) {
+    readConcurrency_ = concurrency;
+}
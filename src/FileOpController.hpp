@@ -1,8 +1,11 @@
 #pragma once
 #include <json/json.h>
 #include <functional>
+#include <memory>
 #include <string>
 #include "SegmentRegistry.hpp"
+#include "StreamingResponse.hpp"
+#include "TaskflowManager.hpp"
 
 class FileOpController {
 public:
@@ -20,9 +23,23 @@ public:
     // Returns a Json::Value suitable as the 'result' field for a JSON-RPC response.
     Json::Value callTool(const Json::Value& params, std::function<void(const Json::Value&)> progress = nullptr);
 
+    // Streaming counterparts for the transports: the complete JSON-RPC response (or error) for `id`,
+    // with file contents encoded straight from the mapping while the response is being written.
+    // streamTool returns nullptr for operations other than read/read_multiple (use callTool).
+    std::shared_ptr<StreamingResponse> streamTool(const Json::Value& id, const Json::Value& params, std::function<void(const Json::Value&)> progress = nullptr);
+    std::shared_ptr<StreamingResponse> streamResource(const Json::Value& id, const Json::Value& params);
+
     // Configure allowed paths
     void setAllowedPaths(const std::vector<std::string>& paths);
 
+    // Bytes of files and number of handlers kept mapped (0 = no limit); see SegmentRegistry::setMemoryBudget
+    void setMemoryBudget(size_t maxBytes, size_t maxHandlers);
+
+    // Maximum number of read_multiple ranges read concurrently (0 = one per worker thread, 1 = sequential)
+    void setReadConcurrency(size_t concurrency);
+
 private:
+    TaskflowManager taskflow_;
     SegmentRegistry registry_;
+    size_t readConcurrency_ = 0;
 };
@@ -0,0 +1,231 @@
+#include "FileStats.hpp"
+#include "CpuFeatures.hpp"
+#include "Encoding.hpp"
+#include "TaskflowManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Bytes profiled at a time, so UTF-8 validation and counting see the data while it is in cache
+constexpr size_t kStatsBlockSize = 64 * 1024;
+
+inline bool is_terminator(char c) {
+    return c == '\n' || c == '\r';
+}
+
+inline bool is_control(unsigned char c) {
+    return c != 0 && c < 0x20 && (c < '\b' || c > '\r') && c != 0x1b;
+}
+
+// Profile of one chunk. Lines are numbered relative to the chunk: the part before the first
+// terminator and the part after the last one are open ends joined with the neighbouring chunks.
+struct ChunkProfile {
+    size_t terminators = 0;
+    size_t lf = 0;
+    size_t crlf = 0;
+    size_t cr = 0;
+    size_t lfcr = 0;
+    size_t nul_bytes = 0;
+    size_t control_bytes = 0;
+    size_t head = 0;          // bytes before the first terminator (the whole chunk if there is none)
+    size_t tail = 0;          // bytes after the last terminator sequence
+    bool has_interior = false;
+    size_t longest = 0;       // longest line between the first and the last terminator
+    size_t longest_index = 0; // its number within the chunk (the head is line 0)
+    size_t utf8_error = SIZE_MAX;
+};
+
+class ChunkProfiler {
+public:
+    ChunkProfiler(const char* data, size_t begin, size_t end) : data(data), end(end), lineStart(begin), skipUntil(begin) {}
+
+    void terminator(size_t p) {
+        if (p < skipUntil) return; // second byte of a pair
+        char c = data[p];
+        size_t next = p + 1;
+        if (next < end && is_terminator(data[next]) && data[next] != c) {
+            ++(c == '\r' ? out.crlf : out.lfcr);
+            ++next;
+        } else {
+            ++(c == '\n' ? out.lf : out.cr);
+        }
+        size_t len = p - lineStart;
+        if (out.terminators == 0) {
+            out.head = len;
+        } else if (!out.has_interior || len > out.longest) {
+            out.has_interior = true;
+            out.longest = len;
+            out.longest_index = out.terminators;
+        }
+        ++out.terminators;
+        lineStart = next;
+        skipUntil = next;
+    }
+
+    void scalar(size_t from, size_t to) {
+        for (size_t i = from; i < to; ++i) {
+            unsigned char c = (unsigned char)data[i];
+            if (c == '\n' || c == '\r') terminator(i);
+            else if (c == 0) ++out.nul_bytes;
+            else if (is_control(c)) ++out.control_bytes;
+        }
+    }
+
+#ifdef MCP_FILEOP_X86_SIMD
+    __attribute__((target("avx2,popcnt")))
+    size_t avx2(size_t from, size_t to) {
+        const __m256i lf = _mm256_set1_epi8('\n');
+        const __m256i cr = _mm256_set1_epi8('\r');
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i control_max = _mm256_set1_epi8(0x1f);
+        const __m256i allowed_min = _mm256_set1_epi8('\b');
+        const __m256i allowed_span = _mm256_set1_epi8('\r' - '\b');
+        const __m256i escape = _mm256_set1_epi8(0x1b);
+        size_t i = from;
+        for (; i + 32 <= to; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            uint32_t terminators = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)));
+            __m256i low = _mm256_cmpeq_epi8(_mm256_max_epu8(v, control_max), control_max);
+            uint32_t low_mask = (uint32_t)_mm256_movemask_epi8(low);
+            if (low_mask == terminators) {
+                while (terminators) {
+                    terminator(i + (size_t)__builtin_ctz(terminators));
+                    terminators &= terminators - 1;
+                }
+                continue;
+            }
+            // Controls other than NUL, \b..\r and ESC
+            __m256i offset = _mm256_sub_epi8(v, allowed_min);
+            __m256i allowed = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, allowed_span), offset);
+            __m256i nul = _mm256_cmpeq_epi8(v, zero);
+            allowed = _mm256_or_si256(_mm256_or_si256(allowed, _mm256_cmpeq_epi8(v, escape)), nul);
+            out.nul_bytes += (size_t)__builtin_popcount((uint32_t)_mm256_movemask_epi8(nul));
+            out.control_bytes += (size_t)__builtin_popcount((uint32_t)_mm256_movemask_epi8(_mm256_andnot_si256(allowed, low)));
+            while (terminators) {
+                terminator(i + (size_t)__builtin_ctz(terminators));
+                terminators &= terminators - 1;
+            }
+        }
+        return i;
+    }
+#endif
+
+    ChunkProfile run(size_t begin) {
+        size_t utf8_pos = begin;
+        for (size_t pos = begin; pos < end;) {
+            size_t block_end = std::min(end, pos + kStatsBlockSize);
+            if (out.utf8_error == SIZE_MAX) {
+                size_t valid = utf8_pos + utf8_valid_prefix(data + utf8_pos, block_end - utf8_pos);
+                // A sequence cut off at the block end is checked again with the next block
+                if (valid == block_end || (block_end < end && block_end - valid < 4)) {
+                    utf8_pos = valid;
+                } else {
+                    out.utf8_error = valid;
+                }
+            }
+            size_t i = pos;
+#ifdef MCP_FILEOP_X86_SIMD
+            if (cpu::has_avx2()) i = avx2(pos, block_end);
+#endif
+            scalar(i, block_end);
+            pos = block_end;
+        }
+        if (out.terminators == 0) {
+            out.head = end - lineStart;
+        } else {
+            out.tail = end - lineStart;
+        }
+        return out;
+    }
+
+private:
+    const char* data;
+    size_t end;
+    size_t lineStart;
+    size_t skipUntil;
+    ChunkProfile out;
+};
+
+} // namespace
+
+std::string FileStats::newlineStyle() const {
+    int kinds = (lf > 0) + (crlf > 0) + (cr > 0) + (lfcr > 0);
+    if (kinds == 0) return "none";
+    if (kinds > 1) return "mixed";
+    if (lf) return "lf";
+    if (crlf) return "crlf";
+    if (cr) return "cr";
+    return "lfcr";
+}
+
+FileStats compute_file_stats(const char* data, size_t size, TaskflowManager* taskflow) {
+    auto started = std::chrono::steady_clock::now();
+    size_t chunks = 1;
+    if (taskflow && taskflow->numWorkers() > 1 && size >= 2 * kStatsChunkSize) {
+        chunks = size / kStatsChunkSize;
+    }
+    // Boundaries are moved forward until they follow no terminator (so no pair is split) and sit on
+    // no UTF-8 continuation byte (so no valid sequence is split)
+    std::vector<size_t> bounds(chunks + 1, size);
+    bounds[0] = 0;
+    for (size_t i = 1; i < chunks; ++i) {
+        size_t b = std::max(bounds[i - 1], size / chunks * i);
+        while (b < size && (is_terminator(data[b - 1]) || ((unsigned char)data[b] & 0xc0) == 0x80)) ++b;
+        bounds[i] = b;
+    }
+    std::vector<ChunkProfile> profiles(chunks);
+    auto profile = [&](size_t i) {
+        profiles[i] = ChunkProfiler(data, bounds[i], bounds[i + 1]).run(bounds[i]);
+    };
+    if (chunks > 1) {
+        taskflow->parallelFor(chunks, profile);
+    } else {
+        profile(0);
+    }
+
+    FileStats stats;
+    stats.bytes = size;
+    stats.threads = chunks > 1 ? std::min(chunks, taskflow->numWorkers()) : 1;
+    bool have_line = false;
+    auto candidate = [&](size_t len, size_t line) {
+        if (!have_line || len > stats.longest_line) {
+            have_line = true;
+            stats.longest_line = len;
+            stats.longest_line_number = line;
+        }
+    };
+    // Length of the line still open at the current chunk boundary, and its number
+    size_t open = 0;
+    size_t line = 0;
+    for (const auto& p : profiles) {
+        stats.lf += p.lf;
+        stats.crlf += p.crlf;
+        stats.cr += p.cr;
+        stats.lfcr += p.lfcr;
+        stats.nul_bytes += p.nul_bytes;
+        stats.control_bytes += p.control_bytes;
+        if (stats.utf8_valid && p.utf8_error != SIZE_MAX) {
+            stats.utf8_valid = false;
+            stats.utf8_error_offset = p.utf8_error;
+        }
+        if (p.terminators == 0) {
+            open += p.head;
+            continue;
+        }
+        candidate(open + p.head, line);
+        if (p.has_interior) candidate(p.longest, line + p.longest_index);
+        line += p.terminators;
+        open = p.tail;
+    }
+    stats.lines = line;
+    if (open > 0) {
+        candidate(open, line);
+        ++stats.lines;
+    }
+    stats.binary = stats.nul_bytes > 0 || stats.control_bytes * 100 > size;
+    stats.millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return stats;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+class TaskflowManager;
+
+// Profile of a mapped file, gathered in one pass so callers can decide how to read it
+struct FileStats {
+    size_t bytes = 0;
+    // Lines as 'lines' reads count them: a trailing line without terminator counts as a line
+    size_t lines = 0;
+    // Longest line in bytes (without its terminator) and its zero-based line number; the first wins
+    size_t longest_line = 0;
+    size_t longest_line_number = 0;
+    // Terminator sequences by kind
+    size_t lf = 0;
+    size_t crlf = 0;
+    size_t cr = 0;
+    size_t lfcr = 0;
+    size_t nul_bytes = 0;
+    // C0 control bytes other than NUL, \b, \t, \n, \v, \f, \r and ESC
+    size_t control_bytes = 0;
+    bool utf8_valid = true;
+    size_t utf8_error_offset = 0; // first invalid byte, when !utf8_valid
+    // Binary guess: any NUL byte, or control bytes making up more than 1% of the file
+    bool binary = false;
+    double millis = 0.0;
+    size_t threads = 1;
+
+    // "lf", "crlf", "cr", "lfcr", "mixed" or "none"
+    std::string newlineStyle() const;
+};
+
+// Files of at least two chunks are split at line boundaries that are also UTF-8 character
+// boundaries, and the chunks are profiled in parallel on `taskflow`
+constexpr size_t kStatsChunkSize = 8 * 1024 * 1024;
+FileStats compute_file_stats(const char* data, size_t size, TaskflowManager* taskflow = nullptr);
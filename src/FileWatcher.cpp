@@ -0,0 +1,174 @@
+#include "FileWatcher.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+// Events on directory entries that can change what a path maps to: writes and truncation, metadata
+// (mtime set by touch), and entries created, deleted or renamed in or out of the directory
+constexpr uint32_t kDirectoryEvents = IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+#endif
+
+void split_path(const std::string& path, std::string& directory, std::string& name) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        directory = ".";
+        name = path;
+        return;
+    }
+    directory = slash == 0 ? "/" : path.substr(0, slash);
+    name = path.substr(slash + 1);
+}
+
+std::string join_path(const std::string& directory, const std::string& name) {
+    return directory == "/" ? "/" + name : directory + "/" + name;
+}
+
+} // namespace
+
+FileWatcher::FileWatcher(std::function<void(const std::string&)> onChange)
+    : onChange(std::move(onChange)) {}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (thread.joinable()) {
+        char stop = 0;
+        while (::write(stopPipe[1], &stop, 1) < 0 && errno == EINTR) {
+        }
+        thread.join();
+    }
+    for (int fd : {inotifyFd, stopPipe[0], stopPipe[1]}) {
+        if (fd >= 0) ::close(fd);
+    }
+#endif
+}
+
+void FileWatcher::watch(const std::string& path) {
+#ifdef __linux__
+    std::string directory, name;
+    split_path(path, directory, name);
+    std::lock_guard lock(mutex);
+    if (failed) {
+        return;
+    }
+    if (inotifyFd < 0) {
+        inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd < 0 || ::pipe2(stopPipe, O_CLOEXEC) != 0) {
+            // Out of inotify instances: changes are picked up by the next preload only
+            failed = true;
+            return;
+        }
+        thread = std::thread([this] { run(); });
+    }
+    auto it = directories.find(directory);
+    if (it == directories.end()) {
+        int watch = ::inotify_add_watch(inotifyFd, directory.c_str(), kDirectoryEvents);
+        if (watch < 0) {
+            // Out of watches, or the directory is gone: this path is not reported
+            return;
+        }
+        it = directories.emplace(directory, Directory{watch, {}}).first;
+        directoryOfWatch[watch] = directory;
+    }
+    ++it->second.names[name];
+#else
+    (void)path;
+#endif
+}
+
+void FileWatcher::unwatch(const std::string& path) {
+#ifdef __linux__
+    std::string directory, name;
+    split_path(path, directory, name);
+    std::lock_guard lock(mutex);
+    auto it = directories.find(directory);
+    if (it == directories.end()) {
+        return;
+    }
+    auto watched = it->second.names.find(name);
+    if (watched == it->second.names.end() || --watched->second > 0) {
+        return;
+    }
+    it->second.names.erase(watched);
+    if (it->second.names.empty()) {
+        ::inotify_rm_watch(inotifyFd, it->second.watch);
+        directoryOfWatch.erase(it->second.watch);
+        directories.erase(it);
+    }
+#else
+    (void)path;
+#endif
+}
+
+bool FileWatcher::active() const {
+    std::lock_guard lock(mutex);
+    return inotifyFd >= 0 && !failed;
+}
+
+void FileWatcher::run() {
+#ifdef __linux__
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    std::vector<std::string> changed;
+    while (true) {
+        pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {stopPipe[0], POLLIN, 0}};
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[1].revents != 0) {
+            return;
+        }
+        ssize_t n = ::read(inotifyFd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            continue;
+        }
+        changed.clear();
+        {
+            std::lock_guard lock(mutex);
+            for (char* p = buffer; p < buffer + n;) {
+                const auto* event = reinterpret_cast<const struct inotify_event*>(p);
+                p += sizeof(struct inotify_event) + event->len;
+                if (event->mask & IN_Q_OVERFLOW) {
+                    // Events were dropped: any watched file may have changed
+                    for (const auto& [directory, entry] : directories) {
+                        for (const auto& [name, count] : entry.names) changed.push_back(join_path(directory, name));
+                    }
+                    continue;
+                }
+                auto dir = directoryOfWatch.find(event->wd);
+                if (dir == directoryOfWatch.end()) {
+                    continue;
+                }
+                auto entry = directories.find(dir->second);
+                if (event->mask & IN_IGNORED) {
+                    // The directory was removed or unmounted, so its files are gone too
+                    for (const auto& [name, count] : entry->second.names) changed.push_back(join_path(dir->second, name));
+                    directories.erase(entry);
+                    directoryOfWatch.erase(dir);
+                    continue;
+                }
+                if (event->len > 0) {
+                    // The name is padded with NULs
+                    std::string name(event->name);
+                    if (entry->second.names.count(name)) changed.push_back(join_path(dir->second, name));
+                }
+            }
+        }
+        // A burst of writes to one file arrives as many events
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        for (const auto& path : changed) {
+            onChange(path);
+        }
+    }
+#endif
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// Reports changes to watched files from a background thread, using inotify on Linux (elsewhere
+// nothing is reported). Watches are set on the parent directories, so a file that is modified,
+// truncated, replaced by a rename or deleted and created again is reported by its path.
+class FileWatcher {
+public:
+    // `onChange` runs on the watcher thread with the path of a watched file that may have changed.
+    // After an event queue overflow it runs for every watched path.
+    explicit FileWatcher(std::function<void(const std::string&)> onChange);
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Start or stop reporting `path` (canonical). The thread starts with the first watch. Watches
+    // are counted, so a path is reported until each watch has been matched by an unwatch. Both
+    // resolve the parent directory, which can block on a slow filesystem: call them unlocked.
+    void watch(const std::string& path);
+    void unwatch(const std::string& path);
+    // Whether changes are being reported: false off Linux or when inotify is unavailable
+    bool active() const;
+
+private:
+    struct Directory {
+        int watch = -1;
+        // Watched names and their watch counts
+        std::unordered_map<std::string, size_t> names;
+    };
+    void run();
+
+    std::function<void(const std::string&)> onChange;
+    int inotifyFd = -1;
+    // Written by the destructor to wake the thread
+    int stopPipe[2] = {-1, -1};
+    bool failed = false;
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Directory> directories;
+    std::unordered_map<int, std::string> directoryOfWatch;
+    std::thread thread;
+};
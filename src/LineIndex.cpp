@@ -0,0 +1,147 @@
+#include "LineIndex.hpp"
+#include "LineUtils.hpp"
+#include "TaskflowManager.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+inline bool is_terminator(char c) {
+    return c == '\n' || c == '\r';
+}
+
+// Number of terminator sequences in [begin, end). skip_lines also counts a trailing partial line,
+// which is only the case when the range does not end on a terminator.
+size_t count_terminators(const char* data, size_t begin, size_t end) {
+    size_t n = 0;
+    skip_lines(data, end, begin, SIZE_MAX, n);
+    if (n > 0 && !is_terminator(data[end - 1])) --n;
+    return n;
+}
+
+} // namespace
+
+std::shared_ptr<LineIndex> LineIndex::build(const char* data, size_t size, TaskflowManager* taskflow) {
+    auto started = std::chrono::steady_clock::now();
+    auto index = std::make_shared<LineIndex>();
+    index->bytes = size;
+    size_t chunks = 1;
+    if (taskflow && size >= 2 * kMinParallelChunk) {
+        chunks = std::min(size / kMinParallelChunk, taskflow->numWorkers() * 4);
+    }
+    if (chunks > 1 && taskflow->numWorkers() > 1) {
+        index->buildParallel(data, size, *taskflow, chunks);
+    } else {
+        index->buildSerial(data, size);
+    }
+    index->millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return index;
+}
+
+std::shared_ptr<LineIndex> LineIndex::extend(const LineIndex& previous, const char* data, size_t size) {
+    auto started = std::chrono::steady_clock::now();
+    auto index = std::make_shared<LineIndex>();
+    index->bytes = size;
+    index->checkpoints = previous.checkpoints;
+    // A checkpoint at the old EOF may sit between a '\r' and an appended '\n', so it is rescanned
+    while (index->checkpoints.size() > 1 && index->checkpoints.back() >= previous.bytes) {
+        index->checkpoints.pop_back();
+    }
+    index->lines = (index->checkpoints.size() - 1) * kStride;
+    index->scanFrom(data, size);
+    index->millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return index;
+}
+
+void LineIndex::buildSerial(const char* data, size_t size) {
+    checkpoints.push_back(0);
+    scanFrom(data, size);
+}
+
+void LineIndex::scanFrom(const char* data, size_t size) {
+    size_t pos = checkpoints.back();
+    while (pos < size) {
+        size_t skipped = 0;
+        pos = skip_lines(data, size, pos, kStride, skipped);
+        lines += skipped;
+        if (skipped < kStride) break;
+        checkpoints.push_back(pos);
+    }
+}
+
+void LineIndex::buildParallel(const char* data, size_t size, TaskflowManager& taskflow, size_t chunks) {
+    // Chunk boundaries are moved forward until the preceding byte is not a terminator, so no
+    // \r\n or \n\r pair (or alternating run deciding how pairs form) straddles two chunks.
+    std::vector<size_t> bounds(chunks + 1, size);
+    bounds[0] = 0;
+    for (size_t i = 1; i < chunks; ++i) {
+        size_t b = std::max(bounds[i - 1], size / chunks * i);
+        while (b < size && b > 0 && is_terminator(data[b - 1])) ++b;
+        bounds[i] = b;
+    }
+
+    // Pass 1: count terminators per chunk; a prefix sum gives the line number each chunk starts in
+    std::vector<size_t> counts(chunks, 0);
+    taskflow.parallelFor(chunks, [&](size_t i) {
+        if (bounds[i] < bounds[i + 1]) counts[i] = count_terminators(data, bounds[i], bounds[i + 1]);
+    });
+    std::vector<size_t> before(chunks, 0);
+    for (size_t i = 1; i < chunks; ++i) before[i] = before[i - 1] + counts[i - 1];
+
+    // Pass 2: each chunk records the start of every global kStride-th line beginning inside it
+    std::vector<std::vector<uint64_t>> local(chunks);
+    taskflow.parallelFor(chunks, [&](size_t i) {
+        size_t pos = bounds[i];
+        size_t end = bounds[i + 1];
+        size_t step = kStride - before[i] % kStride;
+        while (pos < end) {
+            size_t skipped = 0;
+            pos = skip_lines(data, end, pos, step, skipped);
+            if (skipped < step || !is_terminator(data[pos - 1])) break;
+            local[i].push_back(pos);
+            step = kStride;
+        }
+    });
+
+    checkpoints.push_back(0);
+    for (const auto& cps : local) {
+        checkpoints.insert(checkpoints.end(), cps.begin(), cps.end());
+    }
+    lines = before[chunks - 1] + counts[chunks - 1];
+    if (size > 0 && !is_terminator(data[size - 1])) {
+        ++lines;
+        // Match the serial build, which records EOF as the checkpoint when the partial last line completes a stride
+        if (lines % kStride == 0) checkpoints.push_back(size);
+    }
+    threads = std::min(chunks, taskflow.numWorkers());
+}
+
+size_t LineIndex::lineCount() const {
+    return lines;
+}
+
+size_t LineIndex::byteSize() const {
+    return bytes;
+}
+
+void LineIndex::nearest(size_t line, size_t& checkpointLine, size_t& checkpointByte) const {
+    size_t slot = line / kStride;
+    if (slot >= checkpoints.size()) slot = checkpoints.size() - 1;
+    checkpointLine = slot * kStride;
+    checkpointByte = checkpoints[slot];
+}
+
+void LineIndex::nearestByte(size_t byte, size_t& checkpointLine, size_t& checkpointByte) const {
+    // checkpoints[0] is byte 0, so the slot before the first checkpoint past `byte` always exists
+    size_t slot = (size_t)(std::upper_bound(checkpoints.begin(), checkpoints.end(), (uint64_t)byte) - checkpoints.begin()) - 1;
+    checkpointLine = slot * kStride;
+    checkpointByte = checkpoints[slot];
+}
+
+double LineIndex::buildMillis() const {
+    return millis;
+}
+
+size_t LineIndex::buildThreads() const {
+    return threads;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class TaskflowManager;
+
+// Sparse line-offset index for a mapped file: records the byte offset of every kStride-th line
+// so 'lines' reads can start scanning from the nearest checkpoint instead of byte 0.
+class LineIndex {
+public:
+    static constexpr size_t kStride = 4096;
+    // Files smaller than two chunks of this size are indexed on the calling thread
+    static constexpr size_t kMinParallelChunk = 8 * 1024 * 1024;
+
+    // Build the index; with a TaskflowManager large files are split into chunks counted in parallel
+    static std::shared_ptr<LineIndex> build(const char* data, size_t size, TaskflowManager* taskflow = nullptr);
+    // Index for a mapping that grew by appending to the one `previous` was built from: existing
+    // checkpoints are kept and only the data from the last safe checkpoint onwards is scanned
+    static std::shared_ptr<LineIndex> extend(const LineIndex& previous, const char* data, size_t size);
+
+    // Total number of lines (a trailing line without terminator counts as a line)
+    size_t lineCount() const;
+    // Size in bytes of the mapping this index was built from
+    size_t byteSize() const;
+    // Nearest checkpoint at or before `line`
+    void nearest(size_t line, size_t& checkpointLine, size_t& checkpointByte) const;
+    // Nearest checkpoint at or before byte offset `byte`
+    void nearestByte(size_t byte, size_t& checkpointLine, size_t& checkpointByte) const;
+
+    // Build statistics
+    double buildMillis() const;
+    size_t buildThreads() const;
+
+private:
+    void buildSerial(const char* data, size_t size);
+    // Continue a serial scan from the last checkpoint
+    void scanFrom(const char* data, size_t size);
+    void buildParallel(const char* data, size_t size, TaskflowManager& taskflow, size_t chunks);
+
+    std::vector<uint64_t> checkpoints;
+    size_t lines = 0;
+    size_t bytes = 0;
+    double millis = 0.0;
+    size_t threads = 1;
+};
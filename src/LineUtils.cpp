@@ -1,28 +1,175 @@
 #include "LineUtils.hpp"
+#include "CpuFeatures.hpp"
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 
-bool compute_line_byte_range(const char* data, size_t total_size, size_t start_line, size_t max_lines, size_t &start_byte, size_t &bytes_len) {
-	start_byte = 0;
-	bytes_len = 0;
-	size_t pos = 0;
-	size_t current_line = 0;
+namespace {
 
-	// Find the byte index for the start_line
-	while (pos < total_size && current_line < start_line) {
-		// advance to the end of current line (consume characters until newline)
-		while (pos < total_size && data[pos] != '\n' && data[pos] != '\r') ++pos;
-		// consume newline sequences (\r, \n, \r\n, \n\r)
-		if (pos < total_size && (data[pos] == '\n' || data[pos] == '\r')) {
-			char ch = data[pos++];
-			if ((ch == '\r' || ch == '\n') && pos < total_size && (data[pos] == '\n' || data[pos] == '\r') && data[pos] != ch) {
-				// handle mixed \r\n or \n\r
-				++pos;
+// Bitmasks of '\n' and '\r' bytes within a 64-byte block (bit i <=> byte i).
+struct TerminatorMasks {
+	uint64_t lf;
+	uint64_t cr;
+};
+
+using ScanKernel = TerminatorMasks (*)(const char* block);
+
+#ifndef MCP_FILEOP_X86_SIMD
+TerminatorMasks scan_block_scalar(const char* block) {
+	TerminatorMasks m{0, 0};
+	for (unsigned i = 0; i < 64; ++i) {
+		m.lf |= (uint64_t)(block[i] == '\n') << i;
+		m.cr |= (uint64_t)(block[i] == '\r') << i;
+	}
+	return m;
+}
+#else
+TerminatorMasks scan_block_sse2(const char* block) {
+	const __m128i lf = _mm_set1_epi8('\n');
+	const __m128i cr = _mm_set1_epi8('\r');
+	TerminatorMasks m{0, 0};
+	for (unsigned i = 0; i < 4; ++i) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+		m.lf |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, lf)) << (i * 16);
+		m.cr |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, cr)) << (i * 16);
+	}
+	return m;
+}
+
+__attribute__((target("avx2")))
+TerminatorMasks scan_block_avx2(const char* block) {
+	const __m256i lf = _mm256_set1_epi8('\n');
+	const __m256i cr = _mm256_set1_epi8('\r');
+	__m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+	__m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+	TerminatorMasks m;
+	m.lf = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, lf))
+	     | (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, lf)) << 32;
+	m.cr = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, cr))
+	     | (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, cr)) << 32;
+	return m;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+TerminatorMasks scan_block_avx512(const char* block) {
+	__m512i v = _mm512_loadu_si512(block);
+	TerminatorMasks m;
+	m.lf = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\n'));
+	m.cr = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\r'));
+	return m;
+}
+#endif
+
+ScanKernel select_kernel() {
+#ifdef MCP_FILEOP_X86_SIMD
+	if (cpu::has_avx512bw()) return scan_block_avx512;
+	if (cpu::has_avx2()) return scan_block_avx2;
+	return scan_block_sse2;
+#else
+	return scan_block_scalar;
+#endif
+}
+
+const ScanKernel kernel = select_kernel();
+
+inline bool is_terminator(char c) {
+	return c == '\n' || c == '\r';
+}
+
+// Position just after the last terminator byte before `end`, or 0 if there is none
+size_t after_last_terminator(const char* data, size_t end) {
+	while (end >= 64) {
+		TerminatorMasks m = kernel(data + end - 64);
+		uint64_t term = m.lf | m.cr;
+		if (term) {
+			return end - 64 + (size_t)(64 - __builtin_clzll(term));
+		}
+		end -= 64;
+	}
+	while (end > 0 && !is_terminator(data[end - 1])) --end;
+	return end;
+}
+
+} // namespace
+
+size_t skip_lines(const char* data, size_t total_size, size_t pos, size_t max_lines, size_t &lines_skipped) {
+	lines_skipped = 0;
+	// true while `pos` sits inside a line whose terminator has not been seen yet
+	bool mid_line = false;
+	alignas(64) char tail[64];
+
+	while (pos < total_size && lines_skipped < max_lines) {
+		size_t avail = total_size - pos;
+		size_t block_len = avail < 64 ? avail : 64;
+		TerminatorMasks m;
+		if (avail >= 64) {
+			m = kernel(data + pos);
+		} else {
+			// Pad the final partial block with zeros, which are never terminators
+			std::memset(tail, 0, sizeof(tail));
+			std::memcpy(tail, data + pos, avail);
+			m = kernel(tail);
+		}
+		uint64_t term = m.lf | m.cr;
+		if (term == 0) {
+			pos += block_len;
+			mid_line = true;
+			continue;
+		}
+
+		// Fast path: an LF-only block whose lines all fit in the remaining budget. A pair can only
+		// start in this block if its last byte is '\n' followed by '\r' in the next block.
+		size_t remaining = max_lines - lines_skipped;
+		if (m.cr == 0 && block_len == 64) {
+			size_t n = (size_t)__builtin_popcountll(m.lf);
+			bool pair_at_edge = (m.lf >> 63) && avail > 64 && data[pos + 64] == '\r';
+			if (n < remaining && !pair_at_edge) {
+				lines_skipped += n;
+				mid_line = (m.lf >> 63) == 0;
+				pos += 64;
+				continue;
+			}
+		}
+
+		// Walk the terminators of this block one by one, consuming \r\n and \n\r pairs
+		size_t line_end = pos;
+		while (term) {
+			size_t q = pos + (size_t)__builtin_ctzll(term);
+			char ch = data[q++];
+			if (q < total_size && is_terminator(data[q]) && data[q] != ch) ++q;
+			++lines_skipped;
+			line_end = q;
+			if (lines_skipped == max_lines) {
+				return q;
 			}
+			size_t consumed = q - pos;
+			term = consumed >= 64 ? 0 : term & (~0ULL << consumed);
 		}
-		++current_line;
+		if (line_end >= pos + block_len) {
+			pos = line_end;
+			mid_line = false;
+		} else {
+			pos += block_len;
+			mid_line = true;
+		}
+	}
+
+	// Data after the last terminator up to EOF forms one final line
+	if (mid_line && lines_skipped < max_lines) {
+		++lines_skipped;
 	}
+	return pos;
+}
 
-	if (current_line < start_line) {
+bool compute_line_byte_range(const char* data, size_t total_size, size_t start_line, size_t max_lines, size_t &start_byte, size_t &bytes_len, size_t from_line, size_t from_byte) {
+	start_byte = 0;
+	bytes_len = 0;
+
+	// Find the byte index for the start_line
+	size_t current_line = 0;
+	size_t pos = skip_lines(data, total_size, from_byte, start_line - from_line, current_line);
+	if (current_line < start_line - from_line) {
 		// start_line beyond EOF
 		return false;
 	}
@@ -36,25 +183,106 @@ bool compute_line_byte_range(const char* data, size_t total_size, size_t start_l
 
 	// Find end byte after reading max_lines
 	size_t lines_read = 0;
-	size_t end_pos = pos;
-	while (end_pos < total_size && lines_read < max_lines) {
-		while (end_pos < total_size && data[end_pos] != '\n' && data[end_pos] != '\r') ++end_pos;
-		if (end_pos < total_size && (data[end_pos] == '\n' || data[end_pos] == '\r')) {
-			char ch = data[end_pos++];
-			if ((ch == '\r' || ch == '\n') && end_pos < total_size && (data[end_pos] == '\n' || data[end_pos] == '\r') && data[end_pos] != ch) {
-				++end_pos;
+	size_t end_pos = skip_lines(data, total_size, pos, max_lines, lines_read);
+	bytes_len = (end_pos >= start_byte) ? end_pos - start_byte : 0;
+	return true;
+}
+
+size_t find_tail_line_start(const char* data, size_t total_size, size_t count, size_t &lines_found) {
+	lines_found = 0;
+	size_t pos = total_size;
+	// Start offsets of the terminator sequences of the run currently being walked backwards.
+	// How a run such as "\n\r\n" splits into sequences depends on where it starts, so each run
+	// is segmented forward once from its first byte.
+	std::vector<size_t> run_segments;
+	while (lines_found < count && pos > 0) {
+		size_t end = pos;
+		if (is_terminator(data[end - 1])) {
+			if (run_segments.empty()) {
+				size_t run_start = end - 1;
+				while (run_start > 0 && is_terminator(data[run_start - 1])) --run_start;
+				size_t q = run_start;
+				while (q < end) {
+					run_segments.push_back(q);
+					char ch = data[q++];
+					if (q < total_size && is_terminator(data[q]) && data[q] != ch) ++q;
+				}
+			}
+			end = run_segments.back();
+			run_segments.pop_back();
+			if (!run_segments.empty()) {
+				// Empty line: the previous byte terminates the line before it
+				pos = end;
+				++lines_found;
+				continue;
 			}
 		}
-		++lines_read;
+		pos = after_last_terminator(data, end);
+		++lines_found;
 	}
+	return pos;
+}
 
-	// If end_pos reached EOF but we consumed 0 lines because there were no newline characters
-	// and max_lines > 0, we still consider the remaining data as one line (inclusive)
-	if (lines_read == 0 && end_pos == total_size && start_byte < total_size) {
-		bytes_len = total_size - start_byte;
+bool compute_tail_line_byte_range(const char* data, size_t total_size, size_t lines_from_end, size_t max_lines, size_t &start_byte, size_t &bytes_len) {
+	size_t found = 0;
+	start_byte = find_tail_line_start(data, total_size, lines_from_end, found);
+	bytes_len = 0;
+	if (max_lines == 0) {
 		return true;
 	}
-
-	bytes_len = (end_pos >= start_byte) ? end_pos - start_byte : 0;
+	size_t lines_read = 0;
+	size_t end_pos = skip_lines(data, total_size, start_byte, max_lines, lines_read);
+	bytes_len = end_pos - start_byte;
 	return true;
 }
+
+size_t count_lines_before(const char* data, size_t total_size, size_t from, size_t to, size_t &line_start) {
+	size_t lines = 0;
+	size_t pos = from;
+	line_start = from;
+	alignas(64) char tail[64];
+
+	while (pos < to) {
+		size_t block_len = to - pos < 64 ? to - pos : 64;
+		TerminatorMasks m;
+		if (block_len == 64) {
+			m = kernel(data + pos);
+		} else {
+			// Only bytes before `to` are considered; zero padding is never a terminator
+			std::memset(tail, 0, sizeof(tail));
+			std::memcpy(tail, data + pos, block_len);
+			m = kernel(tail);
+		}
+		uint64_t term = m.lf | m.cr;
+		if (term == 0) {
+			pos += block_len;
+			continue;
+		}
+
+		// Fast path: LF-only block whose last '\n' does not start a pair with the next byte
+		size_t next = pos + block_len;
+		bool pair_at_edge = (m.lf >> (block_len - 1)) & 1 && next < total_size && data[next] == '\r';
+		if (m.cr == 0 && !pair_at_edge) {
+			lines += (size_t)__builtin_popcountll(m.lf);
+			line_start = pos + 64 - (size_t)__builtin_clzll(m.lf);
+			pos = next;
+			continue;
+		}
+
+		while (term) {
+			size_t q = pos + (size_t)__builtin_ctzll(term);
+			char ch = data[q++];
+			if (q < total_size && is_terminator(data[q]) && data[q] != ch) ++q;
+			if (q > to) {
+				// A pair straddling `to`: the line containing `to` has not ended yet
+				return lines;
+			}
+			++lines;
+			line_start = q;
+			size_t consumed = q - pos;
+			term = consumed >= 64 ? 0 : term & (~0ULL << consumed);
+		}
+		pos = line_start > next ? line_start : next;
+	}
+	return lines;
+}
@@ -2,4 +2,25 @@
 #include <cstddef>
 
 // Helper: compute byte range for 'lines' format. Returns false if start_line is beyond EOF.
-bool compute_line_byte_range(const char* data, size_t total_size, size_t start_line, size_t max_lines, size_t &start_byte, size_t &bytes_len);
+// Scanning starts at line `from_line` located at byte `from_byte` (e.g. a LineIndex checkpoint);
+// from_line must not be greater than start_line.
+bool compute_line_byte_range(const char* data, size_t total_size, size_t start_line, size_t max_lines, size_t &start_byte, size_t &bytes_len, size_t from_line = 0, size_t from_byte = 0);
+
+// Advance from `pos` (which must be at a line start) over at most `max_lines` lines and return the
+// byte position after the last consumed line. `lines_skipped` receives the number of lines consumed;
+// a trailing line without terminator counts as a line. Terminators are \n, \r, \r\n and \n\r.
+size_t skip_lines(const char* data, size_t total_size, size_t pos, size_t max_lines, size_t &lines_skipped);
+
+// Start byte of the `count`-th line counted back from EOF (count == 1 is the last line), found by
+// scanning backwards from the end so the cost is proportional to the tail, not the file size.
+// `lines_found` is smaller than `count` when the file has fewer lines; the result is then 0.
+size_t find_tail_line_start(const char* data, size_t total_size, size_t count, size_t &lines_found);
+
+// Helper: byte range for an end-relative 'lines' read starting `lines_from_end` lines before EOF.
+// Offsets reaching before the first line are clamped to line 0, like `tail -n`.
+bool compute_tail_line_byte_range(const char* data, size_t total_size, size_t lines_from_end, size_t max_lines, size_t &start_byte, size_t &bytes_len);
+
+// Zero-based line number of the byte at `to`, counting terminator sequences from `from` (a line start)
+// that end at or before `to`. `line_start` receives the start of that line, so ascending positions
+// can be numbered by continuing from (result, line_start).
+size_t count_lines_before(const char* data, size_t total_size, size_t from, size_t to, size_t &line_start);
@@ -1,22 +1,268 @@
 #include "MemorySegment.hpp"
+#include "Decompressor.hpp"
+#include <algorithm>
+#include <csignal>
+#include <cstdint>
 #include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
 
-MemorySegment::MemorySegment(const std::string& path)
+namespace {
+
+// Readers of a file truncated while mapped fault with SIGBUS on its pages past the new end. File
+// mappings register their address range here; a fault inside one marks that segment truncated and
+// maps a zero page so the read can finish, and the reader discards what it read. Any other SIGBUS
+// goes to the previous handler. The table is read by the handler, so it is only touched through
+// lock-free atomics. A slot is claimed through `truncated` and published by `begin`.
+struct GuardedRange {
+    std::atomic<uintptr_t> begin{0};
+    std::atomic<uintptr_t> end{0};
+    std::atomic<std::atomic<bool>*> truncated{nullptr};
+};
+// Above the kernel's default limit on mappings per process (vm.max_map_count)
+constexpr size_t kGuardedRanges = 65536;
+GuardedRange guarded_ranges[kGuardedRanges];
+// Slots at or past this were never claimed
+std::atomic<size_t> guarded_ranges_used{0};
+struct sigaction previous_sigbus;
+size_t page_size = 4096;
+
+void on_sigbus(int sig, siginfo_t* info, void* context) {
+    if (info->si_code == BUS_ADRERR && info->si_addr != nullptr) {
+        uintptr_t address = reinterpret_cast<uintptr_t>(info->si_addr);
+        size_t used = guarded_ranges_used.load(std::memory_order_acquire);
+        for (size_t i = 0; i < used; ++i) {
+            GuardedRange& range = guarded_ranges[i];
+            uintptr_t begin = range.begin.load(std::memory_order_acquire);
+            if (begin == 0 || address < begin || address >= range.end.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            std::atomic<bool>* truncated = range.truncated.load(std::memory_order_relaxed);
+            uintptr_t page = address & ~(uintptr_t)(page_size - 1);
+            if (truncated && ::mmap(reinterpret_cast<void*>(page), page_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED) {
+                truncated->store(true, std::memory_order_release);
+                return;
+            }
+            break;
+        }
+    }
+    if (previous_sigbus.sa_flags & SA_SIGINFO) {
+        previous_sigbus.sa_sigaction(sig, info, context);
+    } else if (previous_sigbus.sa_handler != SIG_DFL && previous_sigbus.sa_handler != SIG_IGN) {
+        previous_sigbus.sa_handler(sig);
+    } else {
+        // The fault repeats with the default action
+        ::signal(SIGBUS, SIG_DFL);
+    }
+}
+
+void install_truncation_guard() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        page_size = (size_t)::sysconf(_SC_PAGESIZE);
+        struct sigaction action {};
+        action.sa_sigaction = on_sigbus;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        ::sigaction(SIGBUS, &action, &previous_sigbus);
+    });
+}
+
+// Slot of the registered range, or -1 when the table is full (faults then reach the previous handler)
+long guard_range(const void* address, size_t size, std::atomic<bool>* truncated) {
+    install_truncation_guard();
+    for (size_t i = 0; i < kGuardedRanges; ++i) {
+        std::atomic<bool>* expected = nullptr;
+        if (!guarded_ranges[i].truncated.compare_exchange_strong(expected, truncated, std::memory_order_acq_rel)) {
+            continue;
+        }
+        size_t used = guarded_ranges_used.load(std::memory_order_relaxed);
+        while (used < i + 1 && !guarded_ranges_used.compare_exchange_weak(used, i + 1, std::memory_order_release)) {
+        }
+        uintptr_t begin = reinterpret_cast<uintptr_t>(address);
+        guarded_ranges[i].end.store(begin + size, std::memory_order_relaxed);
+        guarded_ranges[i].begin.store(begin, std::memory_order_release);
+        return (long)i;
+    }
+    return -1;
+}
+
+// Called before the range is unmapped, so a later mapping at the same address never matches it
+void unguard_range(long slot) {
+    if (slot < 0) {
+        return;
+    }
+    guarded_ranges[slot].begin.store(0, std::memory_order_release);
+    guarded_ranges[slot].end.store(0, std::memory_order_relaxed);
+    guarded_ranges[slot].truncated.store(nullptr, std::memory_order_release);
+}
+
+// mapped_region rejects empty files (a log between truncation and its next write); they map nothing
+boost::interprocess::mapped_region map_file(const boost::interprocess::file_mapping& mapping) {
+    struct stat st;
+    if (::fstat(mapping.get_mapping_handle().handle, &st) == 0 && st.st_size == 0) {
+        return boost::interprocess::mapped_region();
+    }
+    return boost::interprocess::mapped_region(mapping, boost::interprocess::read_only);
+}
+
+char empty_data = 0;
+
+} // namespace
+
+MemorySegment::MemorySegment(const std::string& path, int initialRefCount)
     : fileMapping(path.c_str(), boost::interprocess::read_only),
-      region(fileMapping, boost::interprocess::read_only),
-      refcount(1),
-      segmentSize(region.get_size()) {}
+      region(map_file(fileMapping)),
+      refcount(initialRefCount),
+      segmentSize(region.get_size()) {
+    if (region.get_size() > 0) {
+        guardSlot = guard_range(region.get_address(), region.get_size(), &truncatedFlag);
+    }
+    struct stat st;
+    if (::fstat(fileMapping.get_mapping_handle().handle, &st) == 0) {
+        device = (uint64_t)st.st_dev;
+        inode = (uint64_t)st.st_ino;
+        modified = (uint64_t)st.st_mtim.tv_sec * 1000000000ull + (uint64_t)st.st_mtim.tv_nsec;
+    }
+    try {
+        decompressor = Decompressor::open(static_cast<const char*>(region.get_address()), region.get_size());
+        if (decompressor) {
+            segmentSize = decompressor->size();
+            // Pages are only committed as blocks are decompressed into them
+            void* base = ::mmap(nullptr, std::max<size_t>(segmentSize, 1), PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (base == MAP_FAILED) {
+                throw std::runtime_error("Failed to reserve memory for decompressed data");
+            }
+            decompressed = static_cast<char*>(base);
+            blocks.resize(decompressor->blockCount());
+        }
+    } catch (...) {
+        unguard_range(guardSlot);
+        throw;
+    }
+}
 
-MemorySegment::~MemorySegment() {}
+MemorySegment::~MemorySegment() {
+    unguard_range(guardSlot);
+    if (decompressed) {
+        ::munmap(decompressed, std::max<size_t>(segmentSize, 1));
+    }
+}
 
 size_t MemorySegment::size() const {
     return segmentSize;
 }
 
 void* MemorySegment::data() {
-    return region.get_address();
+    if (decompressed) {
+        return decompressed;
+    }
+    return region.get_size() > 0 ? region.get_address() : &empty_data;
+}
+
+bool MemorySegment::isCompressed() const {
+    return decompressor != nullptr;
+}
+
+std::string MemorySegment::compression() const {
+    return decompressor ? decompressor->format() : "";
+}
+
+size_t MemorySegment::fileSize() const {
+    return region.get_size();
+}
+
+static std::atomic<size_t> decompressedCacheBytes{256 * 1024 * 1024};
+
+void MemorySegment::setDecompressedCacheLimit(size_t bytes) {
+    decompressedCacheBytes = bytes;
+}
+
+size_t MemorySegment::decompressedCacheLimit() {
+    return decompressedCacheBytes;
+}
+
+size_t MemorySegment::residentBytes() const {
+    std::lock_guard lock(blockMutex);
+    return resident;
+}
+
+std::shared_ptr<const void> MemorySegment::pin(size_t offset, size_t length) {
+    static const std::shared_ptr<const void> always = std::make_shared<char>(0);
+    if (!decompressor || length == 0 || offset >= segmentSize) {
+        return always;
+    }
+    length = std::min(length, segmentSize - offset);
+    size_t first = decompressor->blockAt(offset);
+    size_t last = decompressor->blockAt(offset + length - 1);
+    std::lock_guard lock(blockMutex);
+    ++useClock;
+    for (size_t b = first; b <= last; ++b) {
+        ++blocks[b].pins;
+        blocks[b].lastUse = useClock;
+    }
+    try {
+        for (size_t b = first; b <= last; ++b) {
+            if (!blocks[b].resident) {
+                decompressor->decompressBlock(b, decompressed + decompressor->blockOffset(b));
+                blocks[b].resident = true;
+                resident += decompressor->blockOffset(b + 1) - decompressor->blockOffset(b);
+            }
+        }
+    } catch (...) {
+        for (size_t b = first; b <= last; ++b) {
+            --blocks[b].pins;
+        }
+        throw;
+    }
+    trimBlocks();
+    return std::shared_ptr<const void>(decompressed + offset, [this, first, last](const void*) {
+        unpin(first, last);
+    });
+}
+
+void MemorySegment::unpin(size_t first, size_t last) {
+    std::lock_guard lock(blockMutex);
+    for (size_t b = first; b <= last; ++b) {
+        --blocks[b].pins;
+    }
+    trimBlocks();
+}
+
+void MemorySegment::trimBlocks() {
+    size_t limit = decompressedCacheBytes;
+    if (resident <= limit) {
+        return;
+    }
+    std::vector<size_t> candidates;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        if (blocks[b].resident && blocks[b].pins == 0) {
+            candidates.push_back(b);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](size_t a, size_t b) {
+        return blocks[a].lastUse < blocks[b].lastUse;
+    });
+    static const size_t page = (size_t)::sysconf(_SC_PAGESIZE);
+    for (size_t b : candidates) {
+        if (resident <= limit) {
+            break;
+        }
+        size_t begin = decompressor->blockOffset(b);
+        size_t end = decompressor->blockOffset(b + 1);
+        // Only pages the block covers entirely are released; edge pages are shared with neighbours
+        size_t page_begin = (begin + page - 1) / page * page;
+        size_t page_end = end / page * page;
+        if (page_end > page_begin) {
+            ::madvise(decompressed + page_begin, page_end - page_begin, MADV_DONTNEED);
+        }
+        blocks[b].resident = false;
+        resident -= end - begin;
+    }
 }
 
 void MemorySegment::incRef() {
@@ -30,3 +276,81 @@ void MemorySegment::decRef() {
 int MemorySegment::refCount() const {
     return refcount.load();
 }
+
+void MemorySegment::adoptRefCount(int count) {
+    refcount = count;
+}
+
+void MemorySegment::markUsed(uint64_t epoch) {
+    if (lastUse.load(std::memory_order_relaxed) < epoch) {
+        lastUse.store(epoch, std::memory_order_relaxed);
+    }
+}
+
+uint64_t MemorySegment::lastUsed() const {
+    return lastUse.load(std::memory_order_relaxed);
+}
+
+uint64_t MemorySegment::fileDevice() const {
+    return device;
+}
+
+uint64_t MemorySegment::fileInode() const {
+    return inode;
+}
+
+uint64_t MemorySegment::fileModified() const {
+    return modified;
+}
+
+void MemorySegment::setStale(bool value) {
+    stale.store(value, std::memory_order_relaxed);
+}
+
+bool MemorySegment::isStale() const {
+    return stale.load(std::memory_order_relaxed) || truncated();
+}
+
+bool MemorySegment::truncated() const {
+    return truncatedFlag.load(std::memory_order_acquire);
+}
+
+uint64_t MemorySegment::version() const {
+    return mappingVersion;
+}
+
+void MemorySegment::setVersion(uint64_t version) {
+    mappingVersion = version;
+}
+
+std::string MemorySegment::appendSample() const {
+    std::lock_guard lock(sampleMutex);
+    return sampledContent;
+}
+
+void MemorySegment::setAppendSample(std::string sample) {
+    std::lock_guard lock(sampleMutex);
+    sampledContent = std::move(sample);
+}
+
+bool MemorySegment::cachedChecksum(uint64_t version, uint64_t offset, uint64_t length, uint32_t& value) const {
+    std::lock_guard lock(checksumMutex);
+    if (version != checksumVersion) {
+        return false;
+    }
+    auto it = checksums.find({offset, length});
+    if (it == checksums.end()) {
+        return false;
+    }
+    value = it->second;
+    return true;
+}
+
+void MemorySegment::storeChecksum(uint64_t version, uint64_t offset, uint64_t length, uint32_t value) {
+    std::lock_guard lock(checksumMutex);
+    if (version != checksumVersion) {
+        checksums.clear();
+        checksumVersion = version;
+    }
+    checksums[{offset, length}] = value;
+}
@@ -1,23 +1,114 @@
 #pragma once
 #include <string>
 #include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 #include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
 
+class Decompressor;
+
 class MemorySegment {
 public:
-    MemorySegment(const std::string& path);
+    MemorySegment(const std::string& path, int initialRefCount = 1);
     ~MemorySegment();
 
+    // Compressed files (gzip, and zstd when built with it) map as their decompressed content:
+    // size() and data() describe the decompressed bytes, of which only pinned ranges are readable
     size_t size() const;
     void* data();
+    bool isCompressed() const;
+    // "gzip" or "zstd" for compressed segments, empty otherwise
+    std::string compression() const;
+    // Size of the mapped file on disk
+    size_t fileSize() const;
+    // Make [offset, offset + length) of data() readable until the returned token (which must not
+    // outlive the segment) is released,
+    // decompressing the blocks it covers. Plain files are always readable and pin for free.
+    std::shared_ptr<const void> pin(size_t offset, size_t length);
+    // Decompressed bytes a compressed segment keeps once they are no longer pinned; older blocks
+    // are dropped first
+    static void setDecompressedCacheLimit(size_t bytes);
+    static size_t decompressedCacheLimit();
+    // Decompressed bytes currently held, pinned or cached
+    size_t residentBytes() const;
     void incRef();
     void decRef();
     int refCount() const;
+    // Take over the reference count of the mapping this one replaces (or of an evicted one), so a
+    // remap keeps the handler's open count
+    void adoptRefCount(int count);
+    // Registry use epoch of the latest lookup, for eviction. Only written when it moved, so
+    // concurrent lookups between loads do not contend on it.
+    void markUsed(uint64_t epoch);
+    uint64_t lastUsed() const;
+
+    // Identity of the mapped file at map time, used to tell an append from a replacement
+    uint64_t fileDevice() const;
+    uint64_t fileInode() const;
+    // Modification time at map time, in nanoseconds since the epoch
+    uint64_t fileModified() const;
+
+    // Set when the file changed on disk after it was mapped, or when the registry evicted the
+    // mapping; the registry remaps (or restores) it on the next lookup
+    void setStale(bool stale);
+    // Also true once the segment is truncated()
+    bool isStale() const;
+    // Set when a read faulted past the end of the file after it was truncated. The faulting page
+    // reads as zeros, so whatever was read from the segment up to this check must be discarded.
+    bool truncated() const;
+    // Number of the mapping among the handler's mappings, starting at 1 and advanced whenever the
+    // file is remapped after a change. Set by the registry before the segment is published.
+    uint64_t version() const;
+    void setVersion(uint64_t version);
+
+    // Sampled content of the mapping, recorded by the registry when it indexes lines, to tell an
+    // append from a rewrite once the file grows. Empty until recorded.
+    std::string appendSample() const;
+    void setAppendSample(std::string sample);
+
+    // Checksums of byte ranges of this mapping. Entries belong to one file version (modification
+    // time): storing a value for a newer version drops the others.
+    bool cachedChecksum(uint64_t version, uint64_t offset, uint64_t length, uint32_t& value) const;
+    void storeChecksum(uint64_t version, uint64_t offset, uint64_t length, uint32_t value);
 
 private:
+    struct Block {
+        bool resident = false;
+        size_t pins = 0;
+        uint64_t lastUse = 0;
+    };
+    void unpin(size_t first, size_t last);
+    // Drop unpinned blocks, least recently used first, until the cache limit is met
+    void trimBlocks();
+
     boost::interprocess::file_mapping fileMapping;
     boost::interprocess::mapped_region region;
     std::atomic<int> refcount;
+    std::atomic<uint64_t> lastUse{0};
     size_t segmentSize;
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    uint64_t modified = 0;
+    std::atomic<bool> stale{false};
+    // Written by the SIGBUS handler through the registered range in guardSlot
+    std::atomic<bool> truncatedFlag{false};
+    long guardSlot = -1;
+    uint64_t mappingVersion = 1;
+    mutable std::mutex sampleMutex;
+    std::string sampledContent;
+    mutable std::mutex checksumMutex;
+    uint64_t checksumVersion = 0;
+    std::map<std::pair<uint64_t, uint64_t>, uint32_t> checksums;
+
+    std::unique_ptr<Decompressor> decompressor;
+    char* decompressed = nullptr; // reserved address space of the decompressed size
+    mutable std::mutex blockMutex;
+    std::vector<Block> blocks;
+    size_t resident = 0;
+    uint64_t useClock = 0;
 };
@@ -0,0 +1,167 @@
+#include "RecordIndex.hpp"
+#include "TaskflowManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kNone = SIZE_MAX;
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline size_t skip_space(const char* data, size_t pos, size_t end) {
+    while (pos < end && is_space(data[pos])) ++pos;
+    return pos;
+}
+
+// Position after the string whose opening quote is at `pos`
+size_t skip_string(const char* data, size_t pos, size_t end) {
+    for (++pos; pos < end; ++pos) {
+        if (data[pos] == '\\') ++pos;
+        else if (data[pos] == '"') return pos + 1;
+    }
+    return kNone;
+}
+
+} // namespace
+
+size_t skip_json_value(const char* data, size_t pos, size_t end) {
+    if (pos >= end) return kNone;
+    char c = data[pos];
+    if (c == '"') return skip_string(data, pos, end);
+    if (c == '{' || c == '[') {
+        size_t depth = 0;
+        while (pos < end) {
+            c = data[pos];
+            if (c == '"') {
+                pos = skip_string(data, pos, end);
+                if (pos == kNone) return kNone;
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if ((c == '}' || c == ']') && --depth == 0) {
+                return pos + 1;
+            }
+            ++pos;
+        }
+        return kNone;
+    }
+    size_t start = pos;
+    while (pos < end && !is_space(data[pos]) && data[pos] != ',' && data[pos] != '}' && data[pos] != ']') ++pos;
+    return pos > start ? pos : kNone;
+}
+
+
+namespace {
+
+// Records in [begin, end), which starts at a line start and ends after a '\n' or at EOF. With
+// `checkpoints`, the start of every record whose number (counted from `first_number`) is a
+// multiple of kStride is recorded.
+size_t scan_records(const char* data, size_t begin, size_t end, size_t first_number, std::vector<uint64_t>* checkpoints) {
+    size_t pos = begin;
+    size_t number = first_number;
+    size_t rb = 0, re = 0;
+    while (true) {
+        size_t before = pos;
+        if (!next_record(data, end, pos, rb, re)) break;
+        if (checkpoints && number % RecordIndex::kStride == 0) checkpoints->push_back(before);
+        ++number;
+    }
+    return number - first_number;
+}
+
+} // namespace
+
+bool next_record(const char* data, size_t size, size_t& pos, size_t& begin, size_t& end) {
+    while (pos < size) {
+        const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+        size_t line_end = newline ? (size_t)(newline - data) : size;
+        size_t next = newline ? line_end + 1 : size;
+        size_t first = skip_space(data, pos, line_end);
+        if (first == line_end) {
+            pos = next;
+            continue;
+        }
+        if (!newline) {
+            size_t value_end = skip_json_value(data, first, line_end);
+            if (value_end == kNone || skip_space(data, value_end, line_end) != line_end) {
+                pos = size;
+                return false;
+            }
+        }
+        begin = pos;
+        end = newline && line_end > pos && data[line_end - 1] == '\r' ? line_end - 1 : line_end;
+        pos = next;
+        return true;
+    }
+    return false;
+}
+
+std::shared_ptr<RecordIndex> RecordIndex::build(const char* data, size_t size, TaskflowManager* taskflow) {
+    auto started = std::chrono::steady_clock::now();
+    auto index = std::make_shared<RecordIndex>();
+    index->bytes = size;
+    size_t chunks = 1;
+    if (taskflow && taskflow->numWorkers() > 1 && size >= 2 * kMinParallelChunk) {
+        chunks = std::min(size / kMinParallelChunk, taskflow->numWorkers() * 4);
+    }
+    if (chunks == 1) {
+        index->records = scan_records(data, 0, size, 0, &index->checkpoints);
+    } else {
+        // Chunks end after a '\n', so only the last one can hold an unterminated record. Records
+        // are counted first; the second pass knows each chunk's first record number.
+        std::vector<size_t> bounds(chunks + 1, size);
+        bounds[0] = 0;
+        for (size_t i = 1; i < chunks; ++i) {
+            size_t from = std::max(bounds[i - 1], size / chunks * i);
+            const char* newline = from < size ? static_cast<const char*>(std::memchr(data + from, '\n', size - from)) : nullptr;
+            bounds[i] = newline ? (size_t)(newline - data) + 1 : size;
+        }
+        std::vector<size_t> counts(chunks + 1, 0);
+        taskflow->parallelFor(chunks, [&](size_t i) {
+            counts[i + 1] = scan_records(data, bounds[i], bounds[i + 1], 0, nullptr);
+        });
+        for (size_t i = 0; i < chunks; ++i) counts[i + 1] += counts[i];
+        std::vector<std::vector<uint64_t>> parts(chunks);
+        taskflow->parallelFor(chunks, [&](size_t i) {
+            scan_records(data, bounds[i], bounds[i + 1], counts[i], &parts[i]);
+        });
+        for (const auto& part : parts) {
+            index->checkpoints.insert(index->checkpoints.end(), part.begin(), part.end());
+        }
+        index->records = counts[chunks];
+        index->threads = std::min(chunks, taskflow->numWorkers());
+    }
+    if (index->checkpoints.empty()) index->checkpoints.push_back(0);
+    index->millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return index;
+}
+
+size_t RecordIndex::recordCount() const {
+    return records;
+}
+
+size_t RecordIndex::byteSize() const {
+    return bytes;
+}
+
+size_t RecordIndex::checkpointCount() const {
+    return checkpoints.size();
+}
+
+size_t RecordIndex::checkpointByte(size_t checkpoint) const {
+    return checkpoint < checkpoints.size() ? (size_t)checkpoints[checkpoint] : bytes;
+}
+
+double RecordIndex::buildMillis() const {
+    return millis;
+}
+
+size_t RecordIndex::buildThreads() const {
+    return threads;
+}
+
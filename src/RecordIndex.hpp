@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class TaskflowManager;
+
+// JSON Lines records are the non-blank lines of a file, ended by '\n' only: a '\r' before the
+// '\n' is dropped, a bare '\r' inside a line does not split it. A last line without '\n' is a
+// record once it holds a complete JSON value, since a writer may still be appending to it.
+//
+// Find the next record at or after `pos` (a line start) within [pos, size); returns false when
+// there is none. [begin, end) receives the record, `pos` the position after it.
+bool next_record(const char* data, size_t size, size_t& pos, size_t& begin, size_t& end);
+
+// Position after the JSON value starting at `pos`, or SIZE_MAX when it does not end before `end`.
+// Structure is only followed as far as needed to find the end (strings, brackets, scalar
+// extents); what is skipped is not validated.
+size_t skip_json_value(const char* data, size_t pos, size_t end);
+
+// Sparse record offset index: the byte offset of every kStride-th record
+class RecordIndex {
+public:
+    static constexpr size_t kStride = 1024;
+    // Files smaller than two chunks of this size are indexed on the calling thread
+    static constexpr size_t kMinParallelChunk = 8 * 1024 * 1024;
+
+    static std::shared_ptr<RecordIndex> build(const char* data, size_t size, TaskflowManager* taskflow = nullptr);
+
+    size_t recordCount() const;
+    // Size in bytes of the mapping this index was built from
+    size_t byteSize() const;
+    size_t checkpointCount() const;
+    // Line start at or before record `checkpoint * kStride` from which next_record reaches it;
+    // checkpointByte(checkpointCount()) is the end of the mapping
+    size_t checkpointByte(size_t checkpoint) const;
+
+    double buildMillis() const;
+    size_t buildThreads() const;
+
+private:
+    std::vector<uint64_t> checkpoints;
+    size_t records = 0;
+    size_t bytes = 0;
+    double millis = 0.0;
+    size_t threads = 1;
+};
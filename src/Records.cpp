@@ -0,0 +1,205 @@
+#include "Records.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+inline size_t skip_space(const char* data, size_t pos, size_t end) {
+    while (pos < end && (data[pos] == ' ' || data[pos] == '\t' || data[pos] == '\r' || data[pos] == '\n')) ++pos;
+    return pos;
+}
+
+// Call visit(key_begin, key_end, value_begin, value_end) for each member of the object in
+// [begin, end), keys without their quotes, until it returns false. Returns false when the record
+// is not an object.
+template<typename Visit>
+bool scan_object(const char* data, size_t begin, size_t end, Visit visit) {
+    size_t pos = skip_space(data, begin, end);
+    if (pos >= end || data[pos] != '{') return false;
+    pos = skip_space(data, pos + 1, end);
+    if (pos < end && data[pos] == '}') return true;
+    while (pos < end && data[pos] == '"') {
+        size_t key_end = skip_json_value(data, pos, end);
+        if (key_end == SIZE_MAX) return false;
+        size_t value = skip_space(data, key_end, end);
+        if (value >= end || data[value] != ':') return false;
+        value = skip_space(data, value + 1, end);
+        size_t value_end = skip_json_value(data, value, end);
+        if (value_end == SIZE_MAX) return false;
+        if (!visit(pos + 1, key_end - 1, value, value_end)) return true;
+        pos = skip_space(data, value_end, end);
+        if (pos >= end || data[pos] != ',') break;
+        pos = skip_space(data, pos + 1, end);
+    }
+    return true;
+}
+
+// Parses single values for 'match' comparisons and escaped keys
+class ValueParser {
+public:
+    ValueParser() : reader(Json::CharReaderBuilder().newCharReader()) {}
+
+    bool parse(const char* begin, const char* end, Json::Value& value) {
+        std::string errors;
+        return reader->parse(begin, end, &value, &errors);
+    }
+
+    bool keyEquals(const char* data, size_t begin, size_t end, const std::string& name) {
+        if (!std::memchr(data + begin, '\\', end - begin)) {
+            return end - begin == name.size() && std::memcmp(data + begin, name.data(), name.size()) == 0;
+        }
+        Json::Value key;
+        return parse(data + begin - 1, data + end + 1, key) && key.isString() && key.asString() == name;
+    }
+
+private:
+    std::unique_ptr<Json::CharReader> reader;
+};
+
+// Numbers compare by value, so 5 matches 5.0; everything else as jsoncpp compares it
+bool same_value(const Json::Value& a, const Json::Value& b) {
+    if (a.isNumeric() && b.isNumeric() && !a.isBool() && !b.isBool()) {
+        if (a.isIntegral() && b.isIntegral()) {
+            if (a.isInt64() && b.isInt64()) return a.asInt64() == b.asInt64();
+            return a.isUInt64() && b.isUInt64() && a.asUInt64() == b.asUInt64();
+        }
+        return a.asDouble() == b.asDouble();
+    }
+    return a == b;
+}
+
+// A 'match' value with the text it has in records when written plainly. Strings, integers,
+// booleans and null compare as raw bytes against that text first; other spellings of the same
+// value (escapes, 5.0, 5e0) and other kinds of values are parsed.
+struct MatchTerm {
+    const std::string* name;
+    const Json::Value* expected;
+    std::string literal;
+};
+
+std::vector<MatchTerm> match_terms(const RecordQuery& query) {
+    std::vector<MatchTerm> terms;
+    for (const auto& [name, expected] : query.match) {
+        MatchTerm term{&name, &expected, {}};
+        if (expected.isString()) {
+            term.literal = '"' + expected.asString() + '"';
+        } else if (expected.isBool()) {
+            term.literal = expected.asBool() ? "true" : "false";
+        } else if (expected.isNull()) {
+            term.literal = "null";
+        } else if (expected.isInt64()) {
+            term.literal = std::to_string(expected.asInt64());
+        } else if (expected.isUInt64()) {
+            term.literal = std::to_string(expected.asUInt64());
+        }
+        terms.push_back(std::move(term));
+    }
+    return terms;
+}
+
+// Whether raw value text that is not byte-equal to a term's literal may still equal its value
+bool may_equal(const MatchTerm& term, const char* value, size_t length) {
+    if (term.literal.empty()) return true;
+    if (term.expected->isString()) return value[0] == '"' && std::memchr(value, '\\', length);
+    if (!term.expected->isIntegral() || term.expected->isBool()) return false;
+    if (length >= 2 && value[0] == '-' && value[1] == '0') return true;
+    for (size_t i = 0; i < length; ++i) {
+        if (value[i] == '.' || value[i] == 'e' || value[i] == 'E') return true;
+    }
+    return false;
+}
+
+bool matches(const char* data, size_t begin, size_t end, const std::vector<MatchTerm>& terms, ValueParser& parser) {
+    for (const auto& term : terms) {
+        bool found = false;
+        bool equal = false;
+        scan_object(data, begin, end, [&](size_t kb, size_t ke, size_t vb, size_t ve) {
+            if (!parser.keyEquals(data, kb, ke, *term.name)) return true;
+            found = true;
+            size_t length = ve - vb;
+            if (!term.literal.empty() && length == term.literal.size() && std::memcmp(data + vb, term.literal.data(), length) == 0) {
+                equal = true;
+            } else if (may_equal(term, data + vb, length)) {
+                Json::Value value;
+                equal = parser.parse(data + vb, data + ve, value) && same_value(value, *term.expected);
+            }
+            return false;
+        });
+        if (!found || !equal) return false;
+    }
+    return true;
+}
+
+// The requested top-level fields in request order as a compact object; absent fields are left out
+void project(const char* data, size_t begin, size_t end, const std::vector<std::string>& fields, ValueParser& parser, std::string& out) {
+    struct Member {
+        size_t kb = 0, ke = 0, vb = 0, ve = 0;
+        bool found = false;
+    };
+    std::vector<Member> members(fields.size());
+    size_t remaining = fields.size();
+    scan_object(data, begin, end, [&](size_t kb, size_t ke, size_t vb, size_t ve) {
+        for (size_t f = 0; f < fields.size(); ++f) {
+            if (!members[f].found && parser.keyEquals(data, kb, ke, fields[f])) {
+                members[f] = {kb, ke, vb, ve, true};
+                --remaining;
+            }
+        }
+        return remaining > 0;
+    });
+    out += '{';
+    bool first = true;
+    for (const auto& m : members) {
+        if (!m.found) continue;
+        if (!first) out += ',';
+        first = false;
+        out += '"';
+        out.append(data + m.kb, m.ke - m.kb);
+        out += "\":";
+        out.append(data + m.vb, m.ve - m.vb);
+    }
+    out += '}';
+}
+
+} // namespace
+
+void record_query_span(const RecordIndex& index, const RecordQuery& query, size_t& begin, size_t& end) {
+    size_t first = query.first / RecordIndex::kStride;
+    begin = index.checkpointByte(first);
+    if (query.max_records == 0) {
+        end = begin;
+    } else if (!query.match.empty()) {
+        end = index.byteSize();
+    } else {
+        size_t last = (query.first + query.max_records - 1) / RecordIndex::kStride;
+        end = index.checkpointByte(std::min(last + 1, index.checkpointCount()));
+    }
+}
+
+void read_records(const char* data, const RecordIndex& index, const RecordQuery& query, std::string& out, std::vector<size_t>& numbers,
+                  const std::function<std::shared_ptr<const void>(size_t, size_t)>& pin) {
+    ValueParser parser;
+    std::vector<MatchTerm> terms = match_terms(query);
+    size_t found = 0;
+    // One checkpoint span at a time, so pinned spans stay small while matching scans far
+    for (size_t k = query.first / RecordIndex::kStride; k < index.checkpointCount() && found < query.max_records; ++k) {
+        size_t pos = index.checkpointByte(k);
+        size_t span_end = index.checkpointByte(k + 1);
+        auto pinned = pin ? pin(pos, span_end - pos) : nullptr;
+        size_t number = k * RecordIndex::kStride;
+        size_t begin = 0, end = 0;
+        while (found < query.max_records && next_record(data, span_end, pos, begin, end)) {
+            if (number >= query.first && (query.match.empty() || matches(data, begin, end, terms, parser))) {
+                if (query.fields.empty()) {
+                    out.append(data + begin, end - begin);
+                } else {
+                    project(data, begin, end, query.fields, parser, out);
+                }
+                out += '\n';
+                numbers.push_back(number);
+                ++found;
+            }
+            ++number;
+        }
+    }
+}
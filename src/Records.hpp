@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <json/json.h>
+#include "RecordIndex.hpp"
+
+// A 'records' read: up to `max_records` records from record `first`, optionally only those whose
+// top-level fields equal every `match` value, optionally projected to the top-level `fields`
+struct RecordQuery {
+    size_t first = 0;
+    size_t max_records = 0;
+    std::vector<std::string> fields;
+    std::vector<std::pair<std::string, Json::Value>> match;
+};
+
+// Run `query`, appending the records (or their projections) to `out` as JSON Lines and their
+// numbers to `numbers`. `pin(offset, length)`, when given, is called for every byte span before it
+// is read, and its token is held while the span is read.
+void read_records(const char* data, const RecordIndex& index, const RecordQuery& query, std::string& out, std::vector<size_t>& numbers,
+                  const std::function<std::shared_ptr<const void>(size_t, size_t)>& pin = nullptr);
+
+// Byte span [begin, end) holding the records `query` may read: the checkpoint spans around them,
+// or everything from the first one on when records are matched
+void record_query_span(const RecordIndex& index, const RecordQuery& query, size_t& begin, size_t& end);
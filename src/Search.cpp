@@ -0,0 +1,314 @@
+#include "Search.hpp"
+#include "CpuFeatures.hpp"
+#include "LineIndex.hpp"
+#include "LineUtils.hpp"
+#include "TaskflowManager.hpp"
+#include "TrigramIndex.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#ifdef MCP_FILEOP_HAVE_RE2
+#include <re2/re2.h>
+#else
+#include <regex>
+#endif
+
+namespace {
+
+// Confirm a candidate whose first and last byte are already known to match
+inline bool matches_inner(const char* candidate, const char* pattern, size_t pattern_len) {
+    return pattern_len <= 2 || std::memcmp(candidate + 1, pattern + 1, pattern_len - 2) == 0;
+}
+
+#ifdef MCP_FILEOP_X86_SIMD
+// Scan positions [pos, end) while whole blocks fit; returns the match or the first unscanned position
+size_t find_literal_sse2(const char* data, size_t pos, size_t end, const char* pattern, size_t pattern_len, bool& found) {
+    const __m128i first = _mm_set1_epi8(pattern[0]);
+    const __m128i last = _mm_set1_epi8(pattern[pattern_len - 1]);
+    for (; pos + 16 <= end; pos += 16) {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + pattern_len - 1));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        while (mask) {
+            size_t candidate = pos + (size_t)__builtin_ctz(mask);
+            if (matches_inner(data + candidate, pattern, pattern_len)) {
+                found = true;
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return pos;
+}
+
+__attribute__((target("avx2")))
+size_t find_literal_avx2(const char* data, size_t pos, size_t end, const char* pattern, size_t pattern_len, bool& found) {
+    const __m256i first = _mm256_set1_epi8(pattern[0]);
+    const __m256i last = _mm256_set1_epi8(pattern[pattern_len - 1]);
+    for (; pos + 32 <= end; pos += 32) {
+        __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + pattern_len - 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+        while (mask) {
+            size_t candidate = pos + (size_t)__builtin_ctz(mask);
+            if (matches_inner(data + candidate, pattern, pattern_len)) {
+                found = true;
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return pos;
+}
+#endif
+
+inline bool is_terminator(char c) {
+    return c == '\n' || c == '\r';
+}
+
+// Compiled pattern shared by the chunk tasks; matching is thread-safe for both engines
+class RegexEngine {
+public:
+    bool compile(const std::string& pattern, std::string& error) {
+#ifdef MCP_FILEOP_HAVE_RE2
+        RE2::Options options;
+        options.set_log_errors(false);
+        // POSIX syntax with Perl classes and \b, so that one_line(false) makes ^/$ match per line
+        options.set_posix_syntax(true);
+        options.set_perl_classes(true);
+        options.set_word_boundary(true);
+        options.set_one_line(false);
+        re = std::make_unique<RE2>(pattern, options);
+        if (!re->ok()) {
+            error = re->error();
+            return false;
+        }
+        return true;
+#else
+        try {
+            re = std::regex(pattern, std::regex::ECMAScript);
+            return true;
+        } catch (const std::regex_error& e) {
+            error = e.what();
+            return false;
+        }
+#endif
+    }
+
+    // Leftmost match starting in [from, limit), with the text ending at `end`
+    bool next(const char* data, size_t from, size_t limit, size_t end, size_t& match_start, size_t& match_len) const {
+#ifdef MCP_FILEOP_HAVE_RE2
+        re2::StringPiece text(data, end);
+        re2::StringPiece match;
+        // Bytes before `from` are context for ^ and \b
+        if (!re->Match(text, from, end, RE2::UNANCHORED, &match, 1)) return false;
+        match_start = (size_t)(match.data() - data);
+        match_len = match.size();
+        return match_start < limit;
+#else
+        // std::regex has no linear-time guarantee and no multi-line mode: match one line at a time
+        size_t pos = from;
+        bool at_line_start = from == 0 || is_terminator(data[from - 1]);
+        while (pos < limit) {
+            size_t line_end = pos;
+            while (line_end < end && !is_terminator(data[line_end])) ++line_end;
+            auto flags = std::regex_constants::match_default;
+            if (!at_line_start) flags |= std::regex_constants::match_prev_avail;
+            std::cmatch m;
+            if (std::regex_search(data + pos, data + line_end, m, re, flags)) {
+                match_start = pos + (size_t)m.position(0);
+                match_len = (size_t)m.length(0);
+                return match_start < limit;
+            }
+            if (line_end >= end) break;
+            // Continue after the terminator; \r\n and \n\r end a line together
+            pos = line_end + 1;
+            if (pos < end && is_terminator(data[pos]) && data[pos] != data[line_end]) ++pos;
+            at_line_start = true;
+        }
+        return false;
+#endif
+    }
+
+private:
+#ifdef MCP_FILEOP_HAVE_RE2
+    std::unique_ptr<RE2> re;
+#else
+    std::regex re;
+#endif
+};
+
+// Matches of one chunk, numbered relative to the chunk's first line
+struct ChunkMatches {
+    std::vector<SearchMatch> matches;
+    size_t lines = 0;       // lines in the chunk, valid when `complete`
+    bool complete = false;  // scanned to the end without hitting the match cap
+    bool scanned = false;   // false when skipped because earlier chunks already had enough matches
+};
+
+// Scan matches starting in [from, end) of the chunk beginning at line start `begin`; stops after
+// `cap` matches or when `abort` returns true
+template <typename Abort>
+void scan_chunk(const RegexEngine& engine, const char* data, size_t size, size_t begin, size_t from, size_t end, size_t cap, Abort abort, ChunkMatches& out) {
+    out = ChunkMatches();
+    // Matches starting in this chunk may extend into the next one, up to the end of a line
+    size_t scan_end = std::min(size, end + kRegexChunkOverlap);
+    while (scan_end < size && !is_terminator(data[scan_end - 1])) ++scan_end;
+
+    size_t line = 0;
+    size_t line_start = begin;
+    size_t pos = from;
+    size_t match_start = 0;
+    size_t match_len = 0;
+    while (pos < end && engine.next(data, pos, end, scan_end, match_start, match_len)) {
+        if (abort()) return;
+        line += count_lines_before(data, size, line_start, match_start, line_start);
+        out.matches.push_back({match_start, match_len, line, line_start});
+        if (out.matches.size() == cap) {
+            out.scanned = true;
+            return;
+        }
+        // Empty matches advance by one byte so the scan always makes progress
+        pos = match_start + std::max<size_t>(match_len, 1);
+    }
+    out.lines = line + count_lines_before(data, size, line_start, end, line_start);
+    out.complete = true;
+    out.scanned = true;
+}
+
+} // namespace
+
+size_t find_literal(const char* data, size_t size, size_t from, const char* pattern, size_t pattern_len) {
+    if (pattern_len == 0 || pattern_len > size || from > size - pattern_len) return size;
+    // Candidate start positions are [from, end)
+    size_t end = size - pattern_len + 1;
+    size_t pos = from;
+#ifdef MCP_FILEOP_X86_SIMD
+    bool found = false;
+    pos = cpu::has_avx2() ? find_literal_avx2(data, pos, end, pattern, pattern_len, found)
+                          : find_literal_sse2(data, pos, end, pattern, pattern_len, found);
+    if (found) return pos;
+#endif
+    for (; pos < end; ++pos) {
+        if (data[pos] == pattern[0] && data[pos + pattern_len - 1] == pattern[pattern_len - 1] && matches_inner(data + pos, pattern, pattern_len)) {
+            return pos;
+        }
+    }
+    return size;
+}
+
+void find_literal_all(const char* data, size_t size, const std::string& pattern, size_t max_matches, const LineIndex* lines, const TrigramIndex* trigrams, std::vector<SearchMatch>& matches, bool& truncated) {
+    matches.clear();
+    truncated = false;
+    // A match can only start in a candidate block; without a trigram index the file is one block
+    std::vector<uint32_t> blocks;
+    if (!trigrams || !trigrams->candidateBlocks(pattern.data(), pattern.size(), blocks)) {
+        trigrams = nullptr;
+        blocks.assign(1, 0);
+    }
+    size_t line = 0;
+    size_t line_start = 0;
+    size_t next = 0;
+    for (uint32_t block : blocks) {
+        size_t begin = trigrams ? (size_t)block * TrigramIndex::kBlockSize : 0;
+        size_t limit = trigrams ? std::min(size, begin + TrigramIndex::kBlockSize + pattern.size() - 1) : size;
+        for (size_t pos = find_literal(data, limit, std::max(begin, next), pattern.data(), pattern.size()); pos < limit;
+             pos = find_literal(data, limit, pos + pattern.size(), pattern.data(), pattern.size())) {
+            if (matches.size() == max_matches) {
+                truncated = true;
+                return;
+            }
+            size_t checkpoint_line = 0;
+            size_t checkpoint_byte = 0;
+            if (lines) {
+                lines->nearestByte(pos, checkpoint_line, checkpoint_byte);
+            } else if (trigrams) {
+                trigrams->blockLine(block, checkpoint_line, checkpoint_byte);
+            }
+            if (checkpoint_byte > line_start) {
+                line = checkpoint_line;
+                line_start = checkpoint_byte;
+            }
+            line += count_lines_before(data, size, line_start, pos, line_start);
+            matches.push_back({pos, pattern.size(), line, line_start});
+            next = pos + pattern.size();
+        }
+    }
+}
+
+bool find_regex(const char* data, size_t size, const std::string& pattern, size_t max_matches, TaskflowManager* taskflow, std::vector<SearchMatch>& matches, bool& truncated, std::string& error) {
+    matches.clear();
+    truncated = false;
+    RegexEngine engine;
+    if (!engine.compile(pattern, error)) {
+        return false;
+    }
+
+    // Chunk boundaries are line starts: the first byte after the terminator run following the split
+    size_t chunks = 1;
+    if (taskflow && taskflow->numWorkers() > 1 && size >= 2 * kRegexChunkSize) {
+        chunks = size / kRegexChunkSize;
+    }
+    std::vector<size_t> bounds(chunks + 1, size);
+    bounds[0] = 0;
+    for (size_t i = 1; i < chunks; ++i) {
+        size_t b = std::max(bounds[i - 1], size / chunks * i);
+        while (b < size && !is_terminator(data[b])) ++b;
+        while (b < size && is_terminator(data[b])) ++b;
+        bounds[i] = b;
+    }
+
+    // One match more than requested tells whether the result is truncated
+    const size_t cap = max_matches + 1;
+    std::vector<ChunkMatches> results(chunks);
+    // Chunks after `cutoff` are skipped: the chunks up to it already hold `cap` matches
+    std::atomic<size_t> cutoff{chunks};
+    std::mutex finished_mutex;
+    std::vector<char> finished(chunks, 0);
+    size_t contiguous = 0;
+    size_t prefix_matches = 0;
+    auto run_chunk = [&](size_t i) {
+        auto skip = [&cutoff, i]() { return i > cutoff.load(std::memory_order_relaxed); };
+        scan_chunk(engine, data, size, bounds[i], bounds[i], bounds[i + 1], cap, skip, results[i]);
+        std::lock_guard lock(finished_mutex);
+        finished[i] = 1;
+        while (contiguous < chunks && finished[contiguous] && cutoff.load() == chunks) {
+            prefix_matches += results[contiguous].matches.size();
+            if (prefix_matches >= cap) cutoff.store(contiguous);
+            ++contiguous;
+        }
+    };
+    if (chunks > 1) {
+        taskflow->parallelFor(chunks, run_chunk);
+    } else {
+        run_chunk(0);
+    }
+
+    // Merge in file order. A chunk is rescanned from where a serial scan would continue when the
+    // previous chunk's last match ran into it, or when it was skipped but is still needed.
+    size_t base_line = 0;
+    size_t next_pos = 0;
+    for (size_t i = 0; i < chunks && matches.size() < cap; ++i) {
+        ChunkMatches& chunk = results[i];
+        if (!chunk.scanned || (!chunk.matches.empty() && chunk.matches.front().offset < next_pos)) {
+            auto never = []() { return false; };
+            scan_chunk(engine, data, size, bounds[i], std::max(bounds[i], next_pos), bounds[i + 1], cap - matches.size(), never, chunk);
+        }
+        for (auto match : chunk.matches) {
+            match.line += base_line;
+            matches.push_back(match);
+            next_pos = match.offset + std::max<size_t>(match.length, 1);
+            if (matches.size() == cap) break;
+        }
+        // Incomplete chunks hit the cap, which ends the merge
+        base_line += chunk.lines;
+    }
+    if (matches.size() > max_matches) {
+        truncated = true;
+        matches.resize(max_matches);
+    }
+    return true;
+}
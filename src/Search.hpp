@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Offset of the first occurrence of `pattern` (pattern_len >= 1) starting at or after `from`, or
+// `size` if there is none. Candidates are positions whose first and last byte match the pattern's,
+// tested 32 (AVX2) or 16 (SSE2) positions at a time; each candidate is confirmed with memcmp.
+size_t find_literal(const char* data, size_t size, size_t from, const char* pattern, size_t pattern_len);
+
+class TaskflowManager;
+class LineIndex;
+class TrigramIndex;
+
+// A match and the zero-based line it starts on, in the numbering used by 'lines' reads
+struct SearchMatch {
+    size_t offset = 0;
+    size_t length = 0;
+    size_t line = 0;
+    size_t line_start = 0; // byte offset of that line
+};
+
+// Regex search with a linear-time engine (RE2; line-by-line std::regex when built without it).
+// `^`/`$` match at line boundaries ('\n' with RE2) and '.' does not match '\n'. Files larger than a chunk
+// are split at line starts and the chunks are searched in parallel on `taskflow`; each chunk may
+// read kRegexChunkOverlap bytes past its end so matches crossing a boundary are found. Results are
+// the same non-overlapping leftmost matches a serial scan returns, in file order. At most
+// `max_matches` are returned; `truncated` tells whether there were more. Returns false with
+// `error` set when the pattern does not compile.
+constexpr size_t kRegexChunkSize = 4 * 1024 * 1024;
+constexpr size_t kRegexChunkOverlap = 64 * 1024;
+bool find_regex(const char* data, size_t size, const std::string& pattern, size_t max_matches, TaskflowManager* taskflow, std::vector<SearchMatch>& matches, bool& truncated, std::string& error);
+
+// Non-overlapping occurrences of a literal in file order, at most `max_matches`. Line numbers
+// continue from the previous match or from the nearest checkpoint of `lines` or `trigrams`; with
+// `trigrams` only its candidate blocks are scanned. Either index may be null.
+void find_literal_all(const char* data, size_t size, const std::string& pattern, size_t max_matches, const LineIndex* lines, const TrigramIndex* trigrams, std::vector<SearchMatch>& matches, bool& truncated);
@@ -0,0 +1,297 @@
+#include "Seek.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Bytes pinned at a time while looking for a line end
+constexpr size_t kProbeWindow = 64 * 1024;
+// Bisection stops once the bounds are closer than this; the lines between them are compared in order
+constexpr size_t kLinearScanBytes = 4096;
+// compare_line result for a line without a usable key
+constexpr int kNotComparable = 2;
+
+inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool is_terminator(char c) {
+    return c == '\n' || c == '\r';
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date (Howard Hinnant's days_from_civil)
+int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+// Up to `max` digits at p, at least `min`
+bool scan_digits(const char*& p, const char* end, size_t min, size_t max, long& value) {
+    size_t n = 0;
+    value = 0;
+    while (p < end && n < max && is_digit(*p)) {
+        value = value * 10 + (*p++ - '0');
+        ++n;
+    }
+    return n >= min;
+}
+
+// Decimal number at p (sign, digits, fraction, exponent); end of it, or nullptr
+const char* scan_number(const char* p, const char* end, double& value) {
+    char buffer[64];
+    size_t n = std::min<size_t>(end - p, sizeof(buffer) - 1);
+    // strtod would also take "nan", "inf" and hex; keys are plain decimals
+    if (n == 0 || !(is_digit(p[0]) || ((p[0] == '-' || p[0] == '+' || p[0] == '.') && n > 1 && (is_digit(p[1]) || p[1] == '.')))) {
+        return nullptr;
+    }
+    std::memcpy(buffer, p, n);
+    buffer[n] = '\0';
+    char* parsed = nullptr;
+    value = std::strtod(buffer, &parsed);
+    return parsed == buffer ? nullptr : p + (parsed - buffer);
+}
+
+// Time of day after a date: HH:MM[:SS[.fraction]][Z|+HH[:]MM|-HH[:]MM], in seconds from midnight UTC
+const char* scan_time(const char* p, const char* end, double& seconds) {
+    long hours = 0, minutes = 0, secs = 0;
+    if (!scan_digits(p, end, 1, 2, hours) || p >= end || *p != ':' || !scan_digits(++p, end, 2, 2, minutes)) {
+        return nullptr;
+    }
+    double fraction = 0.0;
+    if (p < end && *p == ':') {
+        if (!scan_digits(++p, end, 2, 2, secs)) return nullptr;
+        if (p < end && (*p == '.' || *p == ',') && p + 1 < end && is_digit(p[1])) {
+            double scale = 0.1;
+            for (++p; p < end && is_digit(*p); ++p, scale /= 10) fraction += (*p - '0') * scale;
+        }
+    }
+    seconds = hours * 3600.0 + minutes * 60.0 + secs + fraction;
+    if (p < end && (*p == 'Z' || *p == 'z')) {
+        ++p;
+    } else if (p < end && (*p == '+' || *p == '-')) {
+        const char* zone = p;
+        long zone_hours = 0, zone_minutes = 0;
+        if (scan_digits(++p, end, 2, 2, zone_hours)) {
+            if (p < end && *p == ':') ++p;
+            scan_digits(p, end, 2, 2, zone_minutes);
+            seconds -= (*zone == '-' ? -1 : 1) * (zone_hours * 3600.0 + zone_minutes * 60.0);
+        } else {
+            p = zone;
+        }
+    }
+    return p;
+}
+
+// Timestamp at p as parse_timestamp describes it; end of it, or nullptr
+const char* scan_timestamp(const char* p, const char* end, double& seconds) {
+    while (p < end && (*p == '[' || *p == '"' || *p == '\'')) ++p;
+    if (end - p >= 5 && is_digit(p[0]) && is_digit(p[1]) && is_digit(p[2]) && is_digit(p[3]) && (p[4] == '-' || p[4] == '/')) {
+        long year = 0, month = 0, day = 0;
+        scan_digits(p, end, 4, 4, year);
+        char separator = *p++;
+        if (!scan_digits(p, end, 1, 2, month) || p >= end || *p != separator || !scan_digits(++p, end, 1, 2, day)) {
+            return nullptr;
+        }
+        if (month < 1 || month > 12 || day < 1 || day > 31) return nullptr;
+        seconds = (double)days_from_civil(year, (unsigned)month, (unsigned)day) * 86400.0;
+        // A date alone is midnight; anything after it that is not a time is left unparsed
+        if (p + 1 < end && (*p == 'T' || *p == 't' || *p == ' ') && is_digit(p[1])) {
+            double time = 0.0;
+            if (const char* after = scan_time(p + 1, end, time)) {
+                seconds += time;
+                p = after;
+            }
+        }
+        return p;
+    }
+    if (p == end || !is_digit(*p)) return nullptr;
+    const char* after = scan_number(p, end, seconds);
+    if (!after) return nullptr;
+    // Epoch seconds stay below 1e11 until the year 5138
+    if (seconds >= 1e17) seconds /= 1e9;
+    else if (seconds >= 1e14) seconds /= 1e6;
+    else if (seconds >= 1e11) seconds /= 1e3;
+    return after;
+}
+
+// Reads a mapping through `pin`, holding the most recent span
+class PinnedReader {
+public:
+    PinnedReader(const char* data, size_t size, const std::function<std::shared_ptr<const void>(size_t, size_t)>& pin)
+        : data(data), size(size), pin(pin) {}
+
+    // Make [from, to) readable
+    void hold(size_t from, size_t to) {
+        if (!pin || (from >= begin && to <= end)) return;
+        begin = from;
+        end = std::max(to, std::min(size, from + kProbeWindow));
+        token = pin(begin, end - begin);
+    }
+
+    // First terminator at or after `pos`, or the size
+    size_t terminator(size_t pos) {
+        while (pos < size) {
+            hold(pos, pos + 1);
+            size_t limit = pin ? end : size;
+            for (; pos < limit; ++pos) {
+                if (is_terminator(data[pos])) return pos;
+            }
+        }
+        return size;
+    }
+
+    // Start of the line after the terminator at `pos` (\n, \r, \r\n or \n\r)
+    size_t after(size_t pos) {
+        if (pos >= size) return size;
+        hold(pos, std::min(size, pos + 2));
+        char c = data[pos++];
+        if (pos < size && is_terminator(data[pos]) && data[pos] != c) ++pos;
+        return pos;
+    }
+
+private:
+    const char* data;
+    size_t size;
+    const std::function<std::shared_ptr<const void>(size_t, size_t)>& pin;
+    std::shared_ptr<const void> token;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+// Key of the line [begin, end): the line itself or field `spec.field`, without surrounding double
+// quotes. False when the line has no such field.
+bool key_span(const char* data, size_t begin, size_t end, const SeekSpec& spec, size_t& key_begin, size_t& key_end) {
+    key_begin = begin;
+    key_end = end;
+    if (spec.field < 0) return true;
+    size_t pos = begin;
+    for (long f = 0;; ++f) {
+        if (spec.delimiter == ' ') {
+            while (pos < end && (data[pos] == ' ' || data[pos] == '\t')) ++pos;
+            if (pos == end) return false;
+            key_begin = pos;
+            while (pos < end && data[pos] != ' ' && data[pos] != '\t') ++pos;
+        } else {
+            key_begin = pos;
+            const void* found = std::memchr(data + pos, spec.delimiter, end - pos);
+            pos = found ? (size_t)(static_cast<const char*>(found) - data) : end;
+        }
+        key_end = pos;
+        if (f == spec.field) break;
+        if (pos == end) return false;
+        if (spec.delimiter != ' ') ++pos;
+    }
+    if (key_end - key_begin >= 2 && data[key_begin] == '"' && data[key_end - 1] == '"') {
+        ++key_begin;
+        --key_end;
+    }
+    return true;
+}
+
+template<typename T>
+int compare_values(T a, T b) {
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+// Sign of (line key - sought key), or kNotComparable
+int compare_line(const char* data, size_t begin, size_t end, const SeekSpec& spec, double key_value) {
+    size_t kb = 0, ke = 0;
+    if (!key_span(data, begin, end, spec, kb, ke) || kb == ke) return kNotComparable;
+    double value = 0.0;
+    switch (spec.compare) {
+        case SeekSpec::Compare::Text: {
+            size_t n = std::min(ke - kb, spec.key.size());
+            int c = std::memcmp(data + kb, spec.key.data(), n);
+            if (c != 0) return c < 0 ? -1 : 1;
+            return ke - kb < spec.key.size() ? -1 : 0;
+        }
+        case SeekSpec::Compare::Number:
+            if (!scan_number(data + kb, data + ke, value)) return kNotComparable;
+            return compare_values(value, key_value);
+        case SeekSpec::Compare::Timestamp:
+            if (!scan_timestamp(data + kb, data + ke, value)) return kNotComparable;
+            return compare_values(value, key_value);
+    }
+    return kNotComparable;
+}
+
+} // namespace
+
+bool parse_timestamp(const char* text, size_t length, double& seconds) {
+    return scan_timestamp(text, text + length, seconds) != nullptr;
+}
+
+bool seek_sorted(const char* data, size_t size, const SeekSpec& spec, SeekResult& result, std::string& error,
+                 const std::function<std::shared_ptr<const void>(size_t, size_t)>& pin) {
+    result = SeekResult();
+    double key_value = 0.0;
+    const char* key_end = spec.key.data() + spec.key.size();
+    if (spec.key.empty()) {
+        error = "key must be a non-empty string";
+        return false;
+    }
+    if (spec.compare == SeekSpec::Compare::Number && scan_number(spec.key.data(), key_end, key_value) != key_end) {
+        error = "key is not a number: " + spec.key;
+        return false;
+    }
+    if (spec.compare == SeekSpec::Compare::Timestamp && scan_timestamp(spec.key.data(), key_end, key_value) == nullptr) {
+        error = "key is not a timestamp: " + spec.key;
+        return false;
+    }
+
+    PinnedReader reader(data, size, pin);
+    // First line with a comparable key starting in [from, limit): its start, the start of the
+    // line after it and the comparison. False when there is none.
+    auto probe = [&](size_t from, size_t limit, size_t& line_start, size_t& next, int& cmp) {
+        for (size_t pos = from; pos < limit && pos < size; pos = next) {
+            size_t line_end = reader.terminator(pos);
+            next = reader.after(line_end);
+            reader.hold(pos, line_end);
+            cmp = compare_line(data, pos, line_end, spec, key_value);
+            if (cmp != kNotComparable) {
+                ++result.probes;
+                line_start = pos;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Lines starting before `lo` sort before the key, and the first comparable line at or after `hi`
+    // (if any) sorts at or after it
+    size_t lo = 0;
+    size_t hi = size;
+    while (hi - lo > kLinearScanBytes) {
+        size_t mid = lo + (hi - lo) / 2;
+        size_t start = reader.after(reader.terminator(mid - 1));
+        if (start >= hi) break;
+        size_t line_start = 0, next = 0;
+        int cmp = 0;
+        if (!probe(start, hi, line_start, next, cmp) || cmp >= 0) {
+            hi = start;
+        } else {
+            lo = next;
+        }
+    }
+    for (size_t pos = lo;;) {
+        size_t line_start = 0, next = 0;
+        int cmp = 0;
+        if (!probe(pos, size, line_start, next, cmp)) {
+            result.offset = size;
+            return true;
+        }
+        if (cmp >= 0) {
+            result.offset = line_start;
+            result.found = true;
+            result.exact = cmp == 0;
+            return true;
+        }
+        pos = next;
+    }
+}
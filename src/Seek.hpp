@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+// Key of a 'seek' over a file whose lines are sorted by it
+struct SeekSpec {
+    enum class Compare { Text, Number, Timestamp };
+    std::string key;
+    // Text compares the first key-length bytes of the line or field with the key bytewise; Number and
+    // Timestamp parse both sides, and lines whose key does not parse (headers, blank lines) are skipped
+    Compare compare = Compare::Text;
+    // Zero-based field holding the key, or -1 for the start of the line
+    long field = -1;
+    // Field delimiter; ' ' splits at runs of spaces and tabs
+    char delimiter = ' ';
+};
+
+struct SeekResult {
+    // Start of the first line whose key sorts at or after the key, or the file size if there is none
+    size_t offset = 0;
+    bool found = false;
+    // The line's key equals the key (for Text: starts with it)
+    bool exact = false;
+    // Lines whose key was compared
+    size_t probes = 0;
+};
+
+// Seconds since the Unix epoch of an ISO 8601 style timestamp at the start of `text`
+// ("2026-10-16", "2026-10-16T12:00", "2026/10/16 12:00:00.250+02:00"; UTC unless an offset is
+// given) or of a number of epoch seconds, milliseconds, microseconds or nanoseconds, told apart by
+// magnitude. A leading '[', '"' or '\'' is skipped.
+bool parse_timestamp(const char* text, size_t length, double& seconds);
+
+// Bisect the lines of [0, size) by byte offset for the first line whose key sorts at or after
+// `spec.key`, snapping each probe to the next line start. Only the lines probed are read, so the
+// cost is O(log size) lines. `pin(offset, length)`, when given, is called for every byte span
+// before it is read, and its token is held while the span is read. Returns false with `error` set
+// when the key does not parse as `spec.compare` requires.
+bool seek_sorted(const char* data, size_t size, const SeekSpec& spec, SeekResult& result, std::string& error,
+                 const std::function<std::shared_ptr<const void>(size_t, size_t)>& pin = nullptr);
@@ -2,32 +2,91 @@
 #include <filesystem>
 #include <stdexcept>
 #include <algorithm>
+#include <chrono>
 #include <mutex>
+#include <cstdint>
+#include <charconv>
+#include <sys/stat.h>
+
+// Content sampled to confirm a grown file was only appended to: the last bytes of the old size and
+// windows spread evenly over the rest
+static constexpr size_t kAppendCheckBytes = 4096;
+static constexpr size_t kAppendSamples = 64;
+static constexpr size_t kAppendSampleBytes = 64;
+
+static std::string append_sample(const char* data, size_t size) {
+    std::string sample;
+    sample.reserve(kAppendSamples * kAppendSampleBytes + kAppendCheckBytes);
+    for (size_t i = 0; i < kAppendSamples; ++i) {
+        size_t from = size / kAppendSamples * i;
+        sample.append(data + from, std::min(kAppendSampleBytes, size - from));
+    }
+    size_t tail = std::min(kAppendCheckBytes, size);
+    sample.append(data + size - tail, tail);
+    return sample;
+}
+
+static std::atomic<uint64_t> next_registry_id{1};
+
+static std::string format_handle(uint32_t slot, uint32_t generation) {
+    return std::to_string((uint64_t)generation << 32 | slot);
+}
+
+// Slot and generation of a compact handle; false for anything else (paths are never all digits)
+static bool parse_handle(const std::string& handler, uint32_t& slot, uint32_t& generation) {
+    uint64_t value = 0;
+    const char* end = handler.data() + handler.size();
+    auto [parsed, ec] = std::from_chars(handler.data(), end, value);
+    if (handler.empty() || ec != std::errc() || parsed != end) {
+        return false;
+    }
+    slot = (uint32_t)value;
+    generation = (uint32_t)(value >> 32);
+    return true;
+}
+
+SegmentRegistry::SegmentRegistry()
+    : handlerTable(std::make_shared<const HandlerTable>()), registryId(next_registry_id++),
+      watcher([this](const std::string& path) { markStale(path); }) {}
+
+SegmentRegistry::~SegmentRegistry() {
+    waitForBackgroundTasks();
+}
 
 void SegmentRegistry::setAllowedPaths(const std::vector<std::string>& paths) {
-    std::unique_lock lock(mutex);
-    allowedPaths.clear();
+    std::vector<std::string> resolved;
     for (const auto& path : paths) {
         try {
-            allowedPaths.push_back(std::filesystem::canonical(path).string());
+            resolved.push_back(std::filesystem::canonical(path).string());
         } catch (const std::filesystem::filesystem_error&) {
             // Skip invalid paths
         }
     }
+    std::unique_lock lock(mutex);
+    allowedPaths = std::move(resolved);
+}
+
+void SegmentRegistry::setTaskflowManager(TaskflowManager* manager) {
+    std::unique_lock lock(mutex);
+    taskflow = manager;
 }
 
 bool SegmentRegistry::isPathAllowed(const std::string& path) const {
-    if (allowedPaths.empty()) {
-        return true; // If no restrictions configured, allow all
-    }
-    
     std::string canonical;
     try {
         canonical = std::filesystem::canonical(path).string();
     } catch (const std::filesystem::filesystem_error&) {
-        return false;
+        std::shared_lock lock(mutex);
+        return allowedPaths.empty();
+    }
+    return isCanonicalAllowed(canonical);
+}
+
+bool SegmentRegistry::isCanonicalAllowed(const std::string& canonical) const {
+    std::shared_lock lock(mutex);
+    if (allowedPaths.empty()) {
+        return true; // If no restrictions configured, allow all
     }
-    
     // Check if path is under any allowed path
     for (const auto& allowed : allowedPaths) {
         if (canonical == allowed || 
@@ -38,65 +97,625 @@ bool SegmentRegistry::isPathAllowed(const std::string& path) const {
     return false;
 }
 
-std::shared_ptr<MemorySegment> SegmentRegistry::preload(const std::string& path) {
-    std::unique_lock lock(mutex);
-    
-    // Check if path is allowed
+std::shared_ptr<MemorySegment> SegmentRegistry::preload(const std::string& path, std::string* handle) {
+    // Path resolution, stat and mmap run without the lock, so a slow filesystem only delays
+    // preloads of its own paths. The lock guards the map lookups and the final insert.
     if (!isPathAllowed(path)) {
         throw std::runtime_error("Access denied: path not in allowed list");
     }
-    
-    auto canonical = std::filesystem::canonical(path).string();
-    auto it = pathMap.find(canonical);
-    if (it != pathMap.end()) {
-        it->second->incRef();
-        return it->second;
-    }
-    auto segment = std::make_shared<MemorySegment>(canonical);
-    pathMap[canonical] = segment;
-    // Generate handler (for demo, use path)
-    handlerMap[canonical] = segment;
+    return load(std::filesystem::canonical(path).string(), true, handle);
+}
+
+std::shared_ptr<MemorySegment> SegmentRegistry::load(const std::string& canonical, bool open, std::string* handle) {
+    while (true) {
+        std::promise<std::shared_ptr<MemorySegment>> promise;
+        std::shared_future<std::shared_ptr<MemorySegment>> pending;
+        std::shared_ptr<MemorySegment> current;
+        std::shared_ptr<const LineIndex> currentIndex;
+        bool added = false;
+        {
+            std::unique_lock lock(mutex);
+            auto it = pathMap.find(canonical);
+            auto evicted = evictedPaths.find(canonical);
+            if (!open && it != pathMap.end() && !it->second->isStale()) {
+                // Remapped by someone else meanwhile
+                return it->second;
+            }
+            if (!open && it == pathMap.end() && evicted == evictedPaths.end()) {
+                // Closed meanwhile
+                return nullptr;
+            }
+            auto flight = preloadsInFlight.find(canonical);
+            if (flight != preloadsInFlight.end()) {
+                pending = flight->second;
+            } else {
+                if (it != pathMap.end()) {
+                    current = it->second;
+                } else if (evicted != evictedPaths.end()) {
+                    // Readers may still hold the evicted mapping; it is reused if the file is unchanged
+                    current = handlerMap[canonical].lock();
+                } else {
+                    // Watched below, before mapping, so a change made meanwhile is not missed
+                    added = true;
+                }
+                if (current) {
+                    auto idx = lineIndexMap.find(canonical);
+                    if (idx != lineIndexMap.end()) currentIndex = idx->second;
+                }
+                // Changes reported from here on mark the result stale
+                staleInFlight.erase(canonical);
+                preloadsInFlight.emplace(canonical, promise.get_future().share());
+            }
+        }
+
+        if (pending.valid()) {
+            // Another preload of this path is mapping it: share its result (or its error)
+            auto segment = pending.get();
+            std::unique_lock lock(mutex);
+            auto it = pathMap.find(canonical);
+            if (segment && it != pathMap.end() && it->second == segment) {
+                if (open) {
+                    segment->incRef();
+                    if (handle) *handle = handleOf(canonical);
+                }
+                return segment;
+            }
+            // Closed or evicted meanwhile; start over
+            continue;
+        }
+
+        // inotify resolves the directory, which may hang on a slow filesystem: never under the lock.
+        // Changes reported once it is set go to staleInFlight.
+        if (added) watcher.watch(canonical);
+        std::shared_ptr<MemorySegment> segment;
+        std::shared_ptr<const LineIndex> extended;
+        try {
+            segment = mapIfChanged(canonical, current, currentIndex, extended);
+        } catch (...) {
+            {
+                std::unique_lock lock(mutex);
+                preloadsInFlight.erase(canonical);
+                staleInFlight.erase(canonical);
+            }
+            if (added) watcher.unwatch(canonical);
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+
+        std::unique_lock lock(mutex);
+        preloadsInFlight.erase(canonical);
+        bool changedMeanwhile = staleInFlight.erase(canonical) > 0;
+        // Only this preload changes the entry, but a close may have removed it meanwhile
+        auto it = pathMap.find(canonical);
+        auto evicted = evictedPaths.find(canonical);
+        bool restored = it == pathMap.end() && evicted != evictedPaths.end();
+        bool watchAgain = false;
+        if (!open && it == pathMap.end() && !restored) {
+            promise.set_value(nullptr);
+            return nullptr;
+        }
+        bool replaced = it != pathMap.end() && it->second != segment;
+        if (replaced || (restored && segment != current)) {
+            bool sameFile = restored && evicted->second.sameFile(*segment);
+            if (replaced) {
+                segment->adoptRefCount(it->second->refCount());
+                segment->setVersion(it->second->version() + 1);
+                mappedBytes -= it->second->fileSize();
+            } else {
+                segment->adoptRefCount(evicted->second.refs);
+                segment->setVersion(evicted->second.version + (sameFile ? 0 : 1));
+            }
+            // Appends keep the line index checkpoints and only scan the new tail; anything else drops it
+            auto idx = lineIndexMap.find(canonical);
+            if (idx != lineIndexMap.end()) {
+                if (extended && idx->second == currentIndex) {
+                    idx->second = extended;
+                } else if (!sameFile) {
+                    lineIndexMap.erase(idx);
+                }
+            }
+            if (!sameFile) {
+                recordIndexMap.erase(canonical);
+                statsMap.erase(canonical);
+                trigramIndexMap.erase(canonical);
+            }
+        } else if (restored) {
+            segment->adoptRefCount(evicted->second.refs);
+        }
+        segment->setStale(changedMeanwhile);
+        if (restored) {
+            evictedPaths.erase(evicted);
+        }
+        if (open) {
+            segment->incRef();
+        }
+        if (it == pathMap.end() && !restored) {
+            uint32_t slot = 0;
+            if (!freeHandleSlots.empty()) {
+                slot = freeHandleSlots.back();
+                freeHandleSlots.pop_back();
+            } else {
+                slot = (uint32_t)handleSlots.size();
+                handleSlots.emplace_back();
+            }
+            handleSlots[slot].path = canonical;
+            handleSlotOfPath[canonical] = slot;
+            // Closed while this preload was remapping it, which dropped its watch
+            watchAgain = !added;
+        }
+        if (it == pathMap.end() || replaced) {
+            pathMap[canonical] = segment;
+            mappedBytes += segment->fileSize();
+            // Generate handler (for demo, use path)
+            handlerMap[canonical] = segment;
+            handleSlots[handleSlotOfPath[canonical]].segment = segment;
+            publishHandlers(canonical);
+        }
+        segment->markUsed(useEpoch.fetch_add(1, std::memory_order_relaxed) + 1);
+        evictOverBudget(canonical);
+        if (open && handle) *handle = handleOf(canonical);
+        lock.unlock();
+        promise.set_value(segment);
+        if (watchAgain) {
+            watcher.watch(canonical);
+            // A change made before the watch was set would go unreported
+            markStale(canonical);
+        }
+        return segment;
+    }
+}
+
+void SegmentRegistry::markStale(const std::string& canonical) {
+    std::unique_lock lock(mutex);
+    if (preloadsInFlight.count(canonical)) {
+        staleInFlight.insert(canonical);
+    }
+    // handlerMap also reaches an evicted mapping that readers still hold
+    auto it = handlerMap.find(canonical);
+    if (it == handlerMap.end()) {
+        return;
+    }
+    if (auto segment = it->second.lock()) {
+        segment->setStale(true);
+    }
+}
+
+void SegmentRegistry::setMemoryBudget(size_t maxBytes, size_t maxHandlers) {
+    std::unique_lock lock(mutex);
+    maxMappedBytes = maxBytes;
+    maxMappedHandlers = maxHandlers;
+    evictOverBudget(std::string());
+}
+
+size_t SegmentRegistry::mappedSegments() const {
+    std::shared_lock lock(mutex);
+    return pathMap.size();
+}
+
+size_t SegmentRegistry::mappedByteCount() const {
+    std::shared_lock lock(mutex);
+    return mappedBytes;
+}
+
+void SegmentRegistry::evictOverBudget(const std::string& keep) {
+    while ((maxMappedBytes != 0 && mappedBytes > maxMappedBytes) || (maxMappedHandlers != 0 && pathMap.size() > maxMappedHandlers)) {
+        // Least recently used first. Scanning is linear, but it only runs when a load went over budget.
+        auto victim = pathMap.end();
+        for (auto it = pathMap.begin(); it != pathMap.end(); ++it) {
+            if (it->first != keep && (victim == pathMap.end() || it->second->lastUsed() < victim->second->lastUsed())) {
+                victim = it;
+            }
+        }
+        if (victim == pathMap.end()) {
+            return;
+        }
+        const MemorySegment& segment = *victim->second;
+        evictedPaths[victim->first] = EvictedPath{segment.refCount(), segment.version(), segment.fileDevice(), segment.fileInode(), segment.fileSize(), segment.fileModified(), segment.size()};
+        mappedBytes -= segment.fileSize();
+        // handlerMap keeps its weak reference: the mapping is unmapped once its last reader lets go,
+        // and the next lookup maps the file again. Marked stale so that lookup goes through load()
+        // even while a reader holds it, which reuses it only if the file is unchanged.
+        victim->second->setStale(true);
+        pathMap.erase(victim);
+    }
+}
+
+std::shared_ptr<MemorySegment> SegmentRegistry::mapIfChanged(const std::string& canonical, const std::shared_ptr<MemorySegment>& current,
+                                                             const std::shared_ptr<const LineIndex>& index, std::shared_ptr<const LineIndex>& extended) const {
+    if (!current) {
+        return std::make_shared<MemorySegment>(canonical, 0);
+    }
+    struct stat st;
+    if (::stat(canonical.c_str(), &st) != 0) {
+        return current;
+    }
+    bool sameFile = (uint64_t)st.st_dev == current->fileDevice() && (uint64_t)st.st_ino == current->fileInode();
+    uint64_t modified = (uint64_t)st.st_mtim.tv_sec * 1000000000ull + (uint64_t)st.st_mtim.tv_nsec;
+    // A truncated mapping serves zeroed pages, so it is replaced even if the file looks unchanged
+    if (sameFile && (size_t)st.st_size == current->fileSize() && modified == current->fileModified() && !current->truncated()) {
+        return current;
+    }
+
+    auto segment = std::make_shared<MemorySegment>(canonical, 0);
+    // Both mappings show the file as it is now, so the old content is only known by its sample
+    std::string sample = current->appendSample();
+    if (index && index->byteSize() == current->size() && !sample.empty() && sameFile && !segment->isCompressed()
+        && segment->size() > current->size()) {
+        const char* data = static_cast<const char*>(segment->data());
+        if (append_sample(data, current->size()) == sample) {
+            // Sampled before the scan, so a rewrite during it fails the next comparison
+            segment->setAppendSample(append_sample(data, segment->size()));
+            extended = LineIndex::extend(*index, data, segment->size());
+        }
+    }
+    if (current->truncated() || segment->truncated()) {
+        // The comparison or the scan read zeroed pages
+        extended = nullptr;
+    }
     return segment;
 }
 
+std::string SegmentRegistry::handleOf(const std::string& canonical) const {
+    auto it = handleSlotOfPath.find(canonical);
+    return it != handleSlotOfPath.end() ? format_handle(it->second, handleSlots[it->second].generation) : std::string();
+}
+
+static size_t handler_shard(const std::string& canonical, size_t shards) {
+    return std::hash<std::string>{}(canonical) % shards;
+}
+
+const std::weak_ptr<MemorySegment>* SegmentRegistry::HandlerTable::find(const std::string& canonical) const {
+    const auto& shard = shards[handler_shard(canonical, kHandlerShards)];
+    if (!shard) return nullptr;
+    auto it = shard->find(canonical);
+    return it != shard->end() ? &it->second : nullptr;
+}
+
+const SegmentRegistry::HandleSlot* SegmentRegistry::HandlerTable::slot(uint32_t index, uint32_t generation) const {
+    size_t block = index / kSlotsPerBlock;
+    if (block >= slotBlocks.size() || !slotBlocks[block]) return nullptr;
+    const HandleSlot& entry = (*slotBlocks[block])[index % kSlotsPerBlock];
+    // Slots past the last one handed out have an empty path
+    return entry.generation == generation && !entry.path.empty() ? &entry : nullptr;
+}
+
+void SegmentRegistry::publishHandlers(const std::string& canonical) {
+    auto table = std::make_shared<HandlerTable>(*handlerTable);
+    auto& shard = table->shards[handler_shard(canonical, kHandlerShards)];
+    auto updated = shard ? std::make_shared<HandlerShard>(*shard) : std::make_shared<HandlerShard>();
+    auto it = handlerMap.find(canonical);
+    if (it != handlerMap.end()) {
+        (*updated)[canonical] = it->second;
+    } else {
+        updated->erase(canonical);
+    }
+    shard = std::move(updated);
+    auto slot = handleSlotOfPath.find(canonical);
+    if (slot != handleSlotOfPath.end()) {
+        size_t block = slot->second / kSlotsPerBlock;
+        if (table->slotBlocks.size() <= block) table->slotBlocks.resize(block + 1);
+        auto copy = std::make_shared<SlotBlock>();
+        for (size_t i = 0; i < kSlotsPerBlock && block * kSlotsPerBlock + i < handleSlots.size(); ++i) {
+            (*copy)[i] = handleSlots[block * kSlotsPerBlock + i];
+        }
+        table->slotBlocks[block] = std::move(copy);
+    }
+    handlerTable = std::move(table);
+    handlerGeneration.fetch_add(1, std::memory_order_release);
+}
+
+const SegmentRegistry::HandlerTable& SegmentRegistry::currentHandlers() const {
+    struct Cached {
+        uint64_t registry = 0;
+        uint64_t generation = 0;
+        std::shared_ptr<const HandlerTable> table;
+    };
+    thread_local Cached cached;
+    uint64_t generation = handlerGeneration.load(std::memory_order_acquire);
+    if (cached.registry != registryId || cached.generation != generation) {
+        std::shared_lock lock(mutex);
+        cached.registry = registryId;
+        cached.generation = handlerGeneration.load(std::memory_order_relaxed);
+        cached.table = handlerTable;
+    }
+    return *cached.table;
+}
+
 std::shared_ptr<MemorySegment> SegmentRegistry::getByHandler(const std::string& handler) {
+    const HandlerTable& table = currentHandlers();
+    const std::weak_ptr<MemorySegment>* entry = nullptr;
+    const std::string* canonical = &handler;
+    uint32_t slot = 0, generation = 0;
+    if (parse_handle(handler, slot, generation)) {
+        if (const HandleSlot* found = table.slot(slot, generation)) {
+            entry = &found->segment;
+            canonical = &found->path;
+        }
+    } else {
+        entry = table.find(handler);
+    }
+    if (!entry) {
+        return nullptr;
+    }
+    if (auto segment = entry->lock(); segment && !segment->isStale()) {
+        segment->markUsed(useEpoch.load(std::memory_order_relaxed));
+        return segment;
+    }
+    // Evicted, or its file changed since it was mapped: map it again. The path is copied because
+    // loading publishes a new table.
+    return load(std::string(*canonical), false, nullptr);
+}
+
+std::string SegmentRegistry::canonicalHandler(const std::string& handler) const {
+    uint32_t slot = 0, generation = 0;
+    if (!parse_handle(handler, slot, generation)) {
+        return handler;
+    }
+    const HandleSlot* found = currentHandlers().slot(slot, generation);
+    return found ? found->path : std::string();
+}
+
+std::string SegmentRegistry::resolveHandler(const std::string& handler) const {
+    std::string canonical = canonicalHandler(handler);
+    const std::weak_ptr<MemorySegment>* entry = currentHandlers().find(canonical);
+    return entry && !entry->expired() ? canonical : std::string();
+}
+
+void SegmentRegistry::close(const std::string& requested) {
+    const std::string handler = canonicalHandler(requested);
+    std::unique_lock lock(mutex);
+    auto it = handlerMap.find(handler);
+    if (it == handlerMap.end()) {
+        return;
+    }
+    // An evicted handler keeps its open count in evictedPaths
+    auto evicted = evictedPaths.find(handler);
+    if (evicted != evictedPaths.end()) {
+        if (--evicted->second.refs > 0) {
+            return;
+        }
+        evictedPaths.erase(evicted);
+    } else {
+        auto mapped = pathMap.find(handler);
+        if (mapped == pathMap.end()) {
+            return;
+        }
+        mapped->second->decRef();
+        if (mapped->second->refCount() > 0) {
+            return;
+        }
+        // Remove from registry
+        mappedBytes -= mapped->second->fileSize();
+        pathMap.erase(mapped);
+    }
+    handlerMap.erase(it);
+    auto slot = handleSlotOfPath.find(handler);
+    if (slot != handleSlotOfPath.end()) {
+        HandleSlot& freed = handleSlots[slot->second];
+        freed.generation = freed.generation == UINT32_MAX ? 1 : freed.generation + 1;
+        freed.path.clear();
+        freed.segment.reset();
+    }
+    // Publishes the freed slot while the path still leads to it
+    publishHandlers(handler);
+    if (slot != handleSlotOfPath.end()) {
+        freeHandleSlots.push_back(slot->second);
+        handleSlotOfPath.erase(slot);
+    }
+    lineIndexMap.erase(handler);
+    recordIndexMap.erase(handler);
+    statsMap.erase(handler);
+    trigramIndexMap.erase(handler);
+    lock.unlock();
+    // Watches are counted, so a preload of the path that runs meanwhile keeps its own
+    watcher.unwatch(handler);
+}
+
+std::shared_ptr<const LineIndex> SegmentRegistry::lineIndex(const std::string& requested) {
+    const std::string handler = canonicalHandler(requested);
+    // Maps an evicted handler again
+    auto segment = getByHandler(handler);
+    if (!segment) {
+        return nullptr;
+    }
+    {
+        std::shared_lock lock(mutex);
+        auto idx = lineIndexMap.find(handler);
+        if (idx != lineIndexMap.end() && idx->second->byteSize() == segment->size()) {
+            return idx->second;
+        }
+    }
+    // Build outside the lock so readers of other handlers are not blocked by the scan
+    auto pinned = segment->pin(0, segment->size());
+    if (!segment->isCompressed()) {
+        segment->setAppendSample(append_sample(static_cast<const char*>(segment->data()), segment->size()));
+    }
+    auto index = LineIndex::build(static_cast<const char*>(segment->data()), segment->size(), taskflow);
+    if (segment->truncated()) {
+        // Scanned zeroed pages; the next lookup maps the file again
+        return nullptr;
+    }
+    std::unique_lock lock(mutex);
+    // Only publish for the mapping the index was built from, which a remap may have replaced
+    auto it = handlerMap.find(handler);
+    if (it != handlerMap.end() && it->second.lock() == segment) {
+        lineIndexMap[handler] = index;
+    }
+    return index;
+}
+
+std::shared_ptr<const LineIndex> SegmentRegistry::cachedLineIndex(const std::string& requested) const {
+    const std::string handler = canonicalHandler(requested);
     std::shared_lock lock(mutex);
     auto it = handlerMap.find(handler);
-    if (it != handlerMap.end()) {
-        return it->second.lock();
+    auto idx = lineIndexMap.find(handler);
+    if (it == handlerMap.end() || idx == lineIndexMap.end()) {
+        return nullptr;
+    }
+    auto segment = it->second.lock();
+    if (!segment || idx->second->byteSize() != segment->size()) {
+        return nullptr;
+    }
+    return idx->second;
+}
+
+std::shared_ptr<const RecordIndex> SegmentRegistry::recordIndex(const std::string& requested) {
+    const std::string handler = canonicalHandler(requested);
+    // Maps an evicted handler again
+    auto segment = getByHandler(handler);
+    if (!segment) {
+        return nullptr;
+    }
+    {
+        std::shared_lock lock(mutex);
+        auto idx = recordIndexMap.find(handler);
+        if (idx != recordIndexMap.end() && idx->second->byteSize() == segment->size()) {
+            return idx->second;
+        }
+    }
+    // Build outside the lock, like line indexes
+    auto pinned = segment->pin(0, segment->size());
+    std::shared_ptr<const RecordIndex> index = RecordIndex::build(static_cast<const char*>(segment->data()), segment->size(), taskflow);
+    if (segment->truncated()) {
+        return nullptr;
+    }
+    std::unique_lock lock(mutex);
+    auto it = handlerMap.find(handler);
+    if (it != handlerMap.end() && it->second.lock() == segment) {
+        recordIndexMap[handler] = index;
     }
-    return nullptr;
+    return index;
 }
 
-void SegmentRegistry::close(const std::string& handler) {
+std::shared_ptr<const FileStats> SegmentRegistry::fileStats(const std::string& requested) {
+    const std::string handler = canonicalHandler(requested);
+    // Maps an evicted handler again
+    auto segment = getByHandler(handler);
+    if (!segment) {
+        return nullptr;
+    }
+    {
+        std::shared_lock lock(mutex);
+        auto stats = statsMap.find(handler);
+        if (stats != statsMap.end() && stats->second->bytes == segment->size()) {
+            return stats->second;
+        }
+    }
+    // Profile outside the lock, like line indexes
+    auto pinned = segment->pin(0, segment->size());
+    auto stats = std::make_shared<const FileStats>(compute_file_stats(static_cast<const char*>(segment->data()), segment->size(), taskflow));
+    if (segment->truncated()) {
+        return nullptr;
+    }
     std::unique_lock lock(mutex);
     auto it = handlerMap.find(handler);
-    if (it != handlerMap.end()) {
-        auto segment = it->second.lock();
-        if (segment) {
-            segment->decRef();
-            if (segment->refCount() <= 0) {
-                // Remove from registry
-                for (auto p = pathMap.begin(); p != pathMap.end(); ++p) {
-                    if (p->second == segment) {
-                        pathMap.erase(p);
-                        break;
-                    }
-                }
-                handlerMap.erase(it);
-            }
+    if (it != handlerMap.end() && it->second.lock() == segment) {
+        statsMap[handler] = stats;
+    }
+    return stats;
+}
+
+std::shared_ptr<const FileStats> SegmentRegistry::cachedFileStats(const std::string& requested) const {
+    const std::string handler = canonicalHandler(requested);
+    std::shared_lock lock(mutex);
+    auto it = handlerMap.find(handler);
+    auto stats = statsMap.find(handler);
+    if (it == handlerMap.end() || stats == statsMap.end()) {
+        return nullptr;
+    }
+    auto segment = it->second.lock();
+    if (!segment || stats->second->bytes != segment->size()) {
+        return nullptr;
+    }
+    return stats->second;
+}
+
+void SegmentRegistry::buildTrigramIndex(const std::string& requested) {
+    const std::string handler = canonicalHandler(requested);
+    std::unique_lock lock(mutex);
+    auto it = handlerMap.find(handler);
+    if (it == handlerMap.end() || trigramBuildsPending.count(handler)) {
+        return;
+    }
+    auto segment = it->second.lock();
+    if (!segment) {
+        return;
+    }
+    auto idx = trigramIndexMap.find(handler);
+    if (idx != trigramIndexMap.end() && idx->second->byteSize() == segment->size()) {
+        return;
+    }
+    // Forget finished tasks; their futures no longer block on destruction
+    std::erase_if(backgroundTasks, [](const std::future<void>& task) {
+        return task.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    });
+    trigramBuildsPending.insert(handler);
+    backgroundTasks.push_back(std::async(std::launch::async, [this, handler, segment]() {
+        std::shared_ptr<const TrigramIndex> index;
+        try {
+            auto pinned = segment->pin(0, segment->size());
+            index = TrigramIndex::build(static_cast<const char*>(segment->data()), segment->size(), taskflow);
+        } catch (const std::exception&) {
+            // Searches keep scanning the whole file
         }
+        std::unique_lock lock(mutex);
+        trigramBuildsPending.erase(handler);
+        // Only publish for the mapping the index was built from: the handler may have been closed
+        // or remapped meanwhile
+        auto it = handlerMap.find(handler);
+        if (index && !segment->truncated() && it != handlerMap.end() && it->second.lock() == segment) {
+            trigramIndexMap[handler] = index;
+        }
+    }));
+}
+
+std::shared_ptr<const TrigramIndex> SegmentRegistry::trigramIndex(const std::string& requested) const {
+    const std::string handler = canonicalHandler(requested);
+    std::shared_lock lock(mutex);
+    auto it = handlerMap.find(handler);
+    auto idx = trigramIndexMap.find(handler);
+    if (it == handlerMap.end() || idx == trigramIndexMap.end()) {
+        return nullptr;
+    }
+    auto segment = it->second.lock();
+    if (!segment || idx->second->byteSize() != segment->size()) {
+        return nullptr;
     }
+    return idx->second;
+}
+
+void SegmentRegistry::waitForBackgroundTasks() {
+    std::vector<std::future<void>> tasks;
+    {
+        std::unique_lock lock(mutex);
+        tasks.swap(backgroundTasks);
+    }
+    for (auto& task : tasks) {
+        task.wait();
+    }
+}
+
+bool SegmentRegistry::peekSize(const std::string& requested, size_t& size) const {
+    const std::string handler = canonicalHandler(requested);
+    std::shared_lock lock(mutex);
+    if (auto mapped = pathMap.find(handler); mapped != pathMap.end()) {
+        size = mapped->second->size();
+        return true;
+    }
+    if (auto evicted = evictedPaths.find(handler); evicted != evictedPaths.end()) {
+        size = evicted->second.size;
+        return true;
+    }
+    return false;
 }
 
 std::vector<std::string> SegmentRegistry::listHandlers() const {
     std::shared_lock lock(mutex);
     std::vector<std::string> handlers;
     handlers.reserve(handlerMap.size());
-    for (const auto& [handler, weak_seg] : handlerMap) {
-        if (!weak_seg.expired()) {
-            handlers.push_back(handler);
-        }
+    // Evicted handlers are still open
+    for (const auto& entry : handlerMap) {
+        handlers.push_back(entry.first);
     }
     return handlers;
 }
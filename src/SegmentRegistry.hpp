@@ -1,23 +1,177 @@
 #pragma once
+#include <array>
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
+#include <future>
+#include <atomic>
 #include <shared_mutex>
 #include "MemorySegment.hpp"
+#include "FileStats.hpp"
+#include "LineIndex.hpp"
+#include "RecordIndex.hpp"
+#include "TrigramIndex.hpp"
+#include "TaskflowManager.hpp"
+#include "FileWatcher.hpp"
 
 class SegmentRegistry {
 public:
-    std::shared_ptr<MemorySegment> preload(const std::string& path);
+    SegmentRegistry();
+    ~SegmentRegistry();
+
+    // Preloading an already-mapped path remaps it when the file changed on disk (e.g. a growing log).
+    // Concurrent preloads of one path share a single stat/mmap pass. Open files are also watched
+    // (see FileWatcher): a change marks the mapping stale, and the next lookup remaps it. `handle`, when given, receives
+    // the path's compact handle.
+    std::shared_ptr<MemorySegment> preload(const std::string& path, std::string* handle = nullptr);
+    // Every method taking a handler accepts either the canonical path or the compact handle that
+    // preload returned for it. A handle is a decimal number packing a slot index (low 32 bits) and
+    // the slot's generation (high 32 bits); it stays valid across remaps and goes stale on close.
+    // Lock-free on the read path: see HandlerTable. An evicted or stale handler is mapped again
+    // (which throws if its file can no longer be opened). Readers holding the previous mapping keep
+    // it; if the file is truncated under them, the mapping reports truncated() and the next lookup
+    // maps the file again.
     std::shared_ptr<MemorySegment> getByHandler(const std::string& handler);
+    // Canonical path of a handler or handle, or an empty string if it is not open
+    std::string resolveHandler(const std::string& handler) const;
     void close(const std::string& handler);
+    // Line index for a handler's segment, built on first use and kept until the handler is closed.
+    // This and the other builders below return nullptr if the file was truncated during the scan.
+    std::shared_ptr<const LineIndex> lineIndex(const std::string& handler);
+    // Line index only if it has already been built for the handler's current mapping
+    std::shared_ptr<const LineIndex> cachedLineIndex(const std::string& handler) const;
+    // JSON Lines record index for a handler's segment, built on first use and kept until the
+    // handler is closed or its file is remapped
+    std::shared_ptr<const RecordIndex> recordIndex(const std::string& handler);
+    // File profile of a handler's segment, computed on first use and kept until the handler is closed
+    std::shared_ptr<const FileStats> fileStats(const std::string& handler);
+    // File profile only if it has already been computed for the handler's current mapping
+    std::shared_ptr<const FileStats> cachedFileStats(const std::string& handler) const;
+    // Start building the trigram index of a handler's segment on a background task. The index is
+    // dropped when the handler is closed or its file is remapped.
+    void buildTrigramIndex(const std::string& handler);
+    // Trigram index if it has been built for the handler's current mapping
+    std::shared_ptr<const TrigramIndex> trigramIndex(const std::string& handler) const;
+    // Wait until every background index build started so far has finished
+    void waitForBackgroundTasks();
     std::vector<std::string> listHandlers() const;
+    // Segment size of an open handler without mapping it again or marking it used: the size of
+    // its mapping, or of the mapping it had when it was evicted. False if it is not open.
+    bool peekSize(const std::string& handler, size_t& size) const;
     void setAllowedPaths(const std::vector<std::string>& paths);
     bool isPathAllowed(const std::string& path) const;
+    // Worker pool used to build indexes and profiles of large files in parallel (optional)
+    void setTaskflowManager(TaskflowManager* manager);
+    // Limits on the bytes of files kept mapped and on the number of mapped handlers (0 = no limit).
+    // Loads over budget unmap the least recently used other handlers. Evicted handlers stay open,
+    // keep their indexes, and are mapped again by the next lookup.
+    void setMemoryBudget(size_t maxBytes, size_t maxHandlers);
+    size_t mappedSegments() const;
+    size_t mappedByteCount() const;
 
 private:
+    // Open handler whose mapping was evicted
+    struct EvictedPath {
+        int refs = 0;
+        uint64_t version = 0;
+        uint64_t device = 0;
+        uint64_t inode = 0;
+        size_t fileSize = 0;
+        uint64_t modified = 0;
+        // Segment size, which is the decompressed size for compressed files
+        size_t size = 0;
+        // Indexes built for the evicted mapping still describe `segment`
+        bool sameFile(const MemorySegment& segment) const {
+            return segment.fileDevice() == device && segment.fileInode() == inode && segment.fileSize() == fileSize &&
+                   segment.fileModified() == modified;
+        }
+    };
+    struct HandleSlot {
+        // Bumped when the slot is freed, so handles of the previous path no longer match
+        uint32_t generation = 1;
+        std::string path;
+        std::weak_ptr<MemorySegment> segment;
+    };
+    // Immutable snapshot of handlerMap for getByHandler. Every change to handlerMap publishes a new
+    // snapshot and bumps handlerGeneration (read-copy-update). Readers keep the snapshot they last
+    // used in a thread-local cache and only take the lock when the generation moved, so lookups
+    // take no lock while handlers are stable. They still lock the weak_ptr of their segment, an
+    // atomic update of its control block shared by every thread reading that handler.
+    // Snapshots share unchanged shards and slot blocks, so publishing copies one shard and one
+    // block instead of the whole table.
+    static constexpr size_t kHandlerShards = 64;
+    static constexpr size_t kSlotsPerBlock = 64;
+    using HandlerShard = std::unordered_map<std::string, std::weak_ptr<MemorySegment>>;
+    using SlotBlock = std::array<HandleSlot, kSlotsPerBlock>;
+    struct HandlerTable {
+        // By path hash; null shards are empty
+        std::array<std::shared_ptr<const HandlerShard>, kHandlerShards> shards;
+        // Compact handle slots in blocks of kSlotsPerBlock; null blocks are unused
+        std::vector<std::shared_ptr<const SlotBlock>> slotBlocks;
+        const std::weak_ptr<MemorySegment>* find(const std::string& canonical) const;
+        // Slot of a compact handle, or null when the handle is stale
+        const HandleSlot* slot(uint32_t index, uint32_t generation) const;
+    };
+    const HandlerTable& currentHandlers() const;
+    // Publish the entry and handle slot of `canonical` from handlerMap and handleSlots as the new
+    // snapshot. Caller holds the exclusive lock.
+    void publishHandlers(const std::string& canonical);
+
+    // Preload `canonical`, or with `open` false map an evicted handler again without taking a
+    // reference (nullptr if it was closed)
+    std::shared_ptr<MemorySegment> load(const std::string& canonical, bool open, std::string* handle);
+    // Evict least recently used mappings other than `keep` until the budget is met. Caller holds
+    // the exclusive lock.
+    void evictOverBudget(const std::string& keep);
+    // Map `canonical` when it is not mapped yet (`current` is null) or changed on disk since
+    // `current` was mapped; otherwise return `current`. New mappings start with no references.
+    // When the file was only appended to, `index` (built for `current`) is extended into
+    // `extended`. A grown file counts as appended when the sample taken from `current` as its
+    // index was built (kAppendSamples windows spread over the old size plus its last
+    // kAppendCheckBytes) reads the same in the new mapping. A rewrite that leaves every sampled
+    // byte unchanged goes unnoticed. Runs without the lock.
+    std::shared_ptr<MemorySegment> mapIfChanged(const std::string& canonical, const std::shared_ptr<MemorySegment>& current,
+                                                const std::shared_ptr<const LineIndex>& index, std::shared_ptr<const LineIndex>& extended) const;
+    bool isCanonicalAllowed(const std::string& canonical) const;
+    // Called by the watcher when `canonical` may have changed on disk
+    void markStale(const std::string& canonical);
+    // Path of a compact handle (empty when stale), or `handler` itself when it is a path
+    std::string canonicalHandler(const std::string& handler) const;
+    // Handle of an open path. Caller holds the lock.
+    std::string handleOf(const std::string& canonical) const;
+
+    // Mapped paths; open paths missing here are in evictedPaths
     std::unordered_map<std::string, std::shared_ptr<MemorySegment>> pathMap;
+    std::unordered_map<std::string, EvictedPath> evictedPaths;
+    size_t mappedBytes = 0;
+    size_t maxMappedBytes = 0;
+    size_t maxMappedHandlers = 0;
+    // Advanced by every load; lookups stamp it on their segment, so eviction order is exact between loads
+    std::atomic<uint64_t> useEpoch{0};
     std::unordered_map<std::string, std::weak_ptr<MemorySegment>> handlerMap;
+    // Compact handle slots; freed slots are reused with the next generation
+    std::vector<HandleSlot> handleSlots;
+    std::vector<uint32_t> freeHandleSlots;
+    std::unordered_map<std::string, uint32_t> handleSlotOfPath;
+    std::shared_ptr<const HandlerTable> handlerTable;
+    std::atomic<uint64_t> handlerGeneration{0};
+    // Distinguishes registries in the thread-local snapshot caches (addresses can be reused)
+    const uint64_t registryId;
+    std::unordered_map<std::string, std::shared_ptr<const LineIndex>> lineIndexMap;
+    std::unordered_map<std::string, std::shared_ptr<const RecordIndex>> recordIndexMap;
+    std::unordered_map<std::string, std::shared_ptr<const FileStats>> statsMap;
+    std::unordered_map<std::string, std::shared_ptr<const TrigramIndex>> trigramIndexMap;
+    std::unordered_set<std::string> trigramBuildsPending;
+    // Preloads mapping a path right now; other preloads of the path wait for their result
+    std::unordered_map<std::string, std::shared_future<std::shared_ptr<MemorySegment>>> preloadsInFlight;
+    // Paths in preloadsInFlight reported changed since their mapping started
+    std::unordered_set<std::string> staleInFlight;
+    std::vector<std::future<void>> backgroundTasks;
     std::vector<std::string> allowedPaths;
+    TaskflowManager* taskflow = nullptr;
     mutable std::shared_mutex mutex;
+    // Last, so its thread stops before the maps it updates are destroyed
+    FileWatcher watcher;
 };
@@ -0,0 +1,244 @@
+#include "StreamingResponse.hpp"
+#include "Encoding.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <mutex>
+
+// Span bytes a pool worker encodes per chunk: a multiple of 3, so only the last base64 chunk of
+// a span is padded
+static constexpr size_t kChunkBytes = 768 * 1024;
+// Chunks (mostly of small spans) encoded per round at most
+static constexpr size_t kMaxChunksAhead = 1024;
+
+void StreamingResponse::appendRaw(std::string json) {
+    Piece piece;
+    piece.literal = std::move(json);
+    pieces.push_back(std::move(piece));
+}
+
+void StreamingResponse::appendValue(const Json::Value& value) {
+    appendRaw(compact(value));
+}
+
+void StreamingResponse::appendString(std::shared_ptr<MemorySegment> segment, size_t offset, size_t length, Encoding encoding) {
+    appendRaw("\"");
+    Piece piece;
+    piece.segment = std::move(segment);
+    piece.offset = offset;
+    piece.length = length;
+    piece.encoding = encoding;
+    pieces.push_back(std::move(piece));
+    spanBytes += length;
+    appendRaw("\"");
+}
+
+void StreamingResponse::setProgress(std::function<void(uint64_t, uint64_t)> progress) {
+    progressCallback = std::move(progress);
+}
+
+void StreamingResponse::setParallel(TaskflowManager& pool, size_t lanes) {
+    parallelPool = &pool;
+    parallelLanes = std::max<size_t>(1, lanes);
+}
+
+// Text chunks end where no UTF-8 sequence crosses, so escaping them separately matches escaping the
+// span at once: the nearest lead or ASCII byte at most 3 bytes back, else `nominal` (no sequence
+// spans 4 continuation bytes)
+static size_t text_chunk_boundary(MemorySegment& segment, size_t offset, size_t nominal) {
+    size_t lowest = nominal >= 3 ? nominal - 3 : 0;
+    auto pinned = segment.pin(offset + lowest, nominal - lowest + 1);
+    const unsigned char* data = static_cast<const unsigned char*>(segment.data()) + offset;
+    for (size_t b = nominal + 1; b-- > lowest;) {
+        if ((data[b] & 0xc0) != 0x80) return b;
+    }
+    return nominal;
+}
+
+void StreamingResponse::encodeAhead() {
+    size_t budget = parallelLanes * kChunkBytes;
+    for (size_t p = current; p < pieces.size() && budget > 0 && ahead.size() < kMaxChunksAhead; ++p) {
+        const Piece& piece = pieces[p];
+        if (!piece.segment) continue;
+        size_t begin = p == current ? position : 0;
+        do {
+            Chunk chunk;
+            chunk.piece = p;
+            chunk.begin = begin;
+            chunk.end = std::min(piece.length, begin + kChunkBytes);
+            begin = chunk.end;
+            budget -= std::min(budget, chunk.end - chunk.begin);
+            ahead.push_back(std::move(chunk));
+        } while (begin < piece.length && budget > 0 && ahead.size() < kMaxChunksAhead);
+    }
+
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto encode = [&](size_t i) {
+        Chunk& chunk = ahead[i];
+        const Piece& piece = pieces[chunk.piece];
+        MemorySegment& segment = *piece.segment;
+        try {
+            // Every worker moves the boundaries it shares with its neighbours the same way
+            if (piece.encoding == Encoding::Text) {
+                if (i > 0 && chunk.begin > 0) chunk.begin = text_chunk_boundary(segment, piece.offset, chunk.begin);
+                if (chunk.end < piece.length) chunk.end = text_chunk_boundary(segment, piece.offset, chunk.end);
+            }
+            size_t length = chunk.end - chunk.begin;
+            const char* data = static_cast<const char*>(segment.data()) + piece.offset + chunk.begin;
+            auto pinned = segment.pin(piece.offset + chunk.begin, length);
+            switch (piece.encoding) {
+                case Encoding::Hex:
+                    chunk.encoded.resize(length * 2);
+                    encode_hex_into(data, length, chunk.encoded.data());
+                    break;
+                case Encoding::Base64:
+                    chunk.encoded.resize(base64_encoded_size(length));
+                    encode_base64_into(data, length, chunk.encoded.data());
+                    break;
+                case Encoding::Text:
+                default:
+                    chunk.encoded = escape_json(data, length);
+            }
+            chunk.truncated = segment.truncated();
+        } catch (...) {
+            std::lock_guard lock(errorMutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+    // `lanes` workers pull chunks in document order
+    std::atomic<size_t> next{0};
+    parallelPool->parallelFor(std::min(parallelLanes, ahead.size()), [&](size_t) {
+        for (size_t i = next++; i < ahead.size(); i = next++) {
+            encode(i);
+        }
+    });
+    if (error) {
+        ahead.clear();
+        std::rethrow_exception(error);
+    }
+}
+
+size_t StreamingResponse::encodeSpan(const Piece& piece, char* out, size_t capacity, size_t& consumed) {
+    const char* data = static_cast<const char*>(piece.segment->data()) + piece.offset + position;
+    size_t remaining = piece.length - position;
+    // No encoding consumes more input bytes than it writes, so this covers the span
+    auto pinned = piece.segment->pin(piece.offset + position, std::min(remaining, capacity));
+    switch (piece.encoding) {
+        case Encoding::Hex: {
+            size_t n = std::min(remaining, capacity / 2);
+            encode_hex_into(data, n, out);
+            consumed = n;
+            return n * 2;
+        }
+        case Encoding::Base64: {
+            // Only the final group of a span may be padded
+            size_t n = std::min(remaining, capacity / 4 * 3);
+            if (n < remaining) n -= n % 3;
+            encode_base64_into(data, n, out);
+            consumed = n;
+            return base64_encoded_size(n);
+        }
+        case Encoding::Text:
+        default:
+            return escape_json_into(data, remaining, out, capacity, consumed);
+    }
+}
+
+size_t StreamingResponse::read(char* out, size_t capacity) {
+    size_t written = 0;
+    if (!pending.empty()) {
+        size_t n = std::min(pending.size(), capacity);
+        std::memcpy(out, pending.data(), n);
+        pending.erase(0, n);
+        written += n;
+    }
+    while (written < capacity && pending.empty() && current < pieces.size()) {
+        const Piece& piece = pieces[current];
+        if (!piece.segment) {
+            size_t n = std::min(piece.literal.size() - position, capacity - written);
+            std::memcpy(out + written, piece.literal.data() + position, n);
+            position += n;
+            written += n;
+            if (position == piece.literal.size()) {
+                ++current;
+                position = 0;
+            }
+            continue;
+        }
+
+        if (parallelPool) {
+            if (ahead.empty()) encodeAhead();
+            Chunk& chunk = ahead.front();
+            if (chunk.truncated) {
+                truncated = true;
+                current = pieces.size();
+                ahead.clear();
+                break;
+            }
+            size_t n = std::min(chunk.encoded.size() - chunk.written, capacity - written);
+            std::memcpy(out + written, chunk.encoded.data() + chunk.written, n);
+            chunk.written += n;
+            written += n;
+            if (chunk.written == chunk.encoded.size()) {
+                position = chunk.end;
+                ahead.pop_front();
+                if (position == piece.length) {
+                    spanBytesDone += piece.length;
+                    ++current;
+                    position = 0;
+                    if (progressCallback) progressCallback(spanBytesDone, spanBytes);
+                }
+            }
+            continue;
+        }
+
+        size_t consumed = 0;
+        size_t n = encodeSpan(piece, out + written, capacity - written, consumed);
+        if (consumed == 0 && position < piece.length) {
+            // Too little room left for the next encoded character: encode it aside and carry over
+            char scratch[8];
+            n = encodeSpan(piece, scratch, sizeof(scratch), consumed);
+            size_t fit = std::min(n, capacity - written);
+            std::memcpy(out + written, scratch, fit);
+            pending.assign(scratch + fit, n - fit);
+            n = fit;
+        }
+        if (piece.segment->truncated()) {
+            // What was just encoded includes zeroed pages
+            pending.clear();
+            truncated = true;
+            current = pieces.size();
+            break;
+        }
+        written += n;
+        position += consumed;
+        if (position == piece.length) {
+            spanBytesDone += piece.length;
+            ++current;
+            position = 0;
+            if (progressCallback) progressCallback(spanBytesDone, spanBytes);
+        }
+    }
+    return written;
+}
+
+bool StreamingResponse::failed() const {
+    return truncated;
+}
+
+std::string StreamingResponse::readAll() {
+    std::string out;
+    char buffer[64 * 1024];
+    while (size_t n = read(buffer, sizeof(buffer))) {
+        out.append(buffer, n);
+    }
+    return out;
+}
+
+std::string StreamingResponse::compact(const Json::Value& value) {
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    return Json::writeString(writer, value);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <json/json.h>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MemorySegment.hpp"
+#include "TaskflowManager.hpp"
+
+// A JSON document assembled from literal JSON text and byte spans of mapped files. Spans are
+// encoded only when the document is read, in chunks bounded by the caller's buffer, so a large
+// read goes from the mapping to stdout or an HTTP body without an intermediate copy. The pieces
+// hold their MemorySegment, keeping the mapping alive even if the handler is closed meanwhile.
+class StreamingResponse {
+public:
+    enum class Encoding { Text, Hex, Base64 };
+
+    // Append literal JSON text
+    void appendRaw(std::string json);
+    // Append a (small) value in compact form
+    void appendValue(const Json::Value& value);
+    // Append `length` bytes at `offset` of the segment as a quoted JSON string in the given encoding
+    void appendString(std::shared_ptr<MemorySegment> segment, size_t offset, size_t length, Encoding encoding);
+
+    // Called with (span bytes emitted, total span bytes) each time a span has been fully written
+    void setProgress(std::function<void(uint64_t, uint64_t)> progress);
+    // Encode spans ahead of the reader on the pool: up to `lanes` chunks at a time, each a bounded
+    // buffer, are encoded together and then emitted in document order. The pool must outlive reads.
+    void setParallel(TaskflowManager& pool, size_t lanes);
+
+    // Write the next bytes of the document into `out`; returns 0 once everything has been read
+    size_t read(char* out, size_t capacity);
+    // Set when reading stopped early because a span's file was truncated under it; the output so
+    // far is an incomplete document and the span bytes that faulted were not written
+    bool failed() const;
+    // Remaining output as one string (small documents and tests)
+    std::string readAll();
+
+    static std::string compact(const Json::Value& value);
+
+private:
+    struct Piece {
+        std::string literal;
+        std::shared_ptr<MemorySegment> segment; // null for literal pieces
+        size_t offset = 0;
+        size_t length = 0;
+        Encoding encoding = Encoding::Text;
+    };
+
+    // Span bytes encoded ahead of the reader
+    struct Chunk {
+        size_t piece = 0;
+        size_t begin = 0; // span bytes, relative to the piece
+        size_t end = 0;
+        std::string encoded;
+        size_t written = 0; // bytes of `encoded` already read
+        bool truncated = false;
+    };
+
+    // Encode as much of the current span as fits; returns bytes written, `consumed` the input used
+    size_t encodeSpan(const Piece& piece, char* out, size_t capacity, size_t& consumed);
+    // Encode the next chunks of span bytes from the current position on the pool
+    void encodeAhead();
+
+    std::vector<Piece> pieces;
+    size_t current = 0;
+    size_t position = 0; // bytes of the current literal written, or span bytes consumed
+    std::string pending; // encoded output that did not fit into the caller's last buffer
+    bool truncated = false;
+    uint64_t spanBytes = 0;
+    uint64_t spanBytesDone = 0;
+    std::function<void(uint64_t, uint64_t)> progressCallback;
+    TaskflowManager* parallelPool = nullptr;
+    size_t parallelLanes = 1;
+    std::deque<Chunk> ahead;
+};
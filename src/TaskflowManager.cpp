@@ -1,7 +1,67 @@
 #include "TaskflowManager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
-TaskflowManager::TaskflowManager() : exec() {}
+#ifdef MCP_FILEOP_HAVE_TASKFLOW
+TaskflowManager::TaskflowManager(size_t workers)
+    : exec(workers == 0 ? std::max<size_t>(1, std::thread::hardware_concurrency()) : workers) {}
 
 tf::Executor& TaskflowManager::executor() {
     return exec;
 }
+
+size_t TaskflowManager::numWorkers() const {
+    return exec.num_workers();
+}
+
+void TaskflowManager::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+    tf::Taskflow flow;
+    flow.for_each_index(size_t(0), count, size_t(1), [&fn](size_t i) { fn(i); });
+    if (exec.this_worker_id() >= 0) {
+        // Already on a worker: cooperatively run instead of blocking the worker
+        exec.corun(flow);
+    } else {
+        exec.run(flow).wait();
+    }
+}
+#else
+TaskflowManager::TaskflowManager(size_t workers)
+    : workerCount(workers == 0 ? std::max<size_t>(1, std::thread::hardware_concurrency()) : workers) {}
+
+size_t TaskflowManager::numWorkers() const {
+    return workerCount;
+}
+
+void TaskflowManager::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard lock(errorMutex);
+                if (!error) error = std::current_exception();
+            }
+        }
+    };
+    size_t threads = std::min(numWorkers(), count);
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : pool) {
+        t.join();
+    }
+    if (error) std::rethrow_exception(error);
+}
+#endif
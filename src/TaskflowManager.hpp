@@ -1,10 +1,26 @@
 #pragma once
+#include <cstddef>
+#include <functional>
+#ifdef MCP_FILEOP_HAVE_TASKFLOW
 #include <taskflow/taskflow.hpp>
+#endif
 
+// Worker pool for parallel scans over mapped files. Uses the Taskflow executor when Taskflow is
+// available at build time and falls back to short-lived std::threads otherwise.
 class TaskflowManager {
 public:
-    TaskflowManager();
+    // workers == 0 uses one worker per hardware thread
+    explicit TaskflowManager(size_t workers = 0);
+#ifdef MCP_FILEOP_HAVE_TASKFLOW
     tf::Executor& executor();
+#endif
+    size_t numWorkers() const;
+    // Run fn(i) for every i in [0, count) across the workers and wait for all of them
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
 private:
+#ifdef MCP_FILEOP_HAVE_TASKFLOW
     tf::Executor exec;
+#else
+    size_t workerCount;
+#endif
 };
@@ -0,0 +1,261 @@
+#include "TrigramIndex.hpp"
+#include "LineUtils.hpp"
+#include "TaskflowManager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+
+namespace {
+
+constexpr uint32_t kTrigramCodes = uint32_t(1) << 24;
+// Entries are counted per bucket of 2^kBucketBits consecutive codes to plan the ranges
+constexpr int kBucketBits = 12;
+// Transient bytes of an entry: its code in a block's run, then its pair and the radix sort buffer
+constexpr size_t kBytesPerEntry = 4 + 8 + 8;
+
+inline uint32_t trigram_at(const char* p) {
+    return ((uint32_t)(unsigned char)p[0] << 16) | ((uint32_t)(unsigned char)p[1] << 8) | (uint32_t)(unsigned char)p[2];
+}
+
+// Distinct trigrams in [lo, hi) starting in [begin, end), unsorted. `seen` has a bit per code of
+// the range and is left cleared again, so only the distinct codes have to be sorted.
+void collect_trigrams(const char* data, size_t begin, size_t end, uint32_t lo, uint32_t hi, std::vector<uint64_t>& seen,
+                      std::vector<uint32_t>& codes) {
+    for (size_t i = begin; i < end; ++i) {
+        uint32_t code = trigram_at(data + i);
+        if (code < lo || code >= hi) continue;
+        uint32_t slot = code - lo;
+        uint64_t bit = uint64_t(1) << (slot & 63);
+        if (!(seen[slot >> 6] & bit)) {
+            seen[slot >> 6] |= bit;
+            codes.push_back(code);
+        }
+    }
+    for (uint32_t code : codes) {
+        seen[(code - lo) >> 6] = 0;
+    }
+}
+
+// Stable LSD radix sort of (trigram << 32 | block) pairs on the 24-bit trigram. Pairs arrive in
+// block order, so the result is ordered by trigram and then block.
+void sort_by_trigram(std::vector<uint64_t>& pairs) {
+    std::vector<uint64_t> buffer(pairs.size());
+    for (int shift = 32; shift < 56; shift += 8) {
+        size_t counts[257] = {};
+        for (uint64_t pair : pairs) ++counts[((pair >> shift) & 0xff) + 1];
+        for (int i = 0; i < 256; ++i) counts[i + 1] += counts[i];
+        for (uint64_t pair : pairs) buffer[counts[(pair >> shift) & 0xff]++] = pair;
+        pairs.swap(buffer);
+    }
+}
+
+void put_varint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+} // namespace
+
+std::shared_ptr<TrigramIndex> TrigramIndex::build(const char* data, size_t size, TaskflowManager* taskflow, size_t memoryBytes) {
+    if (size > kMaxFileBytes || std::memchr(data, 0, std::min(size, kBlockSize)) != nullptr) {
+        return nullptr;
+    }
+    auto started = std::chrono::steady_clock::now();
+    auto index = std::make_shared<TrigramIndex>();
+    index->bytes = size;
+    size_t blocks = (size + kBlockSize - 1) / kBlockSize;
+
+    // Lanes pull blocks in order; each has its own scratch, released when the build ends
+    size_t lanes = taskflow && blocks > 1 && taskflow->numWorkers() > 1 ? std::min(taskflow->numWorkers(), blocks) : 1;
+    auto for_each_block = [&](const std::function<void(size_t, size_t)>& fn) {
+        std::atomic<size_t> next{0};
+        auto run = [&](size_t lane) {
+            for (size_t b = next++; b < blocks; b = next++) fn(lane, b);
+        };
+        if (lanes > 1) {
+            taskflow->parallelFor(lanes, run);
+        } else {
+            run(0);
+        }
+    };
+    // Trigrams of a block include those starting in the first kMaxQueryBytes - 3 bytes of the next
+    auto block_end = [&](size_t b) {
+        return std::min(size - 2, b * kBlockSize + kBlockSize + kMaxQueryBytes - 3);
+    };
+
+    // Sorted runs of the distinct trigrams in [lo, hi) of every block. Gives up, leaving the runs
+    // empty, once they hold more than `limit` entries.
+    std::vector<std::vector<uint32_t>> runs(blocks);
+    auto collect_runs = [&](uint32_t lo, uint32_t hi, size_t limit) {
+        std::vector<std::vector<uint64_t>> seen(lanes);
+        std::atomic<size_t> entries{0};
+        std::atomic<bool> over{false};
+        for_each_block([&](size_t lane, size_t b) {
+            if (over) return;
+            if (seen[lane].empty()) seen[lane].assign((hi - lo + 63) / 64, 0);
+            collect_trigrams(data, b * kBlockSize, block_end(b), lo, hi, seen[lane], runs[b]);
+            std::sort(runs[b].begin(), runs[b].end());
+            if ((entries += runs[b].size()) > limit) over = true;
+        });
+        if (over) {
+            for (auto& run : runs) std::vector<uint32_t>().swap(run);
+        }
+        return !over;
+    };
+
+    // Move the runs into posting lists: the first block number, then the distance to each
+    // following one. Ranges are appended in ascending order.
+    auto append_postings = [&]() {
+        size_t total = 0;
+        for (const auto& run : runs) total += run.size();
+        std::vector<uint64_t> pairs;
+        pairs.reserve(total);
+        for (size_t b = 0; b < blocks; ++b) {
+            for (uint32_t code : runs[b]) pairs.push_back(((uint64_t)code << 32) | b);
+            std::vector<uint32_t>().swap(runs[b]);
+        }
+        sort_by_trigram(pairs);
+        uint32_t previous = 0;
+        for (uint64_t pair : pairs) {
+            uint32_t code = (uint32_t)(pair >> 32);
+            uint32_t block = (uint32_t)pair;
+            if (index->keys.empty() || index->keys.back() != code) {
+                index->keys.push_back(code);
+                index->listOffsets.push_back(index->postings.size());
+                previous = 0;
+            }
+            put_varint(index->postings, block - previous);
+            previous = block;
+        }
+    };
+
+    if (size >= 3) {
+        size_t limit = std::max<size_t>(memoryBytes / kBytesPerEntry, 1);
+        if (collect_runs(0, kTrigramCodes, limit)) {
+            append_postings();
+        } else {
+            // Count the entries of each bucket of codes, then collect runs of bucket ranges that fit
+            std::vector<std::vector<size_t>> counts(lanes, std::vector<size_t>(kTrigramCodes >> kBucketBits));
+            std::vector<std::vector<uint64_t>> seen(lanes);
+            std::vector<std::vector<uint32_t>> codes(lanes);
+            for_each_block([&](size_t lane, size_t b) {
+                if (seen[lane].empty()) seen[lane].assign(kTrigramCodes / 64, 0);
+                codes[lane].clear();
+                collect_trigrams(data, b * kBlockSize, block_end(b), 0, kTrigramCodes, seen[lane], codes[lane]);
+                for (uint32_t code : codes[lane]) ++counts[lane][code >> kBucketBits];
+            });
+            seen.clear();
+            codes.clear();
+            for (size_t lane = 1; lane < lanes; ++lane) {
+                for (size_t bucket = 0; bucket < counts[0].size(); ++bucket) counts[0][bucket] += counts[lane][bucket];
+            }
+            uint32_t lo = 0;
+            size_t entries = 0;
+            for (size_t bucket = 0; bucket < counts[0].size(); ++bucket) {
+                if (entries > 0 && entries + counts[0][bucket] > limit) {
+                    uint32_t hi = (uint32_t)bucket << kBucketBits;
+                    collect_runs(lo, hi, SIZE_MAX);
+                    append_postings();
+                    lo = hi;
+                    entries = 0;
+                }
+                entries += counts[0][bucket];
+            }
+            collect_runs(lo, kTrigramCodes, SIZE_MAX);
+            append_postings();
+        }
+    }
+    index->listOffsets.push_back(index->postings.size());
+    index->keys.shrink_to_fit();
+    index->listOffsets.shrink_to_fit();
+    index->postings.shrink_to_fit();
+
+    index->blockLines.reserve(blocks);
+    index->blockLineStarts.reserve(blocks);
+    size_t line = 0;
+    size_t line_start = 0;
+    for (size_t b = 0; b < blocks; ++b) {
+        line += count_lines_before(data, size, line_start, b * kBlockSize, line_start);
+        index->blockLines.push_back(line);
+        index->blockLineStarts.push_back(line_start);
+    }
+    index->millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return index;
+}
+
+void TrigramIndex::decode(size_t key, std::vector<uint32_t>& blocks) const {
+    blocks.clear();
+    uint32_t block = 0;
+    for (size_t i = listOffsets[key]; i < listOffsets[key + 1];) {
+        uint32_t delta = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            byte = postings[i++];
+            delta |= (uint32_t)(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        block += delta;
+        blocks.push_back(block);
+    }
+}
+
+bool TrigramIndex::candidateBlocks(const char* pattern, size_t pattern_len, std::vector<uint32_t>& blocks) const {
+    blocks.clear();
+    if (pattern_len < 3) {
+        return false;
+    }
+    size_t query_len = std::min(pattern_len, kMaxQueryBytes);
+    std::vector<size_t> lists;
+    for (size_t i = 0; i + 3 <= query_len; ++i) {
+        uint32_t code = trigram_at(pattern + i);
+        auto it = std::lower_bound(keys.begin(), keys.end(), code);
+        if (it == keys.end() || *it != code) {
+            return true;
+        }
+        lists.push_back((size_t)(it - keys.begin()));
+    }
+    // Intersect starting from the shortest lists
+    std::sort(lists.begin(), lists.end());
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+    std::sort(lists.begin(), lists.end(), [this](size_t a, size_t b) {
+        return listOffsets[a + 1] - listOffsets[a] < listOffsets[b + 1] - listOffsets[b];
+    });
+    decode(lists[0], blocks);
+    std::vector<uint32_t> other;
+    std::vector<uint32_t> both;
+    for (size_t k = 1; k < lists.size() && !blocks.empty(); ++k) {
+        decode(lists[k], other);
+        both.clear();
+        std::set_intersection(blocks.begin(), blocks.end(), other.begin(), other.end(), std::back_inserter(both));
+        blocks.swap(both);
+    }
+    return true;
+}
+
+void TrigramIndex::blockLine(size_t block, size_t& line, size_t& lineStart) const {
+    line = blockLines[block];
+    lineStart = blockLineStarts[block];
+}
+
+size_t TrigramIndex::blockCount() const {
+    return blockLines.size();
+}
+
+size_t TrigramIndex::byteSize() const {
+    return bytes;
+}
+
+size_t TrigramIndex::memoryBytes() const {
+    return keys.size() * sizeof(uint32_t) + listOffsets.size() * sizeof(uint64_t) + postings.size()
+        + (blockLines.size() + blockLineStarts.size()) * sizeof(uint64_t);
+}
+
+double TrigramIndex::buildMillis() const {
+    return millis;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class TaskflowManager;
+
+// Trigram posting lists over fixed-size blocks of a mapped file. Each distinct 3-byte sequence
+// maps to the blocks it occurs in, stored as varint-encoded deltas, so a literal search only has
+// to verify the blocks that contain every trigram of the pattern. Each block also records the
+// line it starts in, so matches can be numbered without counting lines from the start of the file.
+class TrigramIndex {
+public:
+    static constexpr size_t kBlockSize = 64 * 1024;
+    // Trigrams starting up to this far into the next block are recorded for a block as well, so a
+    // match starting in the block is covered as long as queries use at most this many pattern bytes
+    static constexpr size_t kMaxQueryBytes = 256;
+    // Larger files, and files with a NUL byte in their first block (binary), are not indexed
+    static constexpr size_t kMaxFileBytes = 256 * 1024 * 1024;
+    // Transient memory a build may use for its (trigram, block) entries. When they do not fit, the
+    // trigram codes are split into ranges that do, and the file is scanned once per range.
+    static constexpr size_t kBuildMemoryBytes = 128 * 1024 * 1024;
+
+    // Build the index, or return nullptr for a file that is not indexed; with a TaskflowManager the
+    // blocks' trigrams are collected in parallel
+    static std::shared_ptr<TrigramIndex> build(const char* data, size_t size, TaskflowManager* taskflow = nullptr,
+                                               size_t memoryBytes = kBuildMemoryBytes);
+
+    // Blocks that may contain the start of an occurrence of `pattern`, ascending. Returns false
+    // when the pattern is shorter than a trigram and the index cannot narrow the search.
+    bool candidateBlocks(const char* pattern, size_t pattern_len, std::vector<uint32_t>& blocks) const;
+    // Zero-based line containing the first byte of `block`, and that line's start
+    void blockLine(size_t block, size_t& line, size_t& lineStart) const;
+
+    size_t blockCount() const;
+    // Size in bytes of the mapping this index was built from
+    size_t byteSize() const;
+    // Memory used by keys, list offsets, postings and line checkpoints
+    size_t memoryBytes() const;
+    double buildMillis() const;
+
+private:
+    // Decode the posting list of key number `key`
+    void decode(size_t key, std::vector<uint32_t>& blocks) const;
+
+    std::vector<uint32_t> keys;        // sorted trigram codes
+    std::vector<uint64_t> listOffsets; // keys.size() + 1 offsets into postings
+    std::vector<uint8_t> postings;
+    std::vector<uint64_t> blockLines;
+    std::vector<uint64_t> blockLineStarts;
+    size_t bytes = 0;
+    double millis = 0.0;
+};
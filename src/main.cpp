@@ -6,6 +6,7 @@
 #include <filesystem>
 #include "SegmentRegistry.hpp"
 #include "TaskflowManager.hpp"
+#include "Encoding.hpp"
 
 // 'lines' helper code moved to LineUtils.hpp so it can be shared across modules
 #include "LineUtils.hpp"
@@ -31,11 +32,13 @@ void handleMcpRequest(const drogon::HttpRequestPtr& req, std::function<void(cons
     if (op == "preload") {
         std::string path = (*json)["params"]["path"].asString();
         try {
-            auto segment = registry.preload(path);
+            std::string handle;
+            auto segment = registry.preload(path, &handle);
             if (segment) {
                 // Use canonical path as handler
                 std::filesystem::path canonical_path = std::filesystem::canonical(path);
                 response["handler"] = canonical_path.string();
+                response["handle"] = handle;
                 // broadcaster.broadcast("preload_success", path);
             } else {
                 response["error"]["code"] = "preload_failed";
@@ -59,15 +62,14 @@ void handleMcpRequest(const drogon::HttpRequestPtr& req, std::function<void(cons
                 response["error"]["code"] = "read_failed";
                 response["error"]["message"] = "Read out of bounds";
             } else {
+                response["version"] = (Json::Value::Int64)segment->version();
                 const char* data = static_cast<const char*>(segment->data()) + offset;
+                auto pinned = format == "lines" ? segment->pin(0, segment->size()) : segment->pin(offset, size);
                 if (format == "binary") {
-                    response["data"] = std::string(data, size);
+                    response["data"] = encode_base64(data, size);
+                    response["encoding"] = "base64";
                 } else if (format == "hex") {
-                    std::stringstream ss;
-                    for (size_t i = 0; i < size; ++i) {
-                        ss << std::hex << std::setw(2) << std::setfill('0') << (unsigned int)(unsigned char)data[i];
-                    }
-                    response["data"] = ss.str();
+                    response["data"] = encode_hex(data, size);
                 } else if (format == "text") {
                     response["data"] = std::string(data, size);
                 } else if (format == "lines") {
@@ -82,6 +84,12 @@ void handleMcpRequest(const drogon::HttpRequestPtr& req, std::function<void(cons
                     response["error"]["code"] = "read_failed";
                     response["error"]["message"] = "Invalid format";
                 }
+                if (segment->truncated()) {
+                    // The bytes read include zeroed pages past the new end of the file
+                    response.removeMember("data");
+                    response["error"]["code"] = "read_failed";
+                    response["error"]["message"] = "File was truncated while being read";
+                }
             }
         } catch (const std::exception& e) {
             response["error"]["code"] = "read_error";
@@ -119,6 +127,7 @@ void handleEvents(const drogon::HttpRequestPtr& req, std::function<void(const dr
 
 int main() {
     using namespace drogon;
+    registry.setTaskflowManager(&taskflow);
     app().registerHandler("/mcp", [](const HttpRequestPtr& req, std::function<void (const HttpResponsePtr &)> &&callback) {
         handleMcpRequest(req, std::move(callback));
     }, {Post});
@@ -17,6 +17,21 @@ inline Json::Value createError(const Json::Value& id, int code, const std::strin
     return controller.createError(id, code, message);
 }
 
+// Write a streamed response as one line, in bounded chunks straight from the file mapping. If a
+// file is truncated under it, the line ends early and an error for `id` follows on its own line.
+void writeStreamingResponse(const Json::Value& id, StreamingResponse& response) {
+    static char buffer[64 * 1024];
+    while (size_t n = response.read(buffer, sizeof(buffer))) {
+        std::cout.write(buffer, n);
+    }
+    std::cout << std::endl;
+    if (response.failed()) {
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        std::cout << Json::writeString(writer, createError(id, -32000, "File was truncated while being read")) << std::endl;
+    }
+}
+
 void handleInitialize(const Json::Value& id) {
     Json::Value result;
     result["protocolVersion"] = "2024-11-05";
@@ -41,18 +56,7 @@ void handleListResources(const Json::Value& id) {
 }
 
 void handleReadResource(const Json::Value& id, const Json::Value& params) {
-    Json::Value result = controller.readResourceFromUri(params);
-    if (result.isMember("__error__")) {
-        Json::Value response = createError(id, -32000, result["__error__"].asString());
-        Json::StreamWriterBuilder writer;
-        writer["indentation"] = "";
-        std::cout << Json::writeString(writer, response) << std::endl;
-        return;
-    }
-    Json::Value response = createResponse(id, result);
-    Json::StreamWriterBuilder writer;
-    writer["indentation"] = "";
-    std::cout << Json::writeString(writer, response) << std::endl;
+    writeStreamingResponse(id, *controller.streamResource(id, params));
 }
 
 void handleListTools(const Json::Value& id) {
@@ -77,6 +81,11 @@ void handleCallTool(const Json::Value& id, const Json::Value& params) {
     auto progressCallback = [](const Json::Value&) {
         // stdio doesn't emit progress updates
     };
+    // Reads are serialized directly from the mapping; other operations return small results
+    if (auto stream = controller.streamTool(id, params, progressCallback)) {
+        writeStreamingResponse(id, *stream);
+        return;
+    }
     Json::Value result = controller.callTool(params, progressCallback);
     if (result.isMember("__error__")) {
         Json::Value response = createError(id, -32000, result["__error__"].asString());
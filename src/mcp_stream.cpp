@@ -48,13 +48,8 @@ void handleListResources(const Json::Value& id, std::function<void(const Json::V
 }
 
 // Handle read resource
-void handleReadResource(const Json::Value& id, const Json::Value& params, std::function<void(const Json::Value&)> sendResponse) {
-    Json::Value result = controller.readResourceFromUri(params);
-    if (result.isMember("__error__")) {
-        sendResponse(createError(id, -32000, result["__error__"].asString()));
-        return;
-    }
-    sendResponse(createResponse(id, result));
+void handleReadResource(const Json::Value& id, const Json::Value& params, std::function<void(std::shared_ptr<StreamingResponse>)> sendStream) {
+    sendStream(controller.streamResource(id, params));
 }
 
 // Handle list tools
@@ -64,11 +59,16 @@ void handleListTools(const Json::Value& id, std::function<void(const Json::Value
 }
 
 // Handle tool calls
-void handleCallTool(const Json::Value& id, const Json::Value& params, std::function<void(const Json::Value&)> sendResponse, std::function<void(const Json::Value&)> sendProgress) {
+void handleCallTool(const Json::Value& id, const Json::Value& params, std::function<void(const Json::Value&)> sendResponse, std::function<void(std::shared_ptr<StreamingResponse>)> sendStream, std::function<void(const Json::Value&)> sendProgress) {
     // Forward to controller with a progress callback that uses the stream's progress sender.
     auto progressCb = [sendProgress](const Json::Value& p) {
         if (sendProgress) sendProgress(p);
     };
+    // Reads are serialized into the HTTP body directly from the mapping
+    if (auto stream = controller.streamTool(id, params, progressCb)) {
+        sendStream(stream);
+        return;
+    }
     Json::Value result = controller.callTool(params, progressCb);
     if (result.isMember("__error__")) {
         sendResponse(createError(id, -32000, result["__error__"].asString()));
@@ -101,6 +101,21 @@ void handleMcpRequest(const drogon::HttpRequestPtr& req,
         callback(resp);
     };
     
+    // Large bodies are produced chunk by chunk as Drogon drains the connection
+    auto sendStream = [callback](std::shared_ptr<StreamingResponse> stream) {
+        auto resp = drogon::HttpResponse::newStreamResponse(
+            [stream](char* buffer, std::size_t len) -> std::size_t {
+                // Drogon passes a null buffer when the connection is gone. A file truncated under
+                // the stream ends the body early, leaving the JSON incomplete.
+                if (!buffer) return 0;
+                return stream->read(buffer, len);
+            },
+            "",
+            drogon::CT_APPLICATION_JSON
+        );
+        callback(resp);
+    };
+    
     auto sendProgress = [](const Json::Value& progress) {
         // For non-streaming HTTP, we can't send intermediate progress
         // Progress would be sent via SSE in a real streaming scenario
@@ -111,11 +126,11 @@ void handleMcpRequest(const drogon::HttpRequestPtr& req,
     } else if (method == "tools/list") {
         handleListTools(id, sendResponse);
     } else if (method == "tools/call") {
-        handleCallTool(id, params, sendResponse, sendProgress);
+        handleCallTool(id, params, sendResponse, sendStream, sendProgress);
     } else if (method == "resources/list") {
         handleListResources(id, sendResponse);
     } else if (method == "resources/read") {
-        handleReadResource(id, params, sendResponse);
+        handleReadResource(id, params, sendStream);
     } else if (method == "notifications/initialized") {
         // No response for notifications
         auto resp = drogon::HttpResponse::newHttpResponse();
@@ -196,6 +211,25 @@ int main() {
                 } else {
                     std::cout << "No 'allowed_paths' key in mcp config" << std::endl;
                 }
+
+                if (mcpConfig.isMember("read_concurrency")) {
+                    size_t concurrency = mcpConfig["read_concurrency"].asUInt();
+                    controller.setReadConcurrency(concurrency);
+                    std::cout << "Configured read_multiple concurrency: " << concurrency << std::endl;
+                }
+
+                if (mcpConfig.isMember("decompressed_cache_mb")) {
+                    size_t megabytes = mcpConfig["decompressed_cache_mb"].asUInt64();
+                    MemorySegment::setDecompressedCacheLimit(megabytes * 1024 * 1024);
+                    std::cout << "Configured decompressed block cache: " << megabytes << " MiB per segment" << std::endl;
+                }
+
+                if (mcpConfig.isMember("max_mapped_mb") || mcpConfig.isMember("max_mapped_handlers")) {
+                    size_t megabytes = mcpConfig.get("max_mapped_mb", 0).asUInt64();
+                    size_t handlers = mcpConfig.get("max_mapped_handlers", 0).asUInt64();
+                    controller.setMemoryBudget(megabytes * 1024 * 1024, handlers);
+                    std::cout << "Configured mapping budget: " << megabytes << " MiB, " << handlers << " handler(s) (0 = no limit)" << std::endl;
+                }
             } else {
                 std::cout << "No 'mcp' section in config" << std::endl;
             }
@@ -0,0 +1,50 @@
+// Benchmark: SIMD/table hex encoder vs. the stringstream loop it replaced.
+// Usage: bench_hex_encode [size_in_bytes] [iterations]
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include "../src/Encoding.hpp"
+
+static std::string stringstream_hex(const char* data, size_t size) {
+    std::stringstream ss;
+    for (size_t i = 0; i < size; ++i) {
+        ss << std::hex << std::setw(2) << std::setfill('0') << (unsigned int)(unsigned char)data[i];
+    }
+    return ss.str();
+}
+
+template <typename Fn>
+static double measure_mbps(Fn&& fn, size_t size, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (int i = 0; i < iterations; ++i) {
+        sink += fn().size();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 0) std::cerr << "";
+    return (double)size * iterations / (1024.0 * 1024.0) / seconds;
+}
+
+int main(int argc, char** argv) {
+    size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4 * 1024 * 1024;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::string input(size, '\0');
+    std::mt19937 rng(1);
+    for (auto& c : input) c = (char)(rng() & 0xff);
+
+    if (encode_hex(input.data(), input.size()) != stringstream_hex(input.data(), input.size())) {
+        std::cerr << "Output mismatch" << std::endl;
+        return 1;
+    }
+    double before = measure_mbps([&] { return stringstream_hex(input.data(), input.size()); }, size, iterations);
+    double after = measure_mbps([&] { return encode_hex(input.data(), input.size()); }, size, iterations);
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "input: " << size << " bytes x " << iterations << " iterations" << std::endl;
+    std::cout << "stringstream: " << before << " MB/s" << std::endl;
+    std::cout << "encode_hex:   " << after << " MB/s (" << after / before << "x)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Benchmark: SegmentRegistry::getByHandler under concurrent readers, against the registry-wide
+// shared_mutex lookup it replaced, with a writer preloading and closing a file throughout. Lookups
+// by path and by the compact handle preload returns are measured separately.
+// Usage: bench_registry_lookup [max_threads] [milliseconds_per_run]
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../src/SegmentRegistry.hpp"
+
+// The previous lookup: one shared_mutex around the handler map
+struct LockedTable {
+    std::unordered_map<std::string, std::weak_ptr<MemorySegment>> handlers;
+    mutable std::shared_mutex mutex;
+
+    std::shared_ptr<MemorySegment> get(const std::string& handler) const {
+        std::shared_lock lock(mutex);
+        auto it = handlers.find(handler);
+        return it != handlers.end() ? it->second.lock() : nullptr;
+    }
+    void put(const std::string& handler, const std::shared_ptr<MemorySegment>& segment) {
+        std::unique_lock lock(mutex);
+        handlers[handler] = segment;
+    }
+    void remove(const std::string& handler) {
+        std::unique_lock lock(mutex);
+        handlers.erase(handler);
+    }
+};
+
+// Lookups per second over `threads` readers. With `shared`, every reader asks for the same
+// handler; otherwise each reader has its own. `write` runs on another thread until the readers stop.
+static double measure(size_t threads, int milliseconds, const std::vector<std::string>& handlers, bool shared,
+                      const std::function<std::shared_ptr<MemorySegment>(const std::string&)>& get, const std::function<void()>& write) {
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> total{0};
+    std::thread writer([&] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            write();
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < threads; ++t) {
+        readers.emplace_back([&, t] {
+            const std::string& handler = handlers[shared ? 0 : t % handlers.size()];
+            uint64_t count = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 256; ++i) {
+                    if (!get(handler)) std::abort();
+                }
+                count += 256;
+            }
+            total += count;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+    stop = true;
+    for (auto& r : readers) r.join();
+    writer.join();
+    return (double)total.load() / (milliseconds / 1000.0);
+}
+
+int main(int argc, char** argv) {
+    size_t max_threads = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::max(1u, std::thread::hardware_concurrency());
+    int milliseconds = argc > 2 ? std::atoi(argv[2]) : 500;
+
+    auto dir = std::filesystem::temp_directory_path() / "mcp_bench_registry";
+    std::filesystem::create_directories(dir);
+    std::vector<std::string> handlers;
+    std::vector<std::string> handles;
+    for (size_t i = 0; i < std::max<size_t>(max_threads, 64); ++i) {
+        auto path = dir / ("a_fairly_long_directory_name_like_real_projects_have/file_" + std::to_string(i) + ".log");
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path) << "line " << i << "\n";
+        handlers.push_back(std::filesystem::canonical(path).string());
+    }
+    auto churn = dir / "churn.log";
+    std::ofstream(churn) << "churn\n";
+    std::string churn_handler = std::filesystem::canonical(churn).string();
+
+    SegmentRegistry registry;
+    LockedTable locked;
+    for (const auto& h : handlers) {
+        std::string handle;
+        auto segment = registry.preload(h, &handle);
+        locked.put(h, segment);
+        handles.push_back(handle);
+    }
+    std::shared_ptr<MemorySegment> churn_segment = registry.preload(churn_handler);
+    auto registry_write = [&] {
+        registry.close(churn_handler);
+        registry.preload(churn_handler);
+    };
+    auto locked_write = [&] {
+        locked.remove(churn_handler);
+        locked.put(churn_handler, churn_segment);
+    };
+    auto registry_get = [&](const std::string& h) { return registry.getByHandler(h); };
+    auto locked_get = [&](const std::string& h) { return locked.get(h); };
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "lookups per second (millions), writer preloading/closing every 200 us" << std::endl;
+    std::cout << "threads  shared_mutex  snapshot  handle  | same handler: shared_mutex  snapshot  handle" << std::endl;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double before = measure(threads, milliseconds, handlers, false, locked_get, locked_write);
+        double after = measure(threads, milliseconds, handlers, false, registry_get, registry_write);
+        double after_handle = measure(threads, milliseconds, handles, false, registry_get, registry_write);
+        double before_shared = measure(threads, milliseconds, handlers, true, locked_get, locked_write);
+        double after_shared = measure(threads, milliseconds, handlers, true, registry_get, registry_write);
+        double after_handle_shared = measure(threads, milliseconds, handles, true, registry_get, registry_write);
+        std::cout << std::setw(7) << threads << std::setw(14) << before / 1e6 << std::setw(10) << after / 1e6 << std::setw(8) << after_handle / 1e6
+                  << "  |" << std::setw(27) << before_shared / 1e6 << std::setw(10) << after_shared / 1e6 << std::setw(8) << after_handle_shared / 1e6 << std::endl;
+        if (threads * 2 > max_threads && threads != max_threads) threads = max_threads / 2;
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+}
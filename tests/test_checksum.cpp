@@ -0,0 +1,107 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <json/json.h>
+#include "../src/Checksum.hpp"
+#include "../src/FileOpController.hpp"
+#include "../src/TaskflowManager.hpp"
+
+#define ASSERT_TRUE(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << " at " << __FILE__ << ":" << __LINE__ << std::endl; return 1; }
+
+// Bit-at-a-time CRC32C
+static uint32_t reference_crc32c(const std::string& s) {
+    uint32_t crc = 0xffffffff;
+    for (unsigned char c : s) {
+        crc ^= c;
+        for (int k = 0; k < 8; ++k) crc = (crc & 1) ? (crc >> 1) ^ 0x82f63b78 : crc >> 1;
+    }
+    return ~crc;
+}
+
+int main() {
+    try {
+        // RFC 3720 test vectors
+        ASSERT_TRUE(crc32c("123456789", 9) == 0xe3069283);
+        ASSERT_TRUE(crc32c("", 0) == 0);
+        ASSERT_TRUE(crc32c(std::string(32, '\0').data(), 32) == 0x8a9136aa);
+        ASSERT_TRUE(crc32c(std::string(32, '\xff').data(), 32) == 0x62a8ab43);
+
+        // Lengths around the interleaved run sizes, piecewise hashing and combining
+        std::mt19937 rng(4242);
+        for (size_t len : {1, 7, 8, 255, 768, 769, 8191, 24576, 24577, 30000, 100003}) {
+            std::string s(len, '\0');
+            for (auto& c : s) c = (char)rng();
+            uint32_t expected = reference_crc32c(s);
+            ASSERT_TRUE(crc32c(s.data(), s.size()) == expected);
+            size_t split = rng() % (len + 1);
+            uint32_t a = crc32c(s.data(), split);
+            uint32_t b = crc32c(s.data() + split, len - split);
+            ASSERT_TRUE(crc32c(s.data() + split, len - split, a) == expected);
+            ASSERT_TRUE(crc32c_combine(a, b, len - split) == expected);
+        }
+
+        // Parallel chunks combine to the serial checksum
+        std::string big(3 * kChecksumChunkSize + 12345, '\0');
+        for (auto& c : big) c = (char)rng();
+        TaskflowManager taskflow(4);
+        ASSERT_TRUE(crc32c_parallel(big.data(), big.size(), &taskflow) == crc32c(big.data(), big.size()));
+        ASSERT_TRUE(crc32c_parallel(big.data(), big.size(), nullptr) == crc32c(big.data(), big.size()));
+
+        // checksum operation: whole file, range, cache, modification and bounds
+        FileOpController controller;
+        auto path = std::filesystem::temp_directory_path() / "mcp_checksum.bin";
+        std::ofstream(path, std::ios::binary) << big;
+        std::string handler = std::filesystem::canonical(path).string();
+        Json::Value preload; preload["name"] = "preload"; preload["arguments"]["path"] = path.string();
+        ASSERT_TRUE(!controller.callTool(preload).isMember("__error__"));
+
+        Json::Value call;
+        call["name"] = "fileop";
+        call["arguments"]["operation"] = "checksum";
+        call["arguments"]["handler"] = handler;
+        char expected[9];
+        std::snprintf(expected, sizeof(expected), "%08x", crc32c(big.data(), big.size()));
+        Json::Value first = controller.callTool(call);
+        ASSERT_TRUE(first["checksum"].asString() == expected);
+        ASSERT_TRUE(first["algorithm"].asString() == "crc32c" && !first["cached"].asBool());
+        ASSERT_TRUE(first["size"].asUInt64() == big.size());
+        Json::Value second = controller.callTool(call);
+        ASSERT_TRUE(second["checksum"].asString() == expected && second["cached"].asBool());
+
+        Json::Value range = call;
+        range["arguments"]["offset"] = (Json::UInt64)1000;
+        range["arguments"]["size"] = (Json::UInt64)5000;
+        std::snprintf(expected, sizeof(expected), "%08x", crc32c(big.data() + 1000, 5000));
+        ASSERT_TRUE(controller.callTool(range)["checksum"].asString() == expected);
+
+        // Rewriting a byte in place changes the file version, so the cached value is not reused
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        big[1500] ^= 1;
+        {
+            std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+            f.seekp(1500);
+            f.put(big[1500]);
+        }
+        Json::Value changed = controller.callTool(range);
+        std::snprintf(expected, sizeof(expected), "%08x", crc32c(big.data() + 1000, 5000));
+        ASSERT_TRUE(!changed["cached"].asBool() && changed["checksum"].asString() == expected);
+
+        Json::Value out = call;
+        out["arguments"]["offset"] = (Json::UInt64)big.size();
+        out["arguments"]["size"] = (Json::UInt64)1;
+        ASSERT_TRUE(controller.callTool(out).isMember("__error__"));
+        Json::Value bad = call;
+        bad["arguments"]["handler"] = "/no/such/handler";
+        ASSERT_TRUE(controller.callTool(bad).isMember("__error__"));
+        std::filesystem::remove(path);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All checksum tests passed" << std::endl;
+    return 0;
+}
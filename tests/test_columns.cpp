@@ -0,0 +1,153 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <json/json.h>
+#include "../src/Columns.hpp"
+#include "../src/FileOpController.hpp"
+#include "../src/StreamingResponse.hpp"
+#include "../src/LineUtils.hpp"
+
+#define ASSERT_TRUE(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << " at " << __FILE__ << ":" << __LINE__ << std::endl; return 1; }
+
+// Byte-at-a-time projection: split lines at terminators, fields at delimiters outside quotes
+static std::string reference_projection(const std::string& s, const ColumnSpec& spec) {
+    std::string out;
+    size_t pos = 0;
+    while (pos < s.size()) {
+        std::vector<std::string> fields(1);
+        bool quoted = false;
+        size_t i = pos;
+        for (; i < s.size() && s[i] != '\n' && s[i] != '\r'; ++i) {
+            if (spec.quote >= 0 && (unsigned char)s[i] == spec.quote) quoted = !quoted;
+            if (s[i] == spec.delimiter && !quoted) fields.emplace_back();
+            else fields.back() += s[i];
+        }
+        for (size_t k = 0; k < spec.columns.size(); ++k) {
+            if (k > 0) out += spec.delimiter;
+            if (spec.columns[k] < fields.size()) out += fields[spec.columns[k]];
+        }
+        out += '\n';
+        pos = i;
+        if (pos < s.size()) {
+            char c = s[pos++];
+            if (pos < s.size() && (s[pos] == '\n' || s[pos] == '\r') && s[pos] != c) ++pos;
+        }
+    }
+    return out;
+}
+
+static Json::Value columns_read(FileOpController& controller, const std::string& handler, Json::Value offset, size_t size, const Json::Value& columns) {
+    Json::Value call;
+    call["name"] = "fileop";
+    call["arguments"]["operation"] = "read";
+    call["arguments"]["handler"] = handler;
+    call["arguments"]["offset"] = offset;
+    call["arguments"]["size"] = (Json::Value::UInt64)size;
+    call["arguments"]["format"] = "columns";
+    call["arguments"]["columns"] = columns;
+    return controller.callTool(call);
+}
+
+int main() {
+    try {
+        // Random rows with quoted fields, doubled quotes, quoted delimiters and long fields crossing
+        // 64-byte blocks, under every delimiter/quote setting
+        std::mt19937 rng(4242);
+        const char* terminators[] = {"\n", "\r", "\r\n", "\n\r"};
+        for (int round = 0; round < 300; ++round) {
+            ColumnSpec spec;
+            spec.delimiter = round % 3 == 0 ? '\t' : ',';
+            spec.quote = round % 5 == 0 ? -1 : (round % 7 == 0 ? '\'' : '"');
+            char q = spec.quote < 0 ? '"' : (char)spec.quote;
+            std::string s;
+            size_t rows = rng() % 40;
+            for (size_t r = 0; r < rows; ++r) {
+                size_t fields = rng() % 12;
+                for (size_t f = 0; f < fields; ++f) {
+                    if (f > 0) s += spec.delimiter;
+                    switch (rng() % 5) {
+                        case 0: s += std::string(1, q) + "a" + spec.delimiter + "b" + q + q + "c" + q; break;
+                        case 1: s += std::string(rng() % 150, 'x'); break;
+                        case 2: break;
+                        default: s += "v" + std::to_string(rng() % 1000);
+                    }
+                }
+                if (r + 1 < rows || rng() % 2) s += terminators[rng() % 4];
+            }
+            size_t count = 1 + rng() % 4;
+            for (size_t k = 0; k < count; ++k) spec.columns.push_back(rng() % 14);
+            std::string out;
+            project_columns(s.data(), 0, s.size(), spec, out);
+            ASSERT_TRUE(out == reference_projection(s, spec));
+        }
+
+        // 'columns' reads use 'lines' ranges, including end-relative ones
+        std::string csv = "id,name,city,score\n";
+        for (int i = 0; i < 20000; ++i) {
+            csv += std::to_string(i) + ",\"Name, " + std::to_string(i) + "\",City" + std::to_string(i % 7) + "," + std::to_string(i * 3) + "\r\n";
+        }
+        auto path = std::filesystem::temp_directory_path() / "mcp_columns.csv";
+        std::ofstream(path, std::ios::binary) << csv;
+        std::string handler = std::filesystem::canonical(path).string();
+        FileOpController controller;
+        Json::Value preload;
+        preload["name"] = "preload";
+        preload["arguments"]["path"] = path.string();
+        ASSERT_TRUE(!controller.callTool(preload).isMember("__error__"));
+
+        Json::Value columns(Json::arrayValue);
+        columns.append(3);
+        columns.append(1);
+        Json::Value res = columns_read(controller, handler, (Json::Value::UInt64)15001, 2, columns);
+        ASSERT_TRUE(res["content"][0]["format"].asString() == "columns");
+        ASSERT_TRUE(res["content"][0]["text"].asString() == "45000,\"Name, 15000\"\n45003,\"Name, 15001\"\n");
+        res = columns_read(controller, handler, (Json::Value::Int64)-1, 1, columns);
+        ASSERT_TRUE(res["content"][0]["text"].asString() == "59997,\"Name, 19999\"\n");
+        ASSERT_TRUE(columns_read(controller, handler, (Json::Value::UInt64)30000, 1, columns).isMember("__error__"));
+        ASSERT_TRUE(columns_read(controller, handler, (Json::Value::UInt64)0, 1, Json::Value(Json::arrayValue)).isMember("__error__"));
+
+        // Streamed reads return the same document
+        Json::Value params;
+        params["name"] = "fileop";
+        params["arguments"]["operation"] = "read";
+        params["arguments"]["handler"] = handler;
+        params["arguments"]["offset"] = 0;
+        params["arguments"]["size"] = 500;
+        params["arguments"]["format"] = "columns";
+        params["arguments"]["columns"] = columns;
+        params["arguments"]["delimiter"] = ",";
+        auto stream = controller.streamTool(Json::Value(1), params);
+        std::string body;
+        std::vector<char> buffer(4096);
+        while (size_t n = stream->read(buffer.data(), buffer.size())) body.append(buffer.data(), n);
+        Json::Value streamed;
+        std::istringstream(body) >> streamed;
+        Json::Value direct = controller.callTool(params);
+        ASSERT_TRUE(streamed["result"]["content"] == direct["content"]);
+        std::filesystem::remove(path);
+
+        // Invalid UTF-8 in streamed fields becomes U+FFFD, as in streamed text
+        auto latin1 = std::filesystem::temp_directory_path() / "mcp_columns_latin1.csv";
+        std::ofstream(latin1, std::ios::binary) << "1,caf\xe9,\"q\\\"\n";
+        preload["arguments"]["path"] = latin1.string();
+        ASSERT_TRUE(!controller.callTool(preload).isMember("__error__"));
+        params["arguments"]["handler"] = std::filesystem::canonical(latin1).string();
+        params["arguments"]["columns"][0] = 1;
+        params["arguments"]["columns"][1] = 2;
+        params["arguments"]["quote"] = "";
+        body = controller.streamTool(Json::Value(1), params)->readAll();
+        ASSERT_TRUE(body.find("caf\\ufffd,\\\"q\\\\\\\"\\n") != std::string::npos);
+        std::istringstream(body) >> streamed;
+        ASSERT_TRUE(streamed["result"]["content"][0]["text"].asString() == "caf\xef\xbf\xbd,\"q\\\"\n");
+        std::filesystem::remove(latin1);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All columns tests passed" << std::endl;
+    return 0;
+}
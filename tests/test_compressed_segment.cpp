@@ -0,0 +1,204 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <json/json.h>
+#include "../src/FileOpController.hpp"
+#include "../src/SegmentRegistry.hpp"
+#include "../src/StreamingResponse.hpp"
+#include "../src/Decompressor.hpp"
+#include "../src/LineUtils.hpp"
+#ifdef MCP_FILEOP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef MCP_FILEOP_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#define ASSERT_TRUE(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << " at " << __FILE__ << ":" << __LINE__ << std::endl; return 1; }
+
+#ifdef MCP_FILEOP_HAVE_ZLIB
+// One gzip member holding `text`
+static std::string gzip_member(const std::string& text) {
+    z_stream strm{};
+    deflateInit2(&strm, 6, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&strm, text.size()), '\0');
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    strm.avail_in = (uInt)text.size();
+    strm.next_out = reinterpret_cast<Bytef*>(out.data());
+    strm.avail_out = (uInt)out.size();
+    deflate(&strm, Z_FINISH);
+    out.resize(strm.total_out);
+    deflateEnd(&strm);
+    return out;
+}
+
+#ifdef MCP_FILEOP_HAVE_ZSTD
+// One zstd frame; without `sized` the header does not record the content size
+static std::string zstd_frame(const std::string& text, bool sized) {
+    ZSTD_CCtx* ctx = ZSTD_createCCtx();
+    ZSTD_CCtx_setParameter(ctx, ZSTD_c_contentSizeFlag, sized ? 1 : 0);
+    std::string out(ZSTD_compressBound(text.size()), '\0');
+    ZSTD_outBuffer output = {out.data(), out.size(), 0};
+    ZSTD_inBuffer input = {text.data(), text.size(), 0};
+    ZSTD_compressStream2(ctx, &output, &input, ZSTD_e_end);
+    out.resize(output.pos);
+    ZSTD_freeCCtx(ctx);
+    return out;
+}
+#endif
+
+static Json::Value read_range(FileOpController& controller, const std::string& handler, const std::string& format, Json::Value offset, size_t size) {
+    Json::Value call;
+    call["name"] = "fileop";
+    call["arguments"]["operation"] = "read";
+    call["arguments"]["handler"] = handler;
+    call["arguments"]["offset"] = offset;
+    call["arguments"]["size"] = (Json::Value::UInt64)size;
+    call["arguments"]["format"] = format;
+    return controller.callTool(call);
+}
+#endif
+
+int main() {
+#ifdef MCP_FILEOP_HAVE_ZLIB
+    try {
+        std::mt19937 rng(4242);
+        const char* terminators[] = {"\n", "\r", "\r\n", "\n\r"};
+        std::string text;
+        size_t line = 0;
+        while (text.size() < 6 * Decompressor::kGzipSpan) {
+            text += "line " + std::to_string(line++) + " " + std::string(rng() % 120, (char)('a' + rng() % 26));
+            text += terminators[rng() % 4];
+        }
+        text += "unterminated";
+        // Two members, the second starting mid-stream
+        size_t split = 2 * Decompressor::kGzipSpan + 12345;
+        std::string gz = gzip_member(text.substr(0, split)) + gzip_member(text.substr(split));
+
+        auto decompressor = Decompressor::open(gz.data(), gz.size());
+        ASSERT_TRUE(decompressor && std::string(decompressor->format()) == "gzip");
+        ASSERT_TRUE(decompressor->size() == text.size());
+        ASSERT_TRUE(decompressor->blockCount() >= 5);
+        for (size_t b = 0; b < decompressor->blockCount(); ++b) {
+            size_t begin = decompressor->blockOffset(b);
+            std::string block(decompressor->blockOffset(b + 1) - begin, '\0');
+            decompressor->decompressBlock(b, block.data());
+            ASSERT_TRUE(block == text.substr(begin, block.size()));
+            ASSERT_TRUE(decompressor->blockAt(begin) == b || block.empty());
+        }
+        ASSERT_TRUE(Decompressor::open(text.data(), text.size()) == nullptr);
+
+#ifdef MCP_FILEOP_HAVE_ZSTD
+        // Frames with and without a recorded size, separated by a skippable frame
+        std::string zst = zstd_frame(text.substr(0, split), true) + std::string("\x50\x2a\x4d\x18\x03\0\0\0abc", 11) + zstd_frame(text.substr(split), false);
+        auto frames = Decompressor::open(zst.data(), zst.size());
+        ASSERT_TRUE(frames && std::string(frames->format()) == "zstd");
+        ASSERT_TRUE(frames->size() == text.size() && frames->blockCount() == 2 && frames->blockOffset(1) == split);
+        for (size_t b = 0; b < frames->blockCount(); ++b) {
+            std::string block(frames->blockOffset(b + 1) - frames->blockOffset(b), '\0');
+            frames->decompressBlock(b, block.data());
+            ASSERT_TRUE(block == text.substr(frames->blockOffset(b), block.size()));
+        }
+#endif
+
+        auto path = std::filesystem::temp_directory_path() / "mcp_compressed.log.gz";
+        std::ofstream(path, std::ios::binary) << gz;
+        std::string handler = std::filesystem::canonical(path).string();
+
+        // Pinned ranges read back the original bytes; unpinned blocks are dropped down to the limit
+        MemorySegment::setDecompressedCacheLimit(2 * Decompressor::kGzipSpan);
+        {
+            SegmentRegistry registry;
+            auto segment = registry.preload(path.string());
+            ASSERT_TRUE(segment->isCompressed() && segment->size() == text.size() && segment->fileSize() == gz.size());
+            for (int i = 0; i < 200; ++i) {
+                size_t offset = rng() % text.size();
+                size_t length = std::min<size_t>(1 + rng() % (3 * Decompressor::kGzipSpan), text.size() - offset);
+                auto pinned = segment->pin(offset, length);
+                ASSERT_TRUE(std::string(static_cast<const char*>(segment->data()) + offset, length) == text.substr(offset, length));
+            }
+            ASSERT_TRUE(segment->residentBytes() <= MemorySegment::decompressedCacheLimit());
+            auto whole = segment->pin(0, segment->size());
+            ASSERT_TRUE(segment->residentBytes() == text.size());
+            whole.reset();
+            ASSERT_TRUE(segment->residentBytes() <= MemorySegment::decompressedCacheLimit());
+        }
+
+        // read/lines semantics apply to the decompressed stream
+        FileOpController controller;
+        Json::Value preload;
+        preload["name"] = "preload";
+        preload["arguments"]["path"] = path.string();
+        Json::Value loaded = controller.callTool(preload);
+        ASSERT_TRUE(!loaded.isMember("__error__"));
+        ASSERT_TRUE(loaded["content"][0]["text"].asString().find("Compressed: gzip") != std::string::npos);
+        for (int i = 0; i < 30; ++i) {
+            size_t offset = rng() % text.size();
+            size_t size = std::min<size_t>(rng() % 100000, text.size() - offset);
+            Json::Value res = read_range(controller, handler, "text", (Json::Value::UInt64)offset, size);
+            ASSERT_TRUE(res["content"][0]["text"].asString() == text.substr(offset, size));
+        }
+        for (size_t start : {(size_t)0, (size_t)7, line / 2, line - 3, line + 5}) {
+            size_t start_byte = 0, bytes_len = 0;
+            bool expected = compute_line_byte_range(text.data(), text.size(), start, 40000, start_byte, bytes_len);
+            Json::Value res = read_range(controller, handler, "lines", (Json::Value::UInt64)start, 40000);
+            ASSERT_TRUE(res.isMember("__error__") == !expected);
+            if (expected) ASSERT_TRUE(res["content"][0]["text"].asString() == text.substr(start_byte, bytes_len));
+        }
+        for (int64_t back : {(int64_t)-1, (int64_t)-50000, -(int64_t)line - 10}) {
+            size_t start_byte = 0, bytes_len = 0;
+            compute_tail_line_byte_range(text.data(), text.size(), (size_t)(-back), 60000, start_byte, bytes_len);
+            Json::Value res = read_range(controller, handler, "lines", (Json::Value::Int64)back, 60000);
+            ASSERT_TRUE(res["content"][0]["text"].asString() == text.substr(start_byte, bytes_len));
+        }
+
+        // Streamed reads decompress chunk by chunk
+        Json::Value params;
+        params["name"] = "fileop";
+        params["arguments"]["operation"] = "read";
+        params["arguments"]["handler"] = handler;
+        params["arguments"]["offset"] = (Json::Value::UInt64)(text.size() - 3 * Decompressor::kGzipSpan);
+        params["arguments"]["size"] = (Json::Value::UInt64)(3 * Decompressor::kGzipSpan);
+        params["arguments"]["format"] = "text";
+        auto stream = controller.streamTool(Json::Value(1), params);
+        std::string body;
+        std::vector<char> buffer(64 * 1024);
+        while (size_t n = stream->read(buffer.data(), buffer.size())) body.append(buffer.data(), n);
+        Json::Value streamed;
+        std::istringstream(body) >> streamed;
+        ASSERT_TRUE(streamed["result"]["content"][0]["text"].asString() == text.substr(text.size() - 3 * Decompressor::kGzipSpan));
+
+        Json::Value search;
+        search["name"] = "fileop";
+        search["arguments"]["operation"] = "search";
+        search["arguments"]["handler"] = handler;
+        search["arguments"]["pattern"] = "line " + std::to_string(line - 1) + " ";
+        Json::Value found = controller.callTool(search);
+        ASSERT_TRUE(found["matches"].size() == 1 && found["matches"][0]["offset"].asUInt64() == text.find(search["arguments"]["pattern"].asString()));
+
+        // Corrupt data fails the preload instead of mapping garbage
+        std::string corrupt = gz.substr(0, 20) + std::string(1000, '\x5a');
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << corrupt;
+        SegmentRegistry registry;
+        bool threw = false;
+        try {
+            registry.preload(path.string());
+        } catch (const std::exception&) {
+            threw = true;
+        }
+        ASSERT_TRUE(threw);
+        std::filesystem::remove(path);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All compressed segment tests passed" << std::endl;
+#else
+    std::cout << "Compressed segment tests skipped (built without zlib)" << std::endl;
+#endif
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <random>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include "../src/Encoding.hpp"
+
+#define ASSERT_TRUE(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << " at " << __FILE__ << ":" << __LINE__ << std::endl; return 1; }
+
+static std::string reference_hex(const std::string& s) {
+    std::stringstream ss;
+    for (unsigned char c : s) {
+        ss << std::hex << std::setw(2) << std::setfill('0') << (unsigned int)c;
+    }
+    return ss.str();
+}
+
+static std::string reference_base64(const std::string& s) {
+    static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    size_t i = 0;
+    for (; i + 3 <= s.size(); i += 3) {
+        unsigned v = (unsigned char)s[i] << 16 | (unsigned char)s[i + 1] << 8 | (unsigned char)s[i + 2];
+        out += alphabet[(v >> 18) & 63]; out += alphabet[(v >> 12) & 63]; out += alphabet[(v >> 6) & 63]; out += alphabet[v & 63];
+    }
+    if (i < s.size()) {
+        unsigned v = (unsigned char)s[i] << 16 | (i + 1 < s.size() ? (unsigned char)s[i + 1] << 8 : 0);
+        out += alphabet[(v >> 18) & 63]; out += alphabet[(v >> 12) & 63];
+        out += (i + 1 < s.size()) ? alphabet[(v >> 6) & 63] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+// Decode-based reference: length of the sequence at `i` if it decodes to a scalar value in its
+// shortest form, 0 otherwise
+static size_t reference_utf8_length(const std::string& s, size_t i) {
+    unsigned char c = s[i];
+    size_t len = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : c >= 0xc0 ? 2 : 0;
+    bool ok = len > 0 && i + len <= s.size();
+    uint32_t cp = len == 4 ? c & 0x07 : len == 3 ? c & 0x0f : c & 0x1f;
+    for (size_t k = 1; ok && k < len; ++k) {
+        unsigned char cc = s[i + k];
+        ok = (cc & 0xc0) == 0x80;
+        cp = cp << 6 | (cc & 0x3f);
+    }
+    static const uint32_t min_cp[] = {0, 0, 0x80, 0x800, 0x10000};
+    ok = ok && cp >= min_cp[len] && cp <= 0x10ffff && (cp < 0xd800 || cp > 0xdfff);
+    return ok ? len : 0;
+}
+
+static size_t reference_utf8_prefix(const std::string& s) {
+    size_t i = 0;
+    while (i < s.size()) {
+        if ((unsigned char)s[i] < 0x80) {
+            ++i;
+        } else if (size_t len = reference_utf8_length(s, i)) {
+            i += len;
+        } else {
+            break;
+        }
+    }
+    return i;
+}
+
+static std::string reference_escape_json(const std::string& s) {
+    std::string out;
+    size_t i = 0;
+    while (i < s.size()) {
+        unsigned char c = s[i];
+        if (c < 0x80) {
+            char buf[8];
+            if (c == '"') out += "\\\"";
+            else if (c == '\\') out += "\\\\";
+            else if (c == '\n') out += "\\n";
+            else if (c == '\r') out += "\\r";
+            else if (c == '\t') out += "\\t";
+            else if (c == '\b') out += "\\b";
+            else if (c == '\f') out += "\\f";
+            else if (c < 0x20) { snprintf(buf, sizeof(buf), "\\u%04x", c); out += buf; }
+            else out += (char)c;
+            ++i;
+            continue;
+        }
+        if (size_t len = reference_utf8_length(s, i)) {
+            out.append(s, i, len);
+            i += len;
+        } else {
+            out += "\\ufffd";
+            ++i;
+        }
+    }
+    return out;
+}
+
+int main() {
+    try {
+        ASSERT_TRUE(encode_hex("", 0).empty());
+        ASSERT_TRUE(encode_hex("\x00\x09\x0a\xff", 4) == "00090aff");
+
+        // Every byte value, and lengths around the 16/32-byte SIMD block sizes
+        std::string all;
+        for (int i = 0; i < 256; ++i) all.push_back((char)i);
+        ASSERT_TRUE(encode_hex(all.data(), all.size()) == reference_hex(all));
+
+        std::mt19937 rng(777);
+        for (size_t len = 0; len < 300; ++len) {
+            std::string s(len, '\0');
+            for (auto& c : s) c = (char)(rng() & 0xff);
+            ASSERT_TRUE(encode_hex(s.data(), s.size()) == reference_hex(s));
+        }
+
+        // base64: RFC 4648 vectors, then random inputs around the 24/32-byte SIMD block sizes
+        ASSERT_TRUE(encode_base64("", 0).empty());
+        ASSERT_TRUE(encode_base64("f", 1) == "Zg==");
+        ASSERT_TRUE(encode_base64("fo", 2) == "Zm8=");
+        ASSERT_TRUE(encode_base64("foobar", 6) == "Zm9vYmFy");
+        ASSERT_TRUE(encode_base64(all.data(), all.size()) == reference_base64(all));
+        std::string decoded;
+        for (size_t len = 0; len < 400; ++len) {
+            std::string s(len, '\0');
+            for (auto& c : s) c = (char)(rng() & 0xff);
+            std::string encoded = encode_base64(s.data(), s.size());
+            ASSERT_TRUE(encoded.size() == base64_encoded_size(len));
+            ASSERT_TRUE(encoded == reference_base64(s));
+            ASSERT_TRUE(decode_base64(encoded.data(), encoded.size(), decoded));
+            ASSERT_TRUE(decoded == s);
+        }
+
+        // Invalid input is rejected wherever it appears, including inside SIMD-sized blocks
+        ASSERT_TRUE(!decode_base64("abc", 3, decoded));
+        ASSERT_TRUE(!decode_base64("ab=c", 4, decoded));
+        ASSERT_TRUE(!decode_base64("a===", 4, decoded));
+        std::string long_encoded = encode_base64(all.data(), all.size());
+        for (size_t pos = 0; pos < 100; ++pos) {
+            for (char bad : {'@', '=', '\n', (char)0x80, (char)0xff}) {
+                std::string broken = long_encoded;
+                broken[pos] = bad;
+                ASSERT_TRUE(!decode_base64(broken.data(), broken.size(), decoded));
+            }
+        }
+
+        // JSON escaping: specials and control characters escaped, UTF-8 kept, invalid bytes replaced
+        ASSERT_TRUE(escape_json("", 0).empty());
+        ASSERT_TRUE(escape_json("a\"b\\c\n\r\t\b\f", 10) == "a\\\"b\\\\c\\n\\r\\t\\b\\f");
+        ASSERT_TRUE(escape_json("\x00\x1f\x7f", 3) == "\\u0000\\u001f\x7f");
+        std::string utf8 = "\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 \xf4\x8f\xbf\xbf";
+        ASSERT_TRUE(escape_json(utf8.data(), utf8.size()) == utf8);
+        for (std::string invalid : {"\x80", "\xc0\xaf", "\xc3", "\xe0\x80\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xf8", "\xff"}) {
+            std::string expected;
+            for (size_t i = 0; i < invalid.size(); ++i) expected += "\\ufffd";
+            ASSERT_TRUE(escape_json(invalid.data(), invalid.size()) == expected);
+        }
+        // A truncated sequence at the end of the input is invalid; the following byte is not swallowed
+        ASSERT_TRUE(escape_json("\xe2\x82x", 3) == "\\ufffd\\ufffdx");
+        // Random mixes of ASCII, escapes, valid and broken UTF-8 at every alignment of the 16/32-byte blocks
+        const std::vector<std::string> pieces = {"a", "plain text ", "\"", "\\", "\n", "\x01", "\x7f",
+            "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xef\xbf\xbf", "\xf4\x8f\xbf\xbf",
+            "\x80", "\xc0\x80", "\xe0\x9f\xbf", "\xed\xa0\x80", "\xf0\x8f\xbf\xbf", "\xf4\x90\x80\x80", "\xc3", "\xe2\x82", "\xff"};
+        for (int round = 0; round < 3000; ++round) {
+            std::string s;
+            // Mostly-clean inputs exercise the block fast path, dense ones the byte-by-byte path
+            size_t clean_weight = rng() % 4 == 0 ? 0 : 12;
+            while (s.size() < (size_t)(rng() % 200)) {
+                size_t k = rng() % (pieces.size() + clean_weight);
+                s += k < pieces.size() ? pieces[k] : std::string(1 + rng() % 40, (char)('a' + rng() % 26));
+            }
+            std::string expected = reference_escape_json(s);
+            ASSERT_TRUE(escape_json(s.data(), s.size()) == expected);
+            ASSERT_TRUE(utf8_valid_prefix(s.data(), s.size()) == reference_utf8_prefix(s));
+            // Same output in small chunks
+            std::string chunked;
+            size_t pos = 0;
+            char buf[64];
+            size_t cap = 6 + rng() % 58;
+            while (pos < s.size()) {
+                size_t consumed = 0;
+                size_t n = escape_json_into(s.data() + pos, s.size() - pos, buf, cap, consumed);
+                ASSERT_TRUE(consumed > 0 && n <= cap);
+                chunked.append(buf, n);
+                pos += consumed;
+            }
+            ASSERT_TRUE(chunked == expected);
+        }
+
+        // Bounded output: no character is split across chunks
+        std::string mixed = "x\"\xc3\xa9\x01y";
+        char chunk[8];
+        size_t consumed = 0;
+        ASSERT_TRUE(escape_json_into(mixed.data(), mixed.size(), chunk, 5, consumed) == 0 && consumed == 0);
+        ASSERT_TRUE(escape_json_into(mixed.data(), mixed.size(), chunk, 8, consumed) == 3 && consumed == 2);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All encoding tests passed" << std::endl;
+    return 0;
+}
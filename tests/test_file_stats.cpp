@@ -0,0 +1,155 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include <json/json.h>
+#include "../src/FileStats.hpp"
+#include "../src/FileOpController.hpp"
+#include "../src/TaskflowManager.hpp"
+
+#define ASSERT_TRUE(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << " at " << __FILE__ << ":" << __LINE__ << std::endl; return 1; }
+
+// Byte-at-a-time profile; UTF-8 is checked by decoding (shortest form, no surrogates, <= U+10FFFF)
+static FileStats reference_stats(const std::string& s) {
+    FileStats st;
+    st.bytes = s.size();
+    size_t line_start = 0;
+    bool have_line = false;
+    auto candidate = [&](size_t len, size_t line) {
+        if (!have_line || len > st.longest_line) {
+            have_line = true;
+            st.longest_line = len;
+            st.longest_line_number = line;
+        }
+    };
+    for (size_t i = 0; i < s.size();) {
+        unsigned char c = s[i];
+        if (c == '\n' || c == '\r') {
+            candidate(i - line_start, st.lines);
+            ++st.lines;
+            if (i + 1 < s.size() && (s[i + 1] == '\n' || s[i + 1] == '\r') && s[i + 1] != s[i]) {
+                ++(c == '\r' ? st.crlf : st.lfcr);
+                i += 2;
+            } else {
+                ++(c == '\n' ? st.lf : st.cr);
+                ++i;
+            }
+            line_start = i;
+            continue;
+        }
+        if (c == 0) ++st.nul_bytes;
+        else if (c < 0x20 && (c < '\b' || c > '\r') && c != 0x1b) ++st.control_bytes;
+        ++i;
+    }
+    if (line_start < s.size()) {
+        candidate(s.size() - line_start, st.lines);
+        ++st.lines;
+    }
+    for (size_t i = 0; i < s.size() && st.utf8_valid;) {
+        unsigned char c = s[i];
+        if (c < 0x80) { ++i; continue; }
+        size_t len = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : c >= 0xc0 ? 2 : 0;
+        bool ok = len > 0 && i + len <= s.size();
+        uint32_t cp = len == 4 ? c & 0x07 : len == 3 ? c & 0x0f : c & 0x1f;
+        for (size_t k = 1; ok && k < len; ++k) {
+            ok = ((unsigned char)s[i + k] & 0xc0) == 0x80;
+            cp = cp << 6 | ((unsigned char)s[i + k] & 0x3f);
+        }
+        static const uint32_t min_cp[] = {0, 0, 0x80, 0x800, 0x10000};
+        if (ok && cp >= min_cp[len] && cp <= 0x10ffff && (cp < 0xd800 || cp > 0xdfff)) {
+            i += len;
+        } else {
+            st.utf8_valid = false;
+            st.utf8_error_offset = i;
+        }
+    }
+    st.binary = st.nul_bytes > 0 || st.control_bytes * 100 > s.size();
+    return st;
+}
+
+static bool same(const FileStats& a, const FileStats& b) {
+    return a.bytes == b.bytes && a.lines == b.lines && a.longest_line == b.longest_line && a.longest_line_number == b.longest_line_number
+        && a.lf == b.lf && a.crlf == b.crlf && a.cr == b.cr && a.lfcr == b.lfcr && a.nul_bytes == b.nul_bytes
+        && a.control_bytes == b.control_bytes && a.utf8_valid == b.utf8_valid && a.binary == b.binary
+        && (a.utf8_valid || a.utf8_error_offset == b.utf8_error_offset);
+}
+
+int main() {
+    try {
+        std::mt19937 rng(4242);
+        const std::vector<std::string> pieces = {"\n", "\r", "\r\n", "\n\r", "\t", std::string(1, '\0'), "\x01", "\x1b[0m",
+            "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xc3", "\xed\xa0\x80", "\xff"};
+
+        // Small inputs at every alignment, with and without invalid UTF-8
+        for (int round = 0; round < 2000; ++round) {
+            std::string s;
+            bool valid_only = rng() % 2;
+            size_t target = rng() % 300;
+            while (s.size() < target) {
+                size_t k = rng() % (pieces.size() + 6);
+                if (k < pieces.size() && !(valid_only && k >= 11)) s += pieces[k];
+                else s.append(1 + rng() % 50, (char)('a' + rng() % 26));
+            }
+            ASSERT_TRUE(same(compute_file_stats(s.data(), s.size()), reference_stats(s)));
+        }
+        FileStats empty = compute_file_stats("", 0);
+        ASSERT_TRUE(empty.lines == 0 && empty.utf8_valid && !empty.binary && empty.newlineStyle() == "none");
+
+        // Parallel chunks give the serial result: long lines, UTF-8 and pairs cross chunk boundaries
+        std::string big;
+        while (big.size() < 3 * kStatsChunkSize) {
+            if (rng() % 5000 == 0) big.append(200000 + rng() % 100000, 'L');
+            big.append(rng() % 80, 'x');
+            big += "\xe2\x82\xac\xf0\x9f\x98\x80";
+            big += (rng() % 2) ? "\r\n" : "\n";
+        }
+        big += "unterminated";
+        TaskflowManager taskflow(4);
+        FileStats serial = compute_file_stats(big.data(), big.size());
+        FileStats parallel = compute_file_stats(big.data(), big.size(), &taskflow);
+        ASSERT_TRUE(parallel.threads > 1);
+        ASSERT_TRUE(same(serial, parallel));
+        ASSERT_TRUE(same(serial, reference_stats(big)));
+        ASSERT_TRUE(serial.utf8_valid && !serial.binary && serial.newlineStyle() == "mixed");
+        big[big.size() / 2] = '\xff';
+        ASSERT_TRUE(same(compute_file_stats(big.data(), big.size(), &taskflow), reference_stats(big)));
+
+        // stats operation, and the cached profile in listResources
+        FileOpController controller;
+        auto path = std::filesystem::temp_directory_path() / "mcp_stats.txt";
+        std::string text = "first\r\nsecond line\r\n\xc3\xa9t\xc3\xa9\r\n";
+        std::ofstream(path, std::ios::binary) << text;
+        std::string handler = std::filesystem::canonical(path).string();
+        Json::Value preload; preload["name"] = "preload"; preload["arguments"]["path"] = path.string();
+        ASSERT_TRUE(!controller.callTool(preload).isMember("__error__"));
+        Json::Value listed = controller.listResources();
+        ASSERT_TRUE(listed["resources"][0]["description"].asString().find("lines") == std::string::npos);
+
+        Json::Value call;
+        call["name"] = "fileop";
+        call["arguments"]["operation"] = "stats";
+        call["arguments"]["handler"] = handler;
+        Json::Value res = controller.callTool(call);
+        ASSERT_TRUE(!res.isMember("__error__"));
+        ASSERT_TRUE(res["stats"]["lines"].asUInt64() == 3);
+        ASSERT_TRUE(res["stats"]["longest_line"].asUInt64() == 11 && res["stats"]["longest_line_number"].asUInt64() == 1);
+        ASSERT_TRUE(res["stats"]["newline_style"].asString() == "crlf" && res["stats"]["newlines"]["crlf"].asUInt64() == 3);
+        ASSERT_TRUE(res["stats"]["utf8_valid"].asBool() && !res["stats"]["binary"].asBool());
+
+        listed = controller.listResources();
+        ASSERT_TRUE(listed["resources"][0]["description"].asString().find("3 lines, longest line 11 bytes") != std::string::npos);
+        ASSERT_TRUE(listed["resources"][0]["mimeType"].asString() == "text/plain");
+
+        Json::Value bad = call;
+        bad["arguments"]["handler"] = "/no/such/handler";
+        ASSERT_TRUE(controller.callTool(bad).isMember("__error__"));
+        std::filesystem::remove(path);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All file stats tests passed" << std::endl;
+    return 0;
+}
@@ -1,7 +1,9 @@
 #include <iostream>
+#include <chrono>
 #include <fstream>
 #include <filesystem>
 #include <string>
+#include <thread>
 #include <vector>
 #include <json/json.h>
 #include "../src/FileOpController.hpp"
@@ -144,8 +146,13 @@ int main() {
             Json::Value preloadLines;
             preloadLines["name"] = "preload";
             preloadLines["arguments"]["path"] = tmpFile2.string();
+            preloadLines["arguments"]["line_index"] = true;
             Json::Value preloadLinesRes = controller.callTool(preloadLines);
             ASSERT_TRUE(!preloadLinesRes.isMember("__error__"));
+            // eager line index build reports line count and build stats
+            std::string preloadLinesText = preloadLinesRes["content"][0]["text"].asString();
+            ASSERT_TRUE(preloadLinesText.find("Lines: 4") != std::string::npos);
+            ASSERT_TRUE(preloadLinesText.find("Line index: built in") != std::string::npos);
             std::string handlerLines = std::filesystem::canonical(tmpFile2).string();
             // read multiple lines starting from line 1, read 2 lines -> L2 + L3
             Json::Value rmLines;
@@ -167,7 +174,90 @@ int main() {
             ASSERT_TRUE(rmLinesRes["content"][0]["type"].asString() == "text");
             std::string expected = "L2\r\nL3\n";
             ASSERT_TRUE(rmLinesRes["content"][0]["text"].asString() == expected);
+            ASSERT_TRUE(rmLinesRes["content"][0]["version"].asUInt64() == 1);
             ASSERT_TRUE(!rmLinesProgress.empty());
+
+            // Appending to the file and preloading again remaps it and extends the line index
+            {
+                std::ofstream app(tmpFile2, std::ios::app);
+                app << "\r\nL5\n";
+            }
+            Json::Value reloadRes = controller.callTool(preloadLines);
+            ASSERT_TRUE(!reloadRes.isMember("__error__"));
+            ASSERT_TRUE(reloadRes["content"][0]["text"].asString().find("Lines: 5") != std::string::npos);
+            Json::Value readAppended;
+            readAppended["name"] = "fileop";
+            readAppended["arguments"]["operation"] = "read";
+            readAppended["arguments"]["handler"] = handlerLines;
+            readAppended["arguments"]["offset"] = (Json::UInt64)3;
+            readAppended["arguments"]["size"] = (Json::UInt64)2;
+            readAppended["arguments"]["format"] = "lines";
+            Json::Value appendedRes = controller.callTool(readAppended);
+            ASSERT_TRUE(!appendedRes.isMember("__error__"));
+            ASSERT_TRUE(appendedRes["content"][0]["text"].asString() == std::string("L4\r\nL5\n"));
+            ASSERT_TRUE(appendedRes["content"][0]["version"].asUInt64() == 2);
+
+            // Without a preload, the file watcher marks the mapping stale and the next read remaps it
+            {
+                std::ofstream app(tmpFile2, std::ios::app);
+                app << "L6\n";
+            }
+            readAppended["arguments"]["offset"] = (Json::UInt64)5;
+            readAppended["arguments"]["size"] = (Json::UInt64)1;
+            Json::Value watchedRes;
+            for (int i = 0; i < 500 && !watchedRes.isMember("content"); ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                Json::Value res = controller.callTool(readAppended);
+                if (!res.isMember("__error__")) watchedRes = res;
+            }
+            ASSERT_TRUE(watchedRes["content"][0]["text"].asString() == "L6\n");
+            ASSERT_TRUE(watchedRes["content"][0]["version"].asUInt64() == 3);
+            std::filesystem::remove(tmpFile2);
+
+        // Listing reports evicted handlers without mapping them again, even once their file is
+        // gone; reading such a resource is an error rather than an exception
+        {
+            controller.setMemoryBudget(0, 1);
+            auto evictedFile = tmpDir / "mcp_fileop_evicted.txt";
+            auto keptFile = tmpDir / "mcp_fileop_kept.txt";
+            std::ofstream(evictedFile) << "evicted\n";
+            std::ofstream(keptFile) << "kept\n";
+            for (const auto& path : {evictedFile, keptFile}) {
+                Json::Value preload;
+                preload["name"] = "fileop";
+                preload["arguments"]["operation"] = "preload";
+                preload["arguments"]["path"] = path.string();
+                ASSERT_TRUE(!controller.callTool(preload).isMember("__error__"));
+            }
+            std::filesystem::remove(evictedFile);
+            std::string evictedUri = "file:///" + (std::filesystem::canonical(tmpDir) / "mcp_fileop_evicted.txt").string();
+            Json::Value listed = controller.listResources();
+            bool listedEvicted = false;
+            for (const auto& r : listed["resources"]) {
+                if (r["uri"].asString() == evictedUri) {
+                    listedEvicted = r["description"].asString().find("(8 bytes") != std::string::npos;
+                }
+            }
+            ASSERT_TRUE(listedEvicted);
+            Json::Value uriParams;
+            uriParams["uri"] = evictedUri;
+            ASSERT_TRUE(controller.readResourceFromUri(uriParams).isMember("__error__"));
+            Json::Value streamed;
+            Json::CharReaderBuilder builder;
+            std::string text = controller.streamResource(9, uriParams)->readAll(), errs;
+            std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+            ASSERT_TRUE(reader->parse(text.data(), text.data() + text.size(), &streamed, &errs));
+            ASSERT_TRUE(streamed["error"]["code"].asInt() == -32000);
+            for (const auto& uri : {evictedUri, "file:///" + std::filesystem::canonical(keptFile).string()}) {
+                Json::Value close;
+                close["name"] = "fileop";
+                close["arguments"]["operation"] = "close";
+                close["arguments"]["handler"] = uri.substr(8);
+                ASSERT_TRUE(!controller.callTool(close).isMember("__error__"));
+            }
+            std::filesystem::remove(keptFile);
+            controller.setMemoryBudget(0, 0);
+        }
         // Cleanup file
         std::filesystem::remove(tmpFile);
 
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <string>
+#include <random>
+#include "../src/LineIndex.hpp"
+#include "../src/LineUtils.hpp"
+#include "../src/TaskflowManager.hpp"
+
+#define ASSERT_TRUE(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << " at " << __FILE__ << ":" << __LINE__ << std::endl; return 1; }
+
+int main() {
+    try {
+        // Build a file spanning several checkpoints with mixed terminators
+        std::mt19937 rng(4242);
+        std::string s;
+        size_t expected_lines = 0;
+        const char* terminators[] = {"\n", "\r", "\r\n", "\n\r"};
+        while (expected_lines < LineIndex::kStride * 5 + 17) {
+            s.append(1 + rng() % 40, 'x');
+            s.append(terminators[rng() % 4]);
+            ++expected_lines;
+        }
+        s.append("tail-without-newline");
+        ++expected_lines;
+
+        auto index = LineIndex::build(s.data(), s.size());
+        ASSERT_TRUE(index->lineCount() == expected_lines);
+        ASSERT_TRUE(index->byteSize() == s.size());
+
+        // Indexed lookups must agree with a scan from byte 0
+        for (int trial = 0; trial < 300; ++trial) {
+            size_t start_line = rng() % (expected_lines + 2);
+            size_t max_lines = rng() % 50;
+            size_t from_line = 0, from_byte = 0;
+            index->nearest(start_line, from_line, from_byte);
+            ASSERT_TRUE(from_line <= start_line);
+            size_t sb1 = 0, bl1 = 0, sb2 = 0, bl2 = 0;
+            bool ok1 = compute_line_byte_range(s.data(), s.size(), start_line, max_lines, sb1, bl1, from_line, from_byte);
+            bool ok2 = compute_line_byte_range(s.data(), s.size(), start_line, max_lines, sb2, bl2);
+            ASSERT_TRUE(ok1 == ok2);
+            if (ok1) {
+                ASSERT_TRUE(sb1 == sb2 && bl1 == bl2);
+            }
+        }
+
+        // Parallel build over a file large enough to be split into chunks must match the serial build.
+        // An alternating \n\r run across the middle checks pairs straddling a chunk boundary.
+        std::string big;
+        big.reserve(LineIndex::kMinParallelChunk * 3);
+        while (big.size() < LineIndex::kMinParallelChunk * 3) {
+            if (big.size() > LineIndex::kMinParallelChunk * 3 / 2 - 64 && big.size() < LineIndex::kMinParallelChunk * 3 / 2 + 64) {
+                big.append(rng() % 2 ? "\n\r\n\r\n" : "\r\n\r");
+                continue;
+            }
+            big.append(1 + rng() % 80, 'y');
+            big.append(terminators[rng() % 4]);
+        }
+        for (size_t tail = 0; tail < 2; ++tail) {
+            if (tail) big.append("partial");
+            TaskflowManager taskflow(4);
+            auto serial = LineIndex::build(big.data(), big.size());
+            auto parallel = LineIndex::build(big.data(), big.size(), &taskflow);
+            ASSERT_TRUE(parallel->buildThreads() > 1);
+            ASSERT_TRUE(serial->buildThreads() == 1);
+            ASSERT_TRUE(parallel->lineCount() == serial->lineCount());
+            for (size_t line = 0; line <= serial->lineCount() + LineIndex::kStride; line += 997) {
+                size_t l1 = 0, b1 = 0, l2 = 0, b2 = 0;
+                serial->nearest(line, l1, b1);
+                parallel->nearest(line, l2, b2);
+                ASSERT_TRUE(l1 == l2 && b1 == b2);
+            }
+        }
+
+        // Extending an index over appended data must match a full rebuild, including when the
+        // old EOF falls between a '\r' and an appended '\n' or exactly on a checkpoint
+        std::string grown = s.substr(0, s.size() - 20);
+        auto incremental = LineIndex::build(grown.data(), grown.size());
+        for (int step = 0; step < 40; ++step) {
+            grown.append(1 + rng() % 3000, 'z');
+            grown.append(step % 2 ? "\r" : "\n");
+            if (step % 5 == 0) grown.append(std::string(LineIndex::kStride, '\n'));
+            incremental = LineIndex::extend(*incremental, grown.data(), grown.size());
+            auto full = LineIndex::build(grown.data(), grown.size());
+            ASSERT_TRUE(incremental->lineCount() == full->lineCount());
+            ASSERT_TRUE(incremental->byteSize() == grown.size());
+            for (size_t line = 0; line <= full->lineCount(); line += 331) {
+                size_t l1 = 0, b1 = 0, l2 = 0, b2 = 0;
+                incremental->nearest(line, l1, b1);
+                full->nearest(line, l2, b2);
+                ASSERT_TRUE(l1 == l2 && b1 == b2);
+            }
+        }
+
+        // Empty input has no lines and a single checkpoint at byte 0
+        auto empty = LineIndex::build("", 0);
+        ASSERT_TRUE(empty->lineCount() == 0);
+        size_t cl = 1, cb = 1;
+        empty->nearest(10, cl, cb);
+        ASSERT_TRUE(cl == 0 && cb == 0);
+
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All line index tests passed" << std::endl;
+    return 0;
+}
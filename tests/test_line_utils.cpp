@@ -53,6 +53,18 @@ int main() {
         ASSERT_TRUE(ok);
         ASSERT_TRUE(bytes_len == 0);
 
+        // 9) tail reads: last two lines, and an offset reaching before the first line clamps to line 0
+        ok = compute_tail_line_byte_range(mixed.data(), mixed.size(), 2, 2, start_byte, bytes_len);
+        ASSERT_TRUE(ok);
+        ASSERT_TRUE(mixed.substr(start_byte, bytes_len) == std::string("C\rD\n"));
+        ok = compute_tail_line_byte_range(content.data(), content.size(), 10, 1, start_byte, bytes_len);
+        ASSERT_TRUE(ok);
+        ASSERT_TRUE(content.substr(start_byte, bytes_len) == std::string("L1\n"));
+        std::string no_trailing = "a\n\nb";
+        ok = compute_tail_line_byte_range(no_trailing.data(), no_trailing.size(), 2, 5, start_byte, bytes_len);
+        ASSERT_TRUE(ok);
+        ASSERT_TRUE(no_trailing.substr(start_byte, bytes_len) == std::string("\nb"));
+
     } catch (const std::exception& e) {
         std::cerr << "Exception: " << e.what() << std::endl;
         return 1;
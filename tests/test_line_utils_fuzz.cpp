@@ -91,6 +91,52 @@ int main() {
                         return 1;
                     }
                 }
+                // Backward scan: the k-th line from EOF must start where the forward split says
+                size_t k = rng() % (line_count + 2);
+                size_t found = 0;
+                size_t tail_start = find_tail_line_start(s.data(), s.size(), k, found);
+                size_t expected_start = (k == 0) ? s.size() : (k <= line_count ? ranges[line_count - k].first : 0);
+                ASSERT_TRUE(found == std::min(k, line_count));
+                ASSERT_TRUE(tail_start == expected_start);
+            }
+        }
+
+        // Sparse terminators and long lines exercise the 64-byte block scanner: whole blocks
+        // without terminators, LF-only blocks and \r\n pairs straddling a block boundary.
+        std::uniform_int_distribution<int> long_len_d(0, 8192);
+        std::uniform_int_distribution<int> sparse_d(0, 999);
+        for (int iter = 0; iter < 500; ++iter) {
+            int len = long_len_d(rng);
+            bool lf_only = (iter % 2) == 0;
+            std::string s;
+            s.reserve(len);
+            for (int i = 0; i < len; ++i) {
+                int r = sparse_d(rng);
+                if (r < 8) {
+                    s.push_back('\n');
+                } else if (!lf_only && r < 12) {
+                    s.push_back('\r');
+                } else {
+                    s.push_back((char)('a' + (r % 26)));
+                }
+            }
+            auto ranges = reference_line_ranges(s.data(), s.size());
+            size_t line_count = ranges.size();
+            for (int trial = 0; trial < 20; ++trial) {
+                size_t start_line = rng() % (line_count + 2);
+                size_t max_lines = rng() % (line_count + 2);
+                size_t start_byte1 = 0, bytes_len1 = 0;
+                bool ok1 = compute_line_byte_range(s.data(), s.size(), start_line, max_lines, start_byte1, bytes_len1);
+                size_t start_byte2 = 0, bytes_len2 = 0;
+                bool ok2 = reference_compute_line_byte_range(s, start_line, max_lines, start_byte2, bytes_len2);
+                ASSERT_TRUE(ok1 == ok2);
+                if (ok1) {
+                    ASSERT_TRUE(start_byte1 == start_byte2 && bytes_len1 == bytes_len2);
+                }
+                size_t k = rng() % (line_count + 2);
+                size_t found = 0;
+                size_t tail_start = find_tail_line_start(s.data(), s.size(), k, found);
+                ASSERT_TRUE(tail_start == ((k == 0) ? s.size() : (k <= line_count ? ranges[line_count - k].first : 0)));
             }
         }
 
@@ -2,8 +2,10 @@
 #include <fstream>
 #include <filesystem>
 #include <vector>
+#include <algorithm>
 #include <json/json.h>
 #include "../src/FileOpController.hpp"
+#include "../src/Encoding.hpp"
 
 #define ASSERT_TRUE(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << " at " << __FILE__ << ":" << __LINE__ << std::endl; return 1; }
 
@@ -75,9 +77,93 @@ int main() {
 
         ASSERT_TRUE(!progress_list.empty());
 
+        // binary format is base64 so the JSON stays valid; resources/read returns a base64 blob
+        Json::Value bin;
+        bin["name"] = "fileop";
+        bin["arguments"]["operation"] = "read";
+        bin["arguments"]["handler"] = h2;
+        bin["arguments"]["offset"] = (Json::UInt64)0;
+        bin["arguments"]["size"] = (Json::UInt64)binary.size();
+        bin["arguments"]["format"] = "binary";
+        Json::Value binRes = controller.callTool(bin);
+        ASSERT_TRUE(!binRes.isMember("__error__"));
+        ASSERT_TRUE(binRes["content"][0]["type"].asString() == "bytes");
+        ASSERT_TRUE(binRes["content"][0]["encoding"].asString() == "base64");
+        std::string decoded;
+        std::string encoded = binRes["content"][0]["data"].asString();
+        ASSERT_TRUE(decode_base64(encoded.data(), encoded.size(), decoded));
+        ASSERT_TRUE(decoded == binary);
+        Json::Value uriParams;
+        uriParams["uri"] = "file:///" + h2;
+        Json::Value resource = controller.readResourceFromUri(uriParams);
+        ASSERT_TRUE(!resource.isMember("__error__"));
+        ASSERT_TRUE(resource["contents"][0]["blob"].asString() == encoded);
+
+        // Out-of-order, duplicate and overlapping ranges come back in request order
+        Json::Value planned;
+        planned["name"] = "fileop";
+        planned["arguments"]["operation"] = "read_multiple";
+        Json::Value pl; pl["handler"] = h1; pl["format"] = "lines";
+        pl["ranges"][0]["offset"] = (Json::UInt64)2; pl["ranges"][0]["size"] = (Json::UInt64)1;
+        pl["ranges"][1]["offset"] = (Json::UInt64)0; pl["ranges"][1]["size"] = (Json::UInt64)2;
+        pl["ranges"][2]["offset"] = (Json::UInt64)2; pl["ranges"][2]["size"] = (Json::UInt64)1;
+        Json::Value ph; ph["handler"] = h2; ph["format"] = "hex";
+        ph["ranges"][0]["offset"] = (Json::UInt64)1; ph["ranges"][0]["size"] = (Json::UInt64)3;
+        ph["ranges"][1]["offset"] = (Json::UInt64)0; ph["ranges"][1]["size"] = (Json::UInt64)2;
+        planned["arguments"]["segments"].append(pl);
+        planned["arguments"]["segments"].append(ph);
+        std::vector<double> planned_progress;
+        auto plannedCb = [&planned_progress](const Json::Value &p) { planned_progress.push_back(p["progress"].asDouble()); };
+        Json::Value plannedRes = controller.callTool(planned, plannedCb);
+        ASSERT_TRUE(!plannedRes.isMember("__error__"));
+        ASSERT_TRUE(plannedRes["content"].size() == 5);
+        ASSERT_TRUE(plannedRes["content"][0]["text"].asString() == std::string("Line3\n"));
+        ASSERT_TRUE(plannedRes["content"][1]["text"].asString() == std::string("Hello\nWorld\n"));
+        ASSERT_TRUE(plannedRes["content"][2]["text"].asString() == std::string("Line3\n"));
+        ASSERT_TRUE(plannedRes["content"][3]["text"].asString() == to_hex(binary.substr(1, 3)));
+        ASSERT_TRUE(plannedRes["content"][4]["text"].asString() == to_hex(binary.substr(0, 2)));
+        ASSERT_TRUE(planned_progress.size() == 5);
+        ASSERT_TRUE(std::is_sorted(planned_progress.begin(), planned_progress.end()));
+        ASSERT_TRUE(planned_progress.back() == 1.0);
+
+        // Large requests are read concurrently; results and progress still follow request order
+        auto t3 = tmpDir / "mcp_mixed_large.bin";
+        std::string large(1 << 20, '\0');
+        for (size_t i = 0; i < large.size(); ++i) large[i] = (char)((i * 131) >> 3);
+        std::ofstream ofs3(t3, std::ios::binary);
+        ofs3.write(large.data(), large.size());
+        ofs3.close();
+        FileOpController parallel;
+        parallel.setReadConcurrency(4);
+        Json::Value p3; p3["name"] = "preload"; p3["arguments"]["path"] = t3.string();
+        ASSERT_TRUE(!parallel.callTool(p3).isMember("__error__"));
+        std::string h3 = std::filesystem::canonical(t3).string();
+        Json::Value wide;
+        wide["name"] = "fileop";
+        wide["arguments"]["operation"] = "read_multiple";
+        Json::Value ws; ws["handler"] = h3; ws["format"] = "hex";
+        const size_t chunk = 64 * 1024;
+        for (Json::ArrayIndex i = 0; i < 16; ++i) {
+            ws["ranges"][i]["offset"] = (Json::UInt64)((15 - i) * chunk);
+            ws["ranges"][i]["size"] = (Json::UInt64)chunk;
+        }
+        wide["arguments"]["segments"].append(ws);
+        std::vector<double> wide_progress;
+        auto wideCb = [&wide_progress](const Json::Value &p) { wide_progress.push_back(p["progress"].asDouble()); };
+        Json::Value wideRes = parallel.callTool(wide, wideCb);
+        ASSERT_TRUE(!wideRes.isMember("__error__"));
+        ASSERT_TRUE(wideRes["content"].size() == 16);
+        for (Json::ArrayIndex i = 0; i < 16; ++i) {
+            ASSERT_TRUE(wideRes["content"][i]["text"].asString() == encode_hex(large.data() + (15 - i) * chunk, chunk));
+        }
+        ASSERT_TRUE(wide_progress.size() == 16);
+        ASSERT_TRUE(std::is_sorted(wide_progress.begin(), wide_progress.end()));
+        ASSERT_TRUE(wide_progress.back() == 1.0);
+
         // clean up
         std::filesystem::remove(t1);
         std::filesystem::remove(t2);
+        std::filesystem::remove(t3);
 
     } catch (const std::exception &e) {
         std::cerr << "Exception: " << e.what() << std::endl;
@@ -0,0 +1,181 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <json/json.h>
+#include "../src/Records.hpp"
+#include "../src/FileOpController.hpp"
+#include "../src/StreamingResponse.hpp"
+#include "../src/TaskflowManager.hpp"
+
+#define ASSERT_TRUE(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << " at " << __FILE__ << ":" << __LINE__ << std::endl; return 1; }
+
+static std::vector<std::string> all_records(const std::string& s) {
+    std::vector<std::string> records;
+    size_t pos = 0, begin = 0, end = 0;
+    while (next_record(s.data(), s.size(), pos, begin, end)) records.push_back(s.substr(begin, end - begin));
+    return records;
+}
+
+static Json::Value records_read(FileOpController& controller, const std::string& handler, Json::Value offset, size_t size, const Json::Value& extra = Json::Value()) {
+    Json::Value call;
+    call["name"] = "fileop";
+    call["arguments"]["operation"] = "read";
+    call["arguments"]["handler"] = handler;
+    call["arguments"]["offset"] = offset;
+    call["arguments"]["size"] = (Json::Value::UInt64)size;
+    call["arguments"]["format"] = "records";
+    if (extra.isObject()) {
+        for (const auto& key : extra.getMemberNames()) call["arguments"][key] = extra[key];
+    }
+    return controller.callTool(call);
+}
+
+static Json::Value parse(const std::string& text) {
+    Json::Value v;
+    std::istringstream(text) >> v;
+    return v;
+}
+
+int main() {
+    try {
+        // Records are non-blank lines ended by '\n': a '\r' inside a line does not split it, CRLF
+        // loses its '\r', and an unterminated last line counts only once it is complete
+        std::string s = "{\"a\":1}\r\n\n  \r\n{\"b\":\"x\ry\",\r\"c\":2}\n[1,2]\n{\"d\":";
+        auto records = all_records(s);
+        ASSERT_TRUE(records.size() == 3);
+        ASSERT_TRUE(records[0] == "{\"a\":1}");
+        ASSERT_TRUE(records[1] == "{\"b\":\"x\ry\",\r\"c\":2}");
+        ASSERT_TRUE(records[2] == "[1,2]");
+        ASSERT_TRUE(all_records(s + "3}").size() == 4);
+        ASSERT_TRUE(all_records(s + "3}  ").size() == 4);
+        ASSERT_TRUE(all_records("{\"s\":\"a\\\"}\"}").size() == 1);
+        ASSERT_TRUE(all_records("{\"s\":\"a\\\"}").empty());
+
+        // The parallel build finds the same checkpoints as the serial one
+        std::string big;
+        for (size_t i = 0; big.size() < 3 * RecordIndex::kMinParallelChunk; ++i) {
+            big += "{\"i\":" + std::to_string(i) + (i % 3 ? "}\n" : ",\"t\":\"a\rb\"}\r\n");
+            if (i % 17 == 0) big += "\n";
+        }
+        TaskflowManager taskflow(4);
+        auto serial = RecordIndex::build(big.data(), big.size());
+        auto parallel = RecordIndex::build(big.data(), big.size(), &taskflow);
+        ASSERT_TRUE(parallel->buildThreads() > 1);
+        ASSERT_TRUE(serial->recordCount() == parallel->recordCount());
+        ASSERT_TRUE(serial->checkpointCount() == parallel->checkpointCount());
+        for (size_t k = 0; k < serial->checkpointCount(); ++k) {
+            ASSERT_TRUE(serial->checkpointByte(k) == parallel->checkpointByte(k));
+        }
+
+        // Controller reads by record number, with projection and matching
+        std::string jsonl;
+        for (int i = 0; i < 5000; ++i) {
+            jsonl += "{\"id\":" + std::to_string(i) + ",\"na\\u006de\":\"n" + std::to_string(i) + "\",\"score\":" +
+                     (i == 4321 ? std::string("5.0") : std::to_string(i % 100)) + ",\"note\":\"line\\nbreak\rraw\"}\n";
+            if (i % 1000 == 999) jsonl += "\r\n";
+        }
+        jsonl += "{\"id\":5000";
+        auto path = std::filesystem::temp_directory_path() / "mcp_records.jsonl";
+        std::ofstream(path, std::ios::binary) << jsonl;
+        std::string handler = std::filesystem::canonical(path).string();
+        FileOpController controller;
+        Json::Value preload;
+        preload["name"] = "preload";
+        preload["arguments"]["path"] = path.string();
+        ASSERT_TRUE(!controller.callTool(preload).isMember("__error__"));
+
+        Json::Value res = records_read(controller, handler, (Json::Value::UInt64)3000, 3);
+        const Json::Value& item = res["content"][0];
+        ASSERT_TRUE(item["format"].asString() == "records");
+        ASSERT_TRUE(item["record_numbers"].size() == 3 && item["record_numbers"][0].asUInt64() == 3000);
+        std::istringstream lines(item["text"].asString());
+        std::string line;
+        for (int i = 3000; std::getline(lines, line); ++i) {
+            Json::Value v = parse(line);
+            ASSERT_TRUE(v["id"].asInt() == i && v["name"].asString() == "n" + std::to_string(i));
+        }
+
+        Json::Value extra;
+        extra["fields"].append("score");
+        extra["fields"].append("name");
+        extra["fields"].append("missing");
+        res = records_read(controller, handler, (Json::Value::Int64)-2, 5, extra);
+        ASSERT_TRUE(res["content"][0]["text"].asString() == "{\"score\":98,\"na\\u006de\":\"n4998\"}\n{\"score\":99,\"na\\u006de\":\"n4999\"}\n");
+        ASSERT_TRUE(res["content"][0]["record_numbers"][1].asUInt64() == 4999);
+
+        // Numbers match by value, keys after unescaping
+        Json::Value match;
+        match["match"]["score"] = 5;
+        match["match"]["name"] = "n4321";
+        res = records_read(controller, handler, (Json::Value::UInt64)100, 10, match);
+        ASSERT_TRUE(res["content"][0]["record_numbers"].size() == 1);
+        ASSERT_TRUE(res["content"][0]["record_numbers"][0].asUInt64() == 4321);
+        match = Json::Value();
+        match["match"]["score"] = 7;
+        match["fields"].append("id");
+        res = records_read(controller, handler, (Json::Value::UInt64)0, 3, match);
+        ASSERT_TRUE(res["content"][0]["text"].asString() == "{\"id\":7}\n{\"id\":107}\n{\"id\":207}\n");
+
+        match = Json::Value();
+        match["match"]["note"] = "line\nbreak\rraw";
+        match["match"]["id"] = 4999.0;
+        res = records_read(controller, handler, (Json::Value::UInt64)4000, 2, match);
+        ASSERT_TRUE(res["content"][0]["record_numbers"].size() == 1);
+        match["match"]["id"] = true;
+        res = records_read(controller, handler, (Json::Value::UInt64)4000, 2, match);
+        ASSERT_TRUE(res["content"][0]["record_numbers"].empty());
+
+        ASSERT_TRUE(records_read(controller, handler, (Json::Value::UInt64)5001, 1).isMember("__error__"));
+        ASSERT_TRUE(records_read(controller, handler, (Json::Value::UInt64)5000, 1)["content"][0]["record_numbers"].empty());
+        Json::Value bad;
+        bad["fields"] = "id";
+        ASSERT_TRUE(records_read(controller, handler, (Json::Value::UInt64)0, 1, bad).isMember("__error__"));
+
+        // Completing the last record makes it readable after a refresh
+        std::ofstream(path, std::ios::binary | std::ios::app) << "}\n";
+        ASSERT_TRUE(!controller.callTool(preload).isMember("__error__"));
+        res = records_read(controller, handler, (Json::Value::Int64)-1, 1);
+        ASSERT_TRUE(res["content"][0]["text"].asString() == "{\"id\":5000}\n");
+
+        // Streamed reads return the same document
+        Json::Value params;
+        params["name"] = "fileop";
+        params["arguments"]["operation"] = "read";
+        params["arguments"]["handler"] = handler;
+        params["arguments"]["offset"] = 1998;
+        params["arguments"]["size"] = 4;
+        params["arguments"]["format"] = "records";
+        params["arguments"]["fields"].append("note");
+        auto stream = controller.streamTool(Json::Value(1), params);
+        std::string body;
+        std::vector<char> buffer(4096);
+        while (size_t n = stream->read(buffer.data(), buffer.size())) body.append(buffer.data(), n);
+        Json::Value streamed = parse(body);
+        Json::Value direct = controller.callTool(params);
+        ASSERT_TRUE(StreamingResponse::compact(streamed["result"]["content"]) == StreamingResponse::compact(direct["content"]));
+        ASSERT_TRUE(direct["content"][0]["record_numbers"][3].asUInt64() == 2001);
+        std::filesystem::remove(path);
+
+        // Invalid UTF-8 in streamed records becomes U+FFFD, as in streamed text
+        auto latin1 = std::filesystem::temp_directory_path() / "mcp_records_latin1.jsonl";
+        std::ofstream(latin1, std::ios::binary) << "{\"name\":\"caf\xe9\"}\n";
+        preload["arguments"]["path"] = latin1.string();
+        ASSERT_TRUE(!controller.callTool(preload).isMember("__error__"));
+        params["arguments"]["handler"] = std::filesystem::canonical(latin1).string();
+        params["arguments"]["offset"] = 0;
+        params["arguments"].removeMember("fields");
+        body = controller.streamTool(Json::Value(1), params)->readAll();
+        ASSERT_TRUE(body.find("\"text\":\"{\\\"name\\\":\\\"caf\\ufffd\\\"}\\n\"") != std::string::npos);
+        streamed = parse(body);
+        ASSERT_TRUE(streamed["result"]["content"][0]["record_numbers"][0].asUInt64() == 0);
+        std::filesystem::remove(latin1);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All records tests passed" << std::endl;
+    return 0;
+}
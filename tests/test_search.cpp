@@ -0,0 +1,232 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include <json/json.h>
+#include "../src/FileOpController.hpp"
+#include "../src/Search.hpp"
+#include "../src/LineUtils.hpp"
+#include "../src/TaskflowManager.hpp"
+
+#define ASSERT_TRUE(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << " at " << __FILE__ << ":" << __LINE__ << std::endl; return 1; }
+
+// Reference line number: terminator sequences (\n, \r, \r\n, \n\r) that end at or before `pos`
+static size_t naive_line_of(const std::string& s, size_t pos) {
+    size_t line = 0;
+    size_t i = 0;
+    while (i < pos) {
+        char c = s[i];
+        if (c == '\n' || c == '\r') {
+            size_t end = i + 1;
+            if (end < s.size() && (s[end] == '\n' || s[end] == '\r') && s[end] != c) ++end;
+            if (end > pos) break;
+            ++line;
+            i = end;
+        } else {
+            ++i;
+        }
+    }
+    return line;
+}
+
+int main() {
+    try {
+        std::mt19937 rng(4242);
+
+        // find_literal agrees with std::string::find for every pattern length around the block sizes
+        for (int round = 0; round < 400; ++round) {
+            std::string hay(rng() % 300, 'a');
+            for (auto& c : hay) c = "ab\nc"[rng() % 4];
+            size_t plen = 1 + rng() % 70;
+            std::string pattern;
+            if (!hay.empty() && rng() % 2) {
+                size_t at = rng() % hay.size();
+                pattern = hay.substr(at, plen);
+            } else {
+                for (size_t k = 0; k < plen; ++k) pattern += "ab\nc"[rng() % 4];
+            }
+            for (size_t from = 0; from <= hay.size(); from += 1 + rng() % 17) {
+                size_t expected = hay.find(pattern, from);
+                if (expected == std::string::npos) expected = hay.size();
+                ASSERT_TRUE(find_literal(hay.data(), hay.size(), from, pattern.data(), pattern.size()) == expected);
+            }
+        }
+        ASSERT_TRUE(find_literal("abc", 3, 0, "abcd", 4) == 3);
+        ASSERT_TRUE(find_literal("abc", 3, 3, "c", 1) == 3);
+
+        // count_lines_before numbers ascending positions continuing from the previous line start
+        for (int round = 0; round < 200; ++round) {
+            std::string s;
+            size_t n = rng() % 400;
+            for (size_t k = 0; k < n; ++k) s += "x\n\rab\r\n"[rng() % 7];
+            size_t line = 0;
+            size_t line_start = 0;
+            for (size_t pos = 0; pos <= s.size(); pos += 1 + rng() % 9) {
+                line += count_lines_before(s.data(), s.size(), line_start, pos, line_start);
+                ASSERT_TRUE(line == naive_line_of(s, pos));
+                ASSERT_TRUE(line_start <= pos);
+                ASSERT_TRUE(naive_line_of(s, line_start) == line);
+            }
+        }
+
+        // search operation: offsets, zero-based lines and columns, with and without the line index
+        FileOpController controller;
+        auto tmpDir = std::filesystem::temp_directory_path();
+        auto t1 = tmpDir / "mcp_search1.txt";
+        auto t2 = tmpDir / "mcp_search2.txt";
+        std::string text1;
+        for (int i = 0; i < 10000; ++i) {
+            text1 += (i % 1000 == 7) ? "line with NEEDLE here" : "plain line " + std::to_string(i);
+            text1 += (i % 3 == 0) ? "\r\n" : "\n";
+        }
+        std::string text2 = "NEEDLE\nNEEDLENEEDLE\n";
+        std::ofstream(t1, std::ios::binary) << text1;
+        std::ofstream(t2, std::ios::binary) << text2;
+        std::string h1 = std::filesystem::canonical(t1).string();
+        std::string h2 = std::filesystem::canonical(t2).string();
+        Json::Value p1; p1["name"] = "preload"; p1["arguments"]["path"] = t1.string();
+        Json::Value p2; p2["name"] = "preload"; p2["arguments"]["path"] = t2.string();
+        ASSERT_TRUE(!controller.callTool(p1).isMember("__error__"));
+        ASSERT_TRUE(!controller.callTool(p2).isMember("__error__"));
+
+        Json::Value search;
+        search["name"] = "fileop";
+        search["arguments"]["operation"] = "search";
+        search["arguments"]["pattern"] = "NEEDLE";
+        search["arguments"]["handler"] = h1;
+        Json::Value res = controller.callTool(search);
+        ASSERT_TRUE(!res.isMember("__error__"));
+        ASSERT_TRUE(res["matches"].size() == 10);
+        ASSERT_TRUE(!res["truncated"].asBool());
+        for (Json::ArrayIndex i = 0; i < res["matches"].size(); ++i) {
+            const Json::Value& m = res["matches"][i];
+            ASSERT_TRUE(m["handler"].asString() == h1);
+            ASSERT_TRUE(m["line"].asUInt64() == i * 1000 + 7);
+            ASSERT_TRUE(m["column"].asUInt64() == 10);
+            ASSERT_TRUE(text1.compare(m["offset"].asUInt64(), 6, "NEEDLE") == 0);
+        }
+
+        // Same answer when line numbers come from the line index
+        Json::Value reindex; reindex["name"] = "preload"; reindex["arguments"]["path"] = t1.string(); reindex["arguments"]["line_index"] = true;
+        ASSERT_TRUE(!controller.callTool(reindex).isMember("__error__"));
+        Json::Value indexed = controller.callTool(search);
+        ASSERT_TRUE(indexed["matches"] == res["matches"]);
+
+        // Several handlers, non-overlapping matches, max_matches across all of them
+        search["arguments"].removeMember("handler");
+        search["arguments"]["handlers"].append(h2);
+        search["arguments"]["handlers"].append(h1);
+        search["arguments"]["max_matches"] = 5;
+        Json::Value multi = controller.callTool(search);
+        ASSERT_TRUE(multi["matches"].size() == 5);
+        ASSERT_TRUE(multi["truncated"].asBool());
+        ASSERT_TRUE(multi["matches"][0]["handler"].asString() == h2);
+        ASSERT_TRUE(multi["matches"][2]["line"].asUInt64() == 1 && multi["matches"][2]["column"].asUInt64() == 6);
+        ASSERT_TRUE(multi["matches"][3]["handler"].asString() == h1);
+        ASSERT_TRUE(multi["content"][0]["text"].asString().find(h2 + ":1:6 (byte 13)") != std::string::npos);
+
+        // Errors
+        Json::Value empty = search;
+        empty["arguments"]["pattern"] = "";
+        ASSERT_TRUE(controller.callTool(empty).isMember("__error__"));
+        Json::Value bad = search;
+        bad["arguments"]["handlers"][0] = "/no/such/handler";
+        ASSERT_TRUE(controller.callTool(bad).isMember("__error__"));
+
+        // find_regex: chunked parallel scan returns exactly the serial result, also when truncated
+        std::string big;
+        for (size_t i = 0; big.size() < 3 * kRegexChunkSize; ++i) {
+            big += (i % 997 == 0) ? "id=" + std::to_string(i) + " end" : "row " + std::to_string(i * 7919 % 100003);
+            big += "\n\r\n\r"[rng() % 4];
+            if (i % 5003 == 0) big += "\n\n\r\n";
+        }
+        TaskflowManager pool(4);
+        for (std::string pattern : {"id=[0-9]+", "^row 1[0-9]*$", "9 end"}) {
+            for (size_t limit : {(size_t)3, (size_t)10000000}) {
+                std::vector<SearchMatch> serial, parallel;
+                bool serial_truncated = false, parallel_truncated = false;
+                std::string error;
+                ASSERT_TRUE(find_regex(big.data(), big.size(), pattern, limit, nullptr, serial, serial_truncated, error));
+                ASSERT_TRUE(find_regex(big.data(), big.size(), pattern, limit, &pool, parallel, parallel_truncated, error));
+                ASSERT_TRUE(!serial.empty());
+                ASSERT_TRUE(serial.size() == parallel.size() && serial_truncated == parallel_truncated);
+                ASSERT_TRUE(serial_truncated == (limit == 3));
+                for (size_t k = 0; k < serial.size(); ++k) {
+                    ASSERT_TRUE(serial[k].offset == parallel[k].offset && serial[k].length == parallel[k].length);
+                    ASSERT_TRUE(serial[k].line == parallel[k].line && serial[k].line_start == parallel[k].line_start);
+                }
+                const SearchMatch& last = parallel.back();
+                ASSERT_TRUE(last.line == naive_line_of(big, last.offset));
+                ASSERT_TRUE(naive_line_of(big, last.line_start) == last.line && last.line_start <= last.offset);
+            }
+        }
+#ifdef MCP_FILEOP_HAVE_RE2
+        // A match spanning lines is found whichever chunk boundary it crosses
+        {
+            std::vector<SearchMatch> serial, parallel;
+            bool truncated_serial = false, truncated_parallel = false;
+            std::string error;
+            ASSERT_TRUE(find_regex(big.data(), big.size(), "end[\r\n]+row", 100000, nullptr, serial, truncated_serial, error));
+            ASSERT_TRUE(find_regex(big.data(), big.size(), "end[\r\n]+row", 100000, &pool, parallel, truncated_parallel, error));
+            ASSERT_TRUE(serial.size() == parallel.size() && !serial.empty());
+            for (size_t k = 0; k < serial.size(); ++k) {
+                ASSERT_TRUE(serial[k].offset == parallel[k].offset && serial[k].line == parallel[k].line);
+            }
+        }
+#endif
+        {
+            std::vector<SearchMatch> none;
+            bool truncated = false;
+            std::string error;
+            ASSERT_TRUE(!find_regex(big.data(), big.size(), "(unclosed", 10, &pool, none, truncated, error));
+            ASSERT_TRUE(!error.empty());
+        }
+
+        // search operation with a regex and context lines
+        Json::Value rx;
+        rx["name"] = "fileop";
+        rx["arguments"]["operation"] = "search";
+        rx["arguments"]["pattern"] = "NEEDLE(NEEDLE)*$";
+        rx["arguments"]["regex"] = true;
+        rx["arguments"]["handler"] = h2;
+        rx["arguments"]["context"] = 1;
+        Json::Value rxRes = controller.callTool(rx);
+        ASSERT_TRUE(!rxRes.isMember("__error__"));
+        ASSERT_TRUE(rxRes["matches"].size() == 2);
+        ASSERT_TRUE(rxRes["matches"][0]["length"].asUInt64() == 6);
+        ASSERT_TRUE(rxRes["matches"][0]["context_line"].asUInt64() == 0);
+        ASSERT_TRUE(rxRes["matches"][0]["context"].asString() == text2);
+        ASSERT_TRUE(rxRes["matches"][1]["length"].asUInt64() == 12);
+        ASSERT_TRUE(rxRes["matches"][1]["line"].asUInt64() == 1 && rxRes["matches"][1]["column"].asUInt64() == 0);
+        ASSERT_TRUE(rxRes["matches"][1]["context"].asString() == text2);
+        rx["arguments"]["handler"] = h1;
+        rx["arguments"]["pattern"] = "with (NEEDLE) here";
+        rx["arguments"]["context"] = 2;
+        Json::Value ctx = controller.callTool(rx);
+        ASSERT_TRUE(ctx["matches"].size() == 10);
+        for (Json::ArrayIndex i = 0; i < ctx["matches"].size(); ++i) {
+            const Json::Value& m = ctx["matches"][i];
+            ASSERT_TRUE(m["line"].asUInt64() == i * 1000 + 7 && m["column"].asUInt64() == 5);
+            ASSERT_TRUE(m["context_line"].asUInt64() == i * 1000 + 5);
+            std::string expected_context;
+            for (size_t k = i * 1000 + 5; k <= i * 1000 + 9; ++k) {
+                expected_context += (k % 1000 == 7) ? "line with NEEDLE here" : "plain line " + std::to_string(k);
+                expected_context += (k % 3 == 0) ? "\r\n" : "\n";
+            }
+            ASSERT_TRUE(m["context"].asString() == expected_context);
+        }
+        Json::Value badRegex = rx;
+        badRegex["arguments"]["pattern"] = "[";
+        ASSERT_TRUE(controller.callTool(badRegex).isMember("__error__"));
+
+        std::filesystem::remove(t1);
+        std::filesystem::remove(t2);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All search tests passed" << std::endl;
+    return 0;
+}
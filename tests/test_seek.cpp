@@ -0,0 +1,135 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <json/json.h>
+#include "../src/Seek.hpp"
+#include "../src/FileOpController.hpp"
+
+#define ASSERT_TRUE(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << " at " << __FILE__ << ":" << __LINE__ << std::endl; return 1; }
+
+static Json::Value seek(FileOpController& controller, const std::string& handler, const std::string& key, const Json::Value& extra = Json::Value()) {
+    Json::Value call;
+    call["name"] = "fileop";
+    call["arguments"]["operation"] = "seek";
+    call["arguments"]["handler"] = handler;
+    call["arguments"]["key"] = key;
+    if (extra.isObject()) {
+        for (const auto& name : extra.getMemberNames()) call["arguments"][name] = extra[name];
+    }
+    return controller.callTool(call);
+}
+
+static std::string two(int v) {
+    return (v < 10 ? "0" : "") + std::to_string(v);
+}
+
+int main() {
+    try {
+        // Timestamps: dates, times, fractions, offsets and epoch units
+        const double day = 1792108800.0; // 2026-10-16T00:00:00Z
+        double t = 0.0;
+        ASSERT_TRUE(parse_timestamp("2026-10-16", 10, t) && t == day);
+        ASSERT_TRUE(parse_timestamp("2026-10-16T12:00", 16, t) && t == day + 43200);
+        std::string zoned = "[2026/10/16 12:00:00.5+01:00] INFO";
+        ASSERT_TRUE(parse_timestamp(zoned.data(), zoned.size(), t) && t == day + 39600.5);
+        ASSERT_TRUE(parse_timestamp("1792108800000", 13, t) && t == day);
+        ASSERT_TRUE(parse_timestamp("1792108800", 10, t) && t == day);
+        ASSERT_TRUE(!parse_timestamp("INFO", 4, t));
+
+        // Bisection agrees with a linear scan on sorted keys with duplicates and mixed terminators
+        std::mt19937 rng(2026);
+        const char* terminators[] = {"\n", "\r\n", "\r", "\n\r"};
+        for (int round = 0; round < 200; ++round) {
+            std::vector<std::string> keys;
+            size_t count = rng() % 3000;
+            for (size_t i = 0; i < count; ++i) keys.push_back(std::to_string(100000 + rng() % 50000));
+            std::sort(keys.begin(), keys.end());
+            std::string data;
+            std::vector<size_t> starts;
+            const char* terminator = terminators[round % 4];
+            for (const auto& k : keys) {
+                if (rng() % 10 == 0) data += terminator;
+                starts.push_back(data.size());
+                data += k + " payload " + std::string(rng() % 80, 'x') + terminator;
+            }
+            for (int q = 0; q < 20; ++q) {
+                SeekSpec spec;
+                spec.key = std::to_string(99000 + rng() % 52000);
+                SeekResult result;
+                std::string error;
+                ASSERT_TRUE(seek_sorted(data.data(), data.size(), spec, result, error));
+                size_t expected = std::lower_bound(keys.begin(), keys.end(), spec.key) - keys.begin();
+                ASSERT_TRUE(result.found == (expected < keys.size()));
+                ASSERT_TRUE(result.offset == (expected < keys.size() ? starts[expected] : data.size()));
+                if (result.found) ASSERT_TRUE(result.exact == (keys[expected] == spec.key));
+            }
+        }
+
+        // A day of log lines, one per second, found by text prefix and by parsed timestamp
+        std::string log;
+        for (int s = 0; s < 86400; ++s) {
+            log += "2026-10-16T" + two(s / 3600) + ":" + two(s / 60 % 60) + ":" + two(s % 60) + ".000Z INFO request " + std::to_string(s) + "\n";
+        }
+        auto path = std::filesystem::temp_directory_path() / "mcp_seek.log";
+        std::ofstream(path, std::ios::binary) << log;
+        std::string handler = std::filesystem::canonical(path).string();
+        FileOpController controller;
+        Json::Value preload;
+        preload["name"] = "preload";
+        preload["arguments"]["path"] = path.string();
+        Json::Value loaded = controller.callTool(preload);
+        ASSERT_TRUE(!loaded.isMember("__error__") && loaded["handler"].asString() == handler);
+
+        Json::Value res = seek(controller, handler, "2026-10-16T12:00");
+        ASSERT_TRUE(res["found"].asBool() && res["exact"].asBool() && res["line"].asUInt64() == 43200);
+        // The compact handle from preload works wherever the path does
+        ASSERT_TRUE(seek(controller, loaded["handle"].asString(), "2026-10-16T12:00")["line"].asUInt64() == 43200);
+        ASSERT_TRUE(res["probes"].asUInt64() < 64);
+        Json::Value timestamp;
+        timestamp["compare"] = "timestamp";
+        res = seek(controller, handler, "2026-10-16T14:00:00.5+02:00", timestamp);
+        ASSERT_TRUE(res["line"].asUInt64() == 43201 && !res["exact"].asBool());
+        res = seek(controller, handler, "1792152000000", timestamp);
+        ASSERT_TRUE(res["line"].asUInt64() == 43200 && res["exact"].asBool());
+        ASSERT_TRUE(!seek(controller, handler, "2026-10-17", timestamp)["found"].asBool());
+        ASSERT_TRUE(seek(controller, handler, "noon", timestamp).isMember("__error__"));
+        ASSERT_TRUE(seek(controller, handler, "").isMember("__error__"));
+
+        // The returned line feeds a 'lines' read
+        Json::Value read;
+        read["name"] = "fileop";
+        read["arguments"]["operation"] = "read";
+        read["arguments"]["handler"] = handler;
+        read["arguments"]["format"] = "lines";
+        read["arguments"]["size"] = 1;
+        res = seek(controller, handler, "2026-10-16T23:59:59", timestamp);
+        read["arguments"]["offset"] = res["line"];
+        ASSERT_TRUE(controller.callTool(read)["content"][0]["text"].asString() == "2026-10-16T23:59:59.000Z INFO request 86399\n");
+
+        // Numeric fields of a CSV with a header, which does not parse and is skipped
+        std::string csv = "id,name\r\n";
+        for (int i = 0; i < 5000; ++i) csv += "\"" + std::to_string(i * 2) + "\",row" + std::to_string(i) + "\r\n";
+        std::ofstream(path, std::ios::binary) << csv;
+        ASSERT_TRUE(!controller.callTool(preload).isMember("__error__"));
+        Json::Value number;
+        number["compare"] = "number";
+        number["field"] = 0;
+        number["delimiter"] = ",";
+        res = seek(controller, handler, "1001", number);
+        ASSERT_TRUE(res["line"].asUInt64() == 502 && res["offset"].asUInt64() == csv.find("\"1002\""));
+        ASSERT_TRUE(seek(controller, handler, "-5", number)["line"].asUInt64() == 1);
+        ASSERT_TRUE(!seek(controller, handler, "10000", number)["found"].asBool());
+        number["field"] = 2;
+        ASSERT_TRUE(!seek(controller, handler, "1", number)["found"].asBool());
+        std::filesystem::remove(path);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All seek tests passed" << std::endl;
+    return 0;
+}
@@ -1,6 +1,12 @@
 #include "SegmentRegistry.hpp"
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 int main() {
     SegmentRegistry registry;
@@ -10,5 +16,240 @@ int main() {
     std::cout << "Preload success, size: " << seg->size() << std::endl;
     registry.close("testfile.bin");
     std::cout << "Close success" << std::endl;
+
+    // Concurrent preloads of one path share one mapping and each hold a reference
+    auto path = std::filesystem::temp_directory_path() / "mcp_registry_concurrent.log";
+    std::ofstream(path) << "first\n";
+    std::string handler = std::filesystem::canonical(path).string();
+    for (int round = 0; round < 2; ++round) {
+        std::vector<std::shared_ptr<MemorySegment>> results(8);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < results.size(); ++t) {
+            threads.emplace_back([&, t] { results[t] = registry.preload(path.string()); });
+        }
+        for (auto& t : threads) t.join();
+        for (const auto& r : results) assert(r == results[0]);
+        assert(registry.getByHandler(handler) == results[0]);
+        // The second round remaps the grown file and keeps the first round's references
+        assert(results[0]->refCount() == 8 * (round + 1));
+        assert(results[0]->size() == (round == 0 ? 6u : 13u));
+        std::ofstream(path, std::ios::app) << "second\n";
+    }
+    for (int i = 0; i < 16; ++i) {
+        assert(registry.getByHandler(handler) != nullptr);
+        registry.close(handler);
+    }
+    assert(registry.getByHandler(handler) == nullptr);
+    auto listed = registry.listHandlers();
+    assert(std::find(listed.begin(), listed.end(), handler) == listed.end());
+    std::cout << "Concurrent preload success" << std::endl;
+
+    // Compact handles resolve like the path, survive remaps and go stale on close
+    std::string handle;
+    auto first = registry.preload(path.string(), &handle);
+    assert(!handle.empty() && registry.getByHandler(handle) == first);
+    assert(registry.resolveHandler(handle) == handler && registry.resolveHandler(handler) == handler);
+    assert(registry.lineIndex(handle) == registry.lineIndex(handler));
+    std::ofstream(path, std::ios::app) << "third\n";
+    std::string again;
+    auto grown = registry.preload(path.string(), &again);
+    assert(again == handle && grown != first && registry.getByHandler(handle) == grown);
+    registry.close(handle);
+    assert(registry.getByHandler(handle) == grown);
+    registry.close(handler);
+    assert(registry.getByHandler(handle) == nullptr && registry.resolveHandler(handle).empty());
+    // The freed slot is reused for the next path under a new generation
+    auto other = std::filesystem::temp_directory_path() / "mcp_registry_other.log";
+    std::ofstream(other) << "other\n";
+    std::string reused;
+    auto other_segment = registry.preload(other.string(), &reused);
+    assert(reused != handle && registry.getByHandler(reused) == other_segment);
+    assert(registry.getByHandler(handle) == nullptr);
+    registry.close(handle);
+    assert(registry.getByHandler(reused) == other_segment);
+    registry.close(reused);
+    assert(registry.getByHandler(reused) == nullptr);
+    assert(registry.getByHandler("18446744073709551616") == nullptr);
+    std::filesystem::remove(path);
+    std::filesystem::remove(other);
+    std::cout << "Compact handle success" << std::endl;
+
+    // Publishing one path leaves every other shard and slot block of the table resolving
+    {
+        size_t listedBefore = registry.listHandlers().size();
+        std::vector<std::filesystem::path> many;
+        std::vector<std::string> manyHandles;
+        for (int i = 0; i < 150; ++i) {
+            many.push_back(std::filesystem::temp_directory_path() / ("mcp_registry_many_" + std::to_string(i) + ".log"));
+            std::ofstream(many.back()) << i << "\n";
+            manyHandles.emplace_back();
+            assert(registry.preload(many.back().string(), &manyHandles.back()) != nullptr);
+        }
+        for (int i = 0; i < 150; i += 2) {
+            registry.close(manyHandles[i]);
+        }
+        for (int i = 0; i < 150; ++i) {
+            std::string canonical = std::filesystem::canonical(many[i]).string();
+            bool open = i % 2 == 1;
+            assert((registry.getByHandler(manyHandles[i]) != nullptr) == open);
+            assert((registry.getByHandler(canonical) != nullptr) == open);
+            assert(registry.resolveHandler(manyHandles[i]) == (open ? canonical : std::string()));
+        }
+        // A slot of an allocated block that was never handed out
+        assert(registry.getByHandler(std::to_string(1ULL << 32 | 191)) == nullptr);
+        for (int i = 0; i < 150; ++i) {
+            registry.close(manyHandles[i]);
+            std::filesystem::remove(many[i]);
+        }
+        assert(registry.listHandlers().size() == listedBefore);
+    }
+    std::cout << "Sharded handler table success" << std::endl;
+
+    // Over budget, the least recently used handlers are unmapped and mapped again on their next lookup
+    std::vector<std::string> paths, handles(3);
+    for (int i = 0; i < 3; ++i) {
+        auto p = std::filesystem::temp_directory_path() / ("mcp_registry_budget_" + std::to_string(i) + ".log");
+        std::ofstream(p) << "budget " << i << "\n";
+        paths.push_back(std::filesystem::canonical(p).string());
+    }
+    registry.setMemoryBudget(0, 2);
+    auto held = registry.preload(paths[0], &handles[0]);
+    registry.preload(paths[0]);
+    auto index = registry.lineIndex(paths[0]);
+    registry.preload(paths[1], &handles[1]);
+    registry.preload(paths[2], &handles[2]);
+    assert(registry.mappedSegments() == 2);
+    listed = registry.listHandlers();
+    assert(std::find(listed.begin(), listed.end(), paths[0]) != listed.end());
+    // A reader still holding the evicted mapping keeps it valid, and the lookup reuses it
+    assert(std::string(static_cast<const char*>(held->data()), held->size()) == "budget 0\n");
+    auto restored = registry.getByHandler(handles[0]);
+    assert(restored == held && restored->refCount() == 2);
+    assert(registry.lineIndex(handles[0]) == index);
+    held.reset();
+    restored.reset();
+    // paths[1] was used least recently; once unreferenced, its mapping goes away
+    assert(registry.mappedSegments() == 2 && registry.getByHandler(paths[2]) != nullptr);
+    registry.getByHandler(paths[0]);
+    std::ofstream(paths[1], std::ios::app) << "grown while evicted\n";
+    auto remapped = registry.getByHandler(handles[1]);
+    assert(remapped && remapped->size() == 29 && remapped->refCount() == 1);
+    assert(registry.mappedSegments() == 2 && registry.getByHandler(paths[2]) != nullptr);
+    // Byte budgets count file sizes
+    registry.setMemoryBudget(20, 0);
+    assert(registry.mappedSegments() == 1 && registry.mappedByteCount() <= 20);
+    // Closing an evicted handler drops it; the others still remap
+    registry.close(handles[1]);
+    assert(registry.getByHandler(handles[1]) == nullptr);
+    registry.close(paths[0]);
+    assert(registry.getByHandler(paths[0]) != nullptr);
+    registry.close(paths[0]);
+    assert(registry.getByHandler(paths[0]) == nullptr);
+    registry.close(handles[2]);
+    assert(registry.mappedSegments() == 0 && registry.mappedByteCount() == 0);
+    // A lookup after the file of an evicted mapping is rewritten maps the new content, even while
+    // a reader holds the old mapping, and counts it against the budget again
+    registry.setMemoryBudget(0, 1);
+    std::ofstream(paths[0]) << "old content\n";
+    std::ofstream(paths[1]) << "other\n";
+    auto kept = registry.preload(paths[0], &handles[0]);
+    registry.preload(paths[1], &handles[1]);
+    assert(registry.mappedSegments() == 1 && registry.mappedByteCount() == 6);
+    auto rewrite = std::filesystem::temp_directory_path() / "mcp_registry_budget.tmp";
+    std::ofstream(rewrite) << "new content\n";
+    std::filesystem::rename(rewrite, paths[0]);
+    auto fresh = registry.getByHandler(handles[0]);
+    assert(fresh && fresh != kept && fresh->version() == kept->version() + 1);
+    assert(std::string(static_cast<const char*>(fresh->data()), fresh->size()) == "new content\n");
+    assert(std::string(static_cast<const char*>(kept->data()), kept->size()) == "old content\n");
+    assert(registry.mappedSegments() == 1 && registry.mappedByteCount() == fresh->fileSize());
+    kept.reset();
+    registry.close(handles[0]);
+    registry.close(handles[1]);
+    assert(registry.mappedSegments() == 0 && registry.mappedByteCount() == 0);
+    registry.setMemoryBudget(0, 0);
+    for (const auto& p : paths) std::filesystem::remove(p);
+    std::cout << "Memory budget success" << std::endl;
+
+    // Changes on disk mark the mapping stale; the next lookup remaps it and advances its version
+    auto watched = std::filesystem::temp_directory_path() / "mcp_registry_watched.log";
+    std::ofstream(watched) << "one\ntwo\nthree\n";
+    std::string watchedHandle;
+    auto mapped = registry.preload(watched.string(), &watchedHandle);
+    assert(mapped->version() == 1 && registry.lineIndex(watchedHandle)->lineCount() == 3);
+    assert(registry.getByHandler(watchedHandle) == mapped);
+    auto await_version = [&](uint64_t version) {
+        for (int i = 0; i < 500; ++i) {
+            try {
+                auto segment = registry.getByHandler(watchedHandle);
+                if (segment && segment->version() >= version) return segment;
+            } catch (const std::exception&) {
+                // Caught between truncation and write: an empty file does not map
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return std::shared_ptr<MemorySegment>();
+    };
+    std::ofstream(watched, std::ios::trunc) << "1\n";
+    auto truncated = await_version(2);
+    assert(truncated && truncated->version() == 2 && truncated->size() == 2);
+    assert(registry.lineIndex(watchedHandle)->lineCount() == 1);
+    // A same-size rewrite remaps too, so indexes of the old content are not reused
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::ofstream(watched, std::ios::in | std::ios::out) << "\n\n";
+    auto rewritten = await_version(3);
+    assert(rewritten && rewritten->version() == 3 && registry.lineIndex(watchedHandle)->lineCount() == 2);
+    // Replacing the file by a rename
+    auto replacement = std::filesystem::temp_directory_path() / "mcp_registry_watched.tmp";
+    std::ofstream(replacement) << "replaced\n";
+    std::filesystem::rename(replacement, watched);
+    auto replaced = await_version(4);
+    assert(replaced && std::string(static_cast<const char*>(replaced->data()), replaced->size()) == "replaced\n");
+    assert(replaced->refCount() == 1 && registry.getByHandler(watched.string()) == replaced);
+    registry.close(watchedHandle);
+    std::filesystem::remove(watched);
+    std::cout << "Staleness success" << std::endl;
+
+    // Growth extends the line index only when the sampled old content is unchanged: a rewrite of
+    // the head followed by an append rebuilds it, even though the old tail still matches
+    auto growing = std::filesystem::temp_directory_path() / "mcp_registry_grown.log";
+    std::string lines;
+    for (int i = 0; i < 5000; ++i) lines += "x\n";
+    std::ofstream(growing) << lines;
+    std::string grownHandle;
+    registry.preload(growing.string(), &grownHandle);
+    assert(registry.lineIndex(grownHandle)->lineCount() == 5000);
+    std::ofstream(growing, std::ios::app) << "y\n";
+    registry.preload(growing.string());
+    assert(registry.lineIndex(grownHandle)->lineCount() == 5001);
+    {
+        std::fstream head(growing, std::ios::in | std::ios::out | std::ios::binary);
+        head << std::string(2000, 'x');
+        head.seekp(0, std::ios::end);
+        head << "z\n";
+    }
+    registry.preload(growing.string());
+    assert(registry.lineIndex(grownHandle)->lineCount() == 4002);
+    registry.close(grownHandle);
+    registry.close(grownHandle);
+    registry.close(grownHandle);
+    std::filesystem::remove(growing);
+    std::cout << "Append detection success" << std::endl;
+
+    // Reading a mapping past the end of its truncated file marks it truncated instead of killing
+    // the process, and the next lookup maps the shorter file
+    auto shrunk = std::filesystem::temp_directory_path() / "mcp_registry_truncated.bin";
+    std::ofstream(shrunk) << std::string(3 * 65536, 'x');
+    std::string shrunkHandle;
+    auto full = registry.preload(shrunk.string(), &shrunkHandle);
+    assert(!full->truncated());
+    std::filesystem::resize_file(shrunk, 10);
+    volatile char past = static_cast<const char*>(full->data())[2 * 65536];
+    assert(past == 0 && full->truncated() && full->isStale());
+    auto shorter = registry.getByHandler(shrunkHandle);
+    assert(shorter && shorter != full && shorter->size() == 10 && !shorter->truncated());
+    registry.close(shrunkHandle);
+    std::filesystem::remove(shrunk);
+    std::cout << "Truncation success" << std::endl;
     return 0;
 }
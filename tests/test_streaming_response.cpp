@@ -0,0 +1,222 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <algorithm>
+#include <json/json.h>
+#include "../src/FileOpController.hpp"
+#include "../src/StreamingResponse.hpp"
+
+#define ASSERT_TRUE(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << " at " << __FILE__ << ":" << __LINE__ << std::endl; return 1; }
+
+static bool parse(const std::string& text, Json::Value& out) {
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string errs;
+    return reader->parse(text.data(), text.data() + text.size(), &out, &errs);
+}
+
+// Drain a stream through a buffer of the given size
+static std::string drain(StreamingResponse& stream, size_t capacity) {
+    std::string out;
+    std::vector<char> buffer(capacity);
+    while (size_t n = stream.read(buffer.data(), buffer.size())) {
+        out.append(buffer.data(), n);
+    }
+    return out;
+}
+
+int main() {
+    try {
+        FileOpController controller;
+        auto tmpDir = std::filesystem::temp_directory_path();
+        auto t1 = tmpDir / "mcp_stream_text.txt";
+        auto t2 = tmpDir / "mcp_stream_bin.bin";
+
+        std::string text = "plain \"quoted\" back\\slash\ttab\x01\x1f\n\xc3\xa9t\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\r\nlast line";
+        std::string binary;
+        for (int i = 0; i < 1000; ++i) binary.push_back((char)(i * 37));
+
+        std::ofstream ofs1(t1, std::ios::binary);
+        ofs1 << text;
+        ofs1.close();
+        std::ofstream ofs2(t2, std::ios::binary);
+        ofs2.write(binary.data(), binary.size());
+        ofs2.close();
+
+        Json::Value p1; p1["name"] = "preload"; p1["arguments"]["path"] = t1.string();
+        Json::Value p2; p2["name"] = "preload"; p2["arguments"]["path"] = t2.string();
+        ASSERT_TRUE(!controller.callTool(p1).isMember("__error__"));
+        ASSERT_TRUE(!controller.callTool(p2).isMember("__error__"));
+        std::string h1 = std::filesystem::canonical(t1).string();
+        std::string h2 = std::filesystem::canonical(t2).string();
+
+        Json::Value call;
+        call["name"] = "fileop";
+        call["arguments"]["operation"] = "read_multiple";
+        Json::Value s1; s1["handler"] = h1; s1["format"] = "text";
+        s1["ranges"][0]["offset"] = (Json::UInt64)0; s1["ranges"][0]["size"] = (Json::UInt64)text.size();
+        Json::Value s2; s2["handler"] = h2; s2["format"] = "binary";
+        s2["ranges"][0]["offset"] = (Json::UInt64)1; s2["ranges"][0]["size"] = (Json::UInt64)998;
+        s2["ranges"][1]["offset"] = (Json::UInt64)0; s2["ranges"][1]["size"] = (Json::UInt64)0;
+        Json::Value s3; s3["handler"] = h2; s3["format"] = "hex";
+        s3["ranges"][0]["offset"] = (Json::UInt64)10; s3["ranges"][0]["size"] = (Json::UInt64)333;
+        Json::Value s4; s4["handler"] = h1; s4["format"] = "lines";
+        s4["ranges"][0]["offset"] = (Json::Int64)-1; s4["ranges"][0]["size"] = (Json::UInt64)1;
+        call["arguments"]["segments"].append(s1);
+        call["arguments"]["segments"].append(s2);
+        call["arguments"]["segments"].append(s3);
+        call["arguments"]["segments"].append(s4);
+
+        // The streamed document matches the buffered response value for value
+        Json::Value id = 42;
+        Json::Value expected = controller.createResponse(id, controller.callTool(call));
+        std::vector<double> progress_list;
+        auto progressCb = [&progress_list](const Json::Value& p) { progress_list.push_back(p["progress"].asDouble()); };
+        auto stream = controller.streamTool(id, call, progressCb);
+        ASSERT_TRUE(stream != nullptr);
+        std::string streamed = stream->readAll();
+        Json::Value actual;
+        ASSERT_TRUE(parse(streamed, actual));
+        ASSERT_TRUE(actual == expected);
+        ASSERT_TRUE(progress_list.size() == 5);
+        ASSERT_TRUE(std::is_sorted(progress_list.begin(), progress_list.end()));
+        ASSERT_TRUE(progress_list.back() == 1.0);
+
+        // Output does not depend on the caller's buffer size, including buffers smaller than one escape
+        for (size_t capacity : {1, 2, 3, 5, 7, 64, 4096}) {
+            auto chunked = controller.streamTool(id, call);
+            ASSERT_TRUE(drain(*chunked, capacity) == streamed);
+        }
+
+        // Single-range read through the legacy tool name
+        Json::Value legacy;
+        legacy["name"] = "read";
+        legacy["arguments"]["handler"] = h1;
+        legacy["arguments"]["offset"] = (Json::UInt64)0;
+        legacy["arguments"]["size"] = (Json::UInt64)5;
+        auto legacyStream = controller.streamTool("abc", legacy);
+        ASSERT_TRUE(legacyStream != nullptr);
+        ASSERT_TRUE(legacyStream->readAll() == "{\"id\":\"abc\",\"jsonrpc\":\"2.0\",\"result\":{\"content\":[{\"text\":\"plain\",\"type\":\"text\",\"version\":1}]}}");
+
+        // Errors become JSON-RPC error documents; other operations are not streamed
+        Json::Value bad = call;
+        bad["arguments"]["segments"][0]["handler"] = "/no/such/handler";
+        Json::Value badResponse;
+        ASSERT_TRUE(parse(controller.streamTool(id, bad)->readAll(), badResponse));
+        ASSERT_TRUE(badResponse["error"]["code"].asInt() == -32000);
+        ASSERT_TRUE(badResponse["id"].asInt() == 42);
+        Json::Value close; close["name"] = "close"; close["arguments"]["handler"] = h1;
+        ASSERT_TRUE(controller.streamTool(id, close) == nullptr);
+
+        // resources/read streams the base64 blob
+        Json::Value uriParams;
+        uriParams["uri"] = "file:///" + h2;
+        Json::Value resource;
+        ASSERT_TRUE(parse(controller.streamResource(7, uriParams)->readAll(), resource));
+        ASSERT_TRUE(resource == controller.createResponse(7, controller.readResourceFromUri(uriParams)));
+
+        // A pending stream keeps the mapping alive after the handler is closed
+        auto pending = controller.streamTool(id, call);
+        ASSERT_TRUE(controller.callTool(close).isMember("content"));
+        ASSERT_TRUE(pending->readAll() == streamed);
+        ASSERT_TRUE(!pending->failed());
+
+        // A file truncated under a stream stops it before the zeroed bytes past its new end
+        auto t3 = tmpDir / "mcp_stream_truncated.txt";
+        std::ofstream(t3) << std::string(3 * 65536, 'x');
+        auto shrinking = std::make_shared<MemorySegment>(t3.string());
+        StreamingResponse cut;
+        cut.appendRaw("{\"text\":");
+        cut.appendString(shrinking, 0, shrinking->size(), StreamingResponse::Encoding::Text);
+        cut.appendRaw("}");
+        std::vector<char> chunk(4096);
+        std::string head(chunk.data(), cut.read(chunk.data(), chunk.size()));
+        std::filesystem::resize_file(t3, 10);
+        head += drain(cut, chunk.size());
+        ASSERT_TRUE(cut.failed());
+        ASSERT_TRUE(head.size() < shrinking->size() && head.find("\\u0000") == std::string::npos);
+        ASSERT_TRUE(shrinking->truncated());
+        std::filesystem::remove(t3);
+
+        // Spans encoded ahead on the pool match serial encoding, with chunk boundaries inside UTF-8
+        // sequences, runs of continuation bytes and escapes
+        auto t4 = tmpDir / "mcp_stream_parallel.txt";
+        {
+            const char* fragments[] = {"a", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xff", "\x80\x80\x80\x80\x80", "\"", "\n"};
+            std::string large;
+            uint32_t state = 12345;
+            while (large.size() < 3 * 1024 * 1024 + 17) {
+                state = state * 1103515245 + 12345;
+                large += fragments[(state >> 16) % 8];
+            }
+            std::ofstream(t4, std::ios::binary) << large;
+        }
+        auto segment = std::make_shared<MemorySegment>(t4.string());
+        TaskflowManager pool(4);
+        auto build = [&](StreamingResponse& out) {
+            out.appendRaw("[");
+            out.appendString(segment, 3, segment->size() - 3, StreamingResponse::Encoding::Text);
+            out.appendRaw(",");
+            out.appendString(segment, 0, 0, StreamingResponse::Encoding::Hex);
+            out.appendRaw(",");
+            out.appendString(segment, 1, 2 * 1024 * 1024 + 1, StreamingResponse::Encoding::Base64);
+            out.appendRaw(",");
+            out.appendString(segment, 5, 1024 * 1024, StreamingResponse::Encoding::Hex);
+            out.appendRaw("]");
+        };
+        StreamingResponse serial;
+        build(serial);
+        std::string serialText = serial.readAll();
+        for (size_t lanes : {1, 2, 4}) {
+            for (size_t capacity : {7, 65536}) {
+                StreamingResponse ahead;
+                build(ahead);
+                ahead.setParallel(pool, lanes);
+                std::vector<uint64_t> done;
+                ahead.setProgress([&done](uint64_t bytes, uint64_t) { done.push_back(bytes); });
+                ASSERT_TRUE(drain(ahead, capacity) == serialText);
+                ASSERT_TRUE(done.size() == 4 && std::is_sorted(done.begin(), done.end()));
+            }
+        }
+
+        segment.reset();
+
+        // streamTool reads large requests on the pool and still matches callTool (on valid UTF-8,
+        // which callTool passes through unchanged)
+        {
+            std::string valid;
+            while (valid.size() < 1024 * 1024 + 100) valid += "a,\xc3\xa9\xe2\x82\xac\"\xf0\x9f\x98\x80\n";
+            std::ofstream(t4, std::ios::binary) << valid;
+        }
+        FileOpController parallelController;
+        parallelController.setReadConcurrency(3);
+        Json::Value p4; p4["name"] = "preload"; p4["arguments"]["path"] = t4.string();
+        ASSERT_TRUE(!parallelController.callTool(p4).isMember("__error__"));
+        Json::Value largeCall;
+        largeCall["name"] = "fileop";
+        largeCall["arguments"]["operation"] = "read_multiple";
+        for (const char* format : {"text", "hex", "binary", "columns"}) {
+            Json::Value s; s["handler"] = std::filesystem::canonical(t4).string(); s["format"] = format;
+            if (std::string(format) == "columns") {
+                s["columns"][0] = 0;
+                s["ranges"][0]["offset"] = (Json::UInt64)0; s["ranges"][0]["size"] = (Json::UInt64)100;
+            } else {
+                s["ranges"][0]["offset"] = (Json::UInt64)0; s["ranges"][0]["size"] = (Json::UInt64)1000000;
+            }
+            largeCall["arguments"]["segments"].append(s);
+        }
+        Json::Value largeActual;
+        ASSERT_TRUE(parse(parallelController.streamTool(id, largeCall)->readAll(), largeActual));
+        ASSERT_TRUE(largeActual == parallelController.createResponse(id, parallelController.callTool(largeCall)));
+        std::filesystem::remove(t4);
+
+        std::filesystem::remove(t1);
+        std::filesystem::remove(t2);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All streaming response tests passed" << std::endl;
+    return 0;
+}
@@ -96,6 +96,18 @@ int main() {
         ASSERT_TRUE(singleRes["content"][0]["type"].asString() == "text");
         ASSERT_TRUE(singleRes["content"][0]["text"].asString() == std::string("Line3\n"));
 
+        // End-relative 'lines' read: offset -2 starts two lines before EOF
+        Json::Value tail;
+        tail["name"] = "fileop";
+        tail["arguments"]["operation"] = "read";
+        tail["arguments"]["handler"] = handler;
+        tail["arguments"]["offset"] = (Json::Int64)-2;
+        tail["arguments"]["size"] = (Json::UInt64)2;
+        tail["arguments"]["format"] = "lines";
+        Json::Value tailRes = controller.callTool(tail);
+        ASSERT_TRUE(!tailRes.isMember("__error__"));
+        ASSERT_TRUE(tailRes["content"][0]["text"].asString() == std::string("Line3\nLine4\r\n"));
+
         // cleanup
         std::filesystem::remove(tmpFile);
 
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "../src/TrigramIndex.hpp"
+#include "../src/Search.hpp"
+#include "../src/SegmentRegistry.hpp"
+#include "../src/TaskflowManager.hpp"
+
+#define ASSERT_TRUE(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << " at " << __FILE__ << ":" << __LINE__ << std::endl; return 1; }
+
+int main() {
+    try {
+        // A few hundred blocks of words over a small alphabet, so most trigrams repeat and some are rare
+        std::mt19937 rng(4242);
+        const char* words[] = {"alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta"};
+        const char* terminators[] = {"\n", "\r", "\r\n", "\n\r"};
+        std::string text;
+        while (text.size() < TrigramIndex::kBlockSize * 300) {
+            text += words[rng() % 8];
+            text += (rng() % 6 == 0) ? terminators[rng() % 4] : " ";
+            if (rng() % 20000 == 0) text += "rare-token-" + std::to_string(rng() % 3);
+        }
+
+        TaskflowManager taskflow(4);
+        auto serial = TrigramIndex::build(text.data(), text.size());
+        auto parallel = TrigramIndex::build(text.data(), text.size(), &taskflow);
+        ASSERT_TRUE(serial->blockCount() == (text.size() + TrigramIndex::kBlockSize - 1) / TrigramIndex::kBlockSize);
+        ASSERT_TRUE(serial->byteSize() == text.size());
+        ASSERT_TRUE(serial->memoryBytes() == parallel->memoryBytes());
+        ASSERT_TRUE(serial->memoryBytes() < text.size());
+        // A budget too small for one pass builds the same index one range of trigrams at a time
+        auto partitioned = TrigramIndex::build(text.data(), text.size(), &taskflow, 256 * 1024);
+        ASSERT_TRUE(partitioned->memoryBytes() == serial->memoryBytes());
+        // Binary files are not indexed
+        std::string binary = text;
+        binary[10] = '\0';
+        ASSERT_TRUE(TrigramIndex::build(binary.data(), binary.size()) == nullptr);
+
+        // Candidates contain every block where a match starts, for patterns up to and past kMaxQueryBytes
+        std::vector<std::string> patterns = {"rare-token-1", "alpha beta", "zzz", "ta\r\nthe", "eta"};
+        for (int i = 0; i < 40; ++i) {
+            size_t at = rng() % text.size();
+            patterns.push_back(text.substr(at, 3 + rng() % (TrigramIndex::kMaxQueryBytes + 100)));
+        }
+        for (const auto& pattern : patterns) {
+            std::vector<uint32_t> blocks, parallel_blocks, partitioned_blocks;
+            ASSERT_TRUE(serial->candidateBlocks(pattern.data(), pattern.size(), blocks));
+            ASSERT_TRUE(parallel->candidateBlocks(pattern.data(), pattern.size(), parallel_blocks));
+            ASSERT_TRUE(partitioned->candidateBlocks(pattern.data(), pattern.size(), partitioned_blocks));
+            ASSERT_TRUE(blocks == parallel_blocks && blocks == partitioned_blocks);
+            for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+                ASSERT_TRUE(std::binary_search(blocks.begin(), blocks.end(), (uint32_t)(pos / TrigramIndex::kBlockSize)));
+            }
+
+            // Searching candidate blocks only gives the same matches and line numbers as a full scan
+            for (size_t limit : {(size_t)2, (size_t)1000000}) {
+                std::vector<SearchMatch> full, narrowed;
+                bool full_truncated = false, narrowed_truncated = false;
+                find_literal_all(text.data(), text.size(), pattern, limit, nullptr, nullptr, full, full_truncated);
+                find_literal_all(text.data(), text.size(), pattern, limit, nullptr, serial.get(), narrowed, narrowed_truncated);
+                ASSERT_TRUE(full.size() == narrowed.size() && full_truncated == narrowed_truncated);
+                for (size_t k = 0; k < full.size(); ++k) {
+                    ASSERT_TRUE(full[k].offset == narrowed[k].offset && full[k].line == narrowed[k].line && full[k].line_start == narrowed[k].line_start);
+                }
+            }
+        }
+        std::vector<uint32_t> none;
+        ASSERT_TRUE(serial->candidateBlocks("rare-token-9", 12, none) && none.empty());
+        ASSERT_TRUE(!serial->candidateBlocks("et", 2, none));
+
+        // The registry builds the index in the background and drops it on close
+        auto path = std::filesystem::temp_directory_path() / "mcp_trigram.txt";
+        std::ofstream(path, std::ios::binary) << text;
+        std::string handler = std::filesystem::canonical(path).string();
+        SegmentRegistry registry;
+        registry.setTaskflowManager(&taskflow);
+        ASSERT_TRUE(registry.preload(path.string()) != nullptr);
+        ASSERT_TRUE(registry.trigramIndex(handler) == nullptr);
+        registry.buildTrigramIndex(handler);
+        registry.waitForBackgroundTasks();
+        auto built = registry.trigramIndex(handler);
+        ASSERT_TRUE(built != nullptr && built->memoryBytes() == serial->memoryBytes());
+        registry.close(handler);
+        ASSERT_TRUE(registry.trigramIndex(handler) == nullptr);
+
+        // A build finishing after its handler was closed is discarded
+        ASSERT_TRUE(registry.preload(path.string()) != nullptr);
+        registry.buildTrigramIndex(handler);
+        registry.close(handler);
+        registry.waitForBackgroundTasks();
+        ASSERT_TRUE(registry.preload(path.string()) != nullptr);
+        ASSERT_TRUE(registry.trigramIndex(handler) == nullptr);
+        std::filesystem::remove(path);
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All trigram index tests passed" << std::endl;
+    return 0;
+}